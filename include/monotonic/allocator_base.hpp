@@ -6,7 +6,7 @@
 #pragma once
 
 #ifdef BOOST_HETEROGENOUS
-#include <cloneable/abstract_allocator.hpp>
+#include <monotonic/heterogenous/abstract_allocator.hpp>
 #endif
 
 #include <monotonic/detail/prefix.hpp>
@@ -19,11 +19,25 @@ namespace boost
 {
     namespace monotonic
     {
+        /// derive from this to mark a type whose objects are written by different threads,
+        /// so that monotonic allocators give each one cache lines of its own
+        struct contended { };
+
+        /// true for types that are allocated with hint::exclusive_line. specialise it to
+        /// mark a type that cannot derive from contended.
+        ///
+        /// it is asked of the type the allocator is rebound to, so node containers such
+        /// as list, set and map allocate their nodes without the hint even when their
+        /// elements are contended. a vector allocates its elements directly, and so
+        /// keeps it
+        template <class T>
+        struct is_contended : std::is_base_of<contended, T> { };
+
         /// common to other monotonic allocators for type T of type Derived
         template <class T, class Derived>
         struct allocator_base
 #ifdef BOOST_HETEROGENOUS
-            : cloneable::abstract_allocator
+            : heterogenous::abstract_allocator
 #endif
         {
             typedef size_t size_type;
@@ -35,16 +49,16 @@ namespace boost
             typedef T value_type;
             typedef detail::Construct<detail::is_monotonic<T>::value> Construct;
 
-            static constexpr size_t alignment = 64;//CJS TODO std::aligned_storage<sizeof(T)>::type;
+            static constexpr size_t alignment = alignof(T);
 
             storage_base *storage;
 
 #ifdef BOOST_HETEROGENOUS
             // override for abstract_allocator
-            virtual cloneable::abstract_allocator::pointer allocate_bytes(size_t num_bytes, size_t alignment)
+            virtual heterogenous::abstract_allocator::pointer allocate_bytes(size_t num_bytes, size_t alignment)
             {
                 void *ptr = storage->allocate(num_bytes, alignment);
-                return reinterpret_cast<cloneable::abstract_allocator::pointer>(ptr);
+                return reinterpret_cast<heterogenous::abstract_allocator::pointer>(ptr);
             }
 
             virtual void deallocate_bytes(char * /*bytes*/, size_t /*alignment*/ )
@@ -74,8 +88,12 @@ namespace boost
                 return &x;
             }
 
+            /// for a contended type, the block of num elements is given lines of its
+            /// own; the elements within it still share lines unless T is aligned to one
             pointer allocate(size_type num, const void * /*hint*/ = 0)
             {
+                if (is_contended<T>::value)
+                    return reinterpret_cast<T *>(storage->allocate(num*sizeof(T), alignment, hint::exclusive_line));
                 return reinterpret_cast<T *>(storage->allocate(num*sizeof(T), alignment));
             }
 
@@ -101,6 +119,11 @@ namespace boost
                 Construct::Given(ptr, val, DerivedPtr());
             }
 
+            void construct(pointer ptr, T &&val)
+            {
+                Construct::Given(ptr, std::move(val), DerivedPtr());
+            }
+
             Derived *DerivedPtr()
             {
                 return static_cast<Derived *>(this);
@@ -0,0 +1,113 @@
+// Copyright (C) 2009-2020 Christian@Schladetsch.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MONOTONIC_ARENA_ALLOCATOR_HPP
+#define BOOST_MONOTONIC_ARENA_ALLOCATOR_HPP
+
+#include <type_traits>
+#include <monotonic/detail/prefix.hpp>
+#include <monotonic/storage.hpp>
+
+namespace boost
+{
+    namespace monotonic
+    {
+        /// a monotonic allocator that refers directly to a given storage, rather than
+        /// to the static storage of a region.
+        ///
+        /// there is no global state: each arena (for example, one per request) is just a
+        /// Storage object, and containers using it are independent of all other arenas,
+        /// so no locking or region tags are needed.
+        ///
+        /// the allocator propagates on container copy-assignment, move-assignment and
+        /// swap, so a container always allocates from the same arena as its elements.
+        /// calls to the storage are made non-virtually.
+        template <class T, class Storage>
+        struct arena_allocator
+        {
+            typedef T value_type;
+            typedef T *pointer;
+            typedef const T *const_pointer;
+            typedef T &reference;
+            typedef const T &const_reference;
+            typedef size_t size_type;
+            typedef ptrdiff_t difference_type;
+            typedef Storage storage_type;
+
+            typedef std::true_type propagate_on_container_copy_assignment;
+            typedef std::true_type propagate_on_container_move_assignment;
+            typedef std::true_type propagate_on_container_swap;
+            typedef std::false_type is_always_equal;
+
+            template <class U>
+            struct rebind
+            {
+                typedef arena_allocator<U, Storage> other;
+            };
+
+        private:
+            template <class, class> friend struct arena_allocator;
+
+            Storage *store;
+
+        public:
+            arena_allocator(Storage &S) noexcept
+                : store(&S) { }
+
+            template <class U>
+            arena_allocator(arena_allocator<U, Storage> const &other) noexcept
+                : store(other.store) { }
+
+            pointer allocate(size_type num)
+            {
+                void *ptr = store->Storage::allocate(num*sizeof(T), alignof(T));
+                if (ptr == 0)
+                    throw std::bad_alloc();
+                return static_cast<pointer>(ptr);
+            }
+
+            void deallocate(pointer, size_type)
+            {
+                // do nothing
+            }
+
+            size_type max_size() const noexcept
+            {
+                return store->Storage::max_size()/sizeof(T);
+            }
+
+            /// copies of a container share its arena
+            arena_allocator select_on_container_copy_construction() const
+            {
+                return *this;
+            }
+
+            Storage &get_storage() const noexcept
+            {
+                return *store;
+            }
+
+            template <class U>
+            friend bool operator==(arena_allocator const &A, arena_allocator<U, Storage> const &B) noexcept
+            {
+                return A.store == &B.get_storage();
+            }
+
+            template <class U>
+            friend bool operator!=(arena_allocator const &A, arena_allocator<U, Storage> const &B) noexcept
+            {
+                return !(A == B);
+            }
+        };
+
+    } // namespace monotonic
+
+} // namespace boost
+
+#include <monotonic/detail/postfix.hpp>
+
+#endif // BOOST_MONOTONIC_ARENA_ALLOCATOR_HPP
+
+//EOF
@@ -7,6 +7,75 @@
 #    define BOOST_MONOTONIC_CONFIG_HPP
 
 #    include <memory>
+#    if defined(__has_include)
+#        if __has_include(<version>)
+#            include <version>
+#        endif
+#    endif
+
+// guarantee constant-initialisation of static storage where the language allows it
+#    if defined(__cpp_constinit)
+#        define BOOST_MONOTONIC_CONSTINIT constinit
+#    else
+#        define BOOST_MONOTONIC_CONSTINIT
+#    endif
+
+// storage<> holds a std::vector of links, so can only be constexpr-constructed
+// when std::vector can be
+#    if defined(__cpp_lib_constexpr_vector)
+#        define BOOST_MONOTONIC_CONSTEXPR_STORAGE constexpr
+#    else
+#        define BOOST_MONOTONIC_CONSTEXPR_STORAGE
+#    endif
+
+// static_storage<> globals are constant-initialised only if every storage type
+// selected by detail::storage_type<> is constexpr-constructible
+#    if defined(__cpp_constinit) && defined(__cpp_lib_constexpr_vector)
+#        define BOOST_MONOTONIC_STATIC_STORAGE_CONSTINIT constinit
+#    else
+#        define BOOST_MONOTONIC_STATIC_STORAGE_CONSTINIT
+#    endif
+
+// SSE2 is used to search the keys of btree nodes, and for the bulk operations of
+// dynamic_bitset. define BOOST_MONOTONIC_NO_SIMD to always use the portable code
+#    if !defined(BOOST_MONOTONIC_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#        define BOOST_MONOTONIC_SSE2
+#    endif
+
+// the POPCNT instruction is used to count the bits of a dynamic_bitset when the compiler
+// targets it: -mpopcnt or a suitable -march for gcc and clang, /arch:AVX for msvc
+#    if !defined(BOOST_MONOTONIC_NO_SIMD) && (defined(__POPCNT__) || (defined(_M_X64) && defined(__AVX__)))
+#        define BOOST_MONOTONIC_POPCNT
+#    endif
+
+// define BOOST_MONOTONIC_STATISTICS to have storage<> count the bytes asked of it and
+// how many were lost to alignment, pools and links. see storage<>::get_statistics()
+
+// allocations made with hint::exclusive_line are aligned and padded to
+// std::hardware_destructive_interference_size, or to DefaultSizes::CacheLineSize where the
+// library does not have it. define BOOST_MONOTONIC_INTERFERENCE_SIZE to fix the size,
+// for example where it is part of an ABI, as the standard value may change with -mtune
+
+// on linux, numa_storage asks the kernel which node a thread runs on and binds the links
+// of each node to it. define BOOST_MONOTONIC_NO_NUMA to treat every machine as one node
+#    if defined(__linux__) && !defined(BOOST_MONOTONIC_NO_NUMA)
+#        define BOOST_MONOTONIC_NUMA
+#    endif
+
+// when built with AddressSanitizer, storage poisons the memory it has not allocated and
+// the memory released by reset(), and leaves a red zone after each allocation, so that
+// use after reset and overruns are reported. define BOOST_MONOTONIC_NO_POISON to not.
+// without AddressSanitizer this costs nothing
+#    if defined(__SANITIZE_ADDRESS__)
+#        define BOOST_MONOTONIC_ASAN
+#    elif defined(__has_feature)
+#        if __has_feature(address_sanitizer)
+#            define BOOST_MONOTONIC_ASAN
+#        endif
+#    endif
+#    if defined(BOOST_MONOTONIC_ASAN) && !defined(BOOST_MONOTONIC_NO_POISON)
+#        define BOOST_MONOTONIC_POISON
+#    endif
 
 namespace boost
 {
@@ -22,6 +91,8 @@ namespace boost
                 MinHeapIncrement = 32*1024*1024,            ///< the smallest new chunk-size for heap storage
                 MinPoolSize = 8,
                 RegionInlineSize = 8*1024,
+                CacheLineSize = 64,                            ///< assumed size of a cache line
+                TraceRingSize = 4096,                        ///< events buffered for each thread by tracing_storage
             };
         };
 
@@ -0,0 +1,286 @@
+// Copyright (C) 2009-2020 Christian@Schladetsch.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MONOTONIC_CONTAINERS_BTREE_MAP_HPP
+#define BOOST_MONOTONIC_CONTAINERS_BTREE_MAP_HPP
+
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <monotonic/detail/prefix.hpp>
+#include <monotonic/detail/container.hpp>
+#include <monotonic/detail/construct.hpp>
+#include <monotonic/detail/btree.hpp>
+#include <monotonic/allocator.hpp>
+
+namespace boost
+{
+    namespace monotonic
+    {
+        /// an ordered map of unique keys whose nodes are made directly in monotonic storage.
+        ///
+        /// this is a B+tree with nodes of four cache lines, so a lookup misses the cache
+        /// about once per level rather than once per element compared. each node keeps its
+        /// keys apart from its mapped values; arithmetic keys ordered by std::less are found
+        /// with a linear scan, using SSE2 where it is available. the leaves are chained in
+        /// order, and leaves made from an ordered_unique_range are contiguous, so range scans
+        /// read memory sequentially.
+        ///
+        /// as entries are not stored as pairs, iterators dereference to a
+        /// std::pair<K const &, T &>. inserting and erasing invalidate iterators.
+        template <class K                            // key-type
+            , class T                                // value-type
+            , class Region = default_region_tag        // allocation region
+            , class P = std::less<K>                // predicate
+            , class Access = default_access_tag        // access type
+        >
+        struct btree_map : detail::container<btree_map<K,T,Region,P,Access> >
+        {
+            typedef P Predicate;
+            typedef allocator<std::pair<const K, T>,Region,Access> Allocator;
+            typedef Allocator allocator_type;
+            typedef detail::container<btree_map<K,T,Region,P,Access> > Parent;
+            typedef detail::Create<detail::is_monotonic<T>::value, T> Create;
+            typedef detail::btree<K, T, P> Tree;
+
+            typedef K key_type;
+            typedef T mapped_type;
+            typedef P key_compare;
+            typedef std::pair<const K, T> value_type;
+            typedef typename Tree::Traits::reference reference;
+            typedef typename Tree::Traits::const_reference const_reference;
+            typedef typename Tree::iterator iterator;
+            typedef typename Tree::const_iterator const_iterator;
+            typedef size_t size_type;
+            typedef btree_map<K,T,Region,P,Access> This;
+
+        private:
+            Tree tree;
+
+        public:
+            btree_map()
+                : tree(Allocator().get_storage(), Predicate()) { }
+            btree_map(Allocator const &A)
+                : tree(A.get_storage(), Predicate()) { }
+            btree_map(Predicate const &Pr, Allocator const &A = Allocator())
+                : tree(A.get_storage(), Pr) { }
+            btree_map(btree_map const &other)
+                : tree(other.tree.store, other.tree.comp)
+            {
+                tree.bulk_load(other.begin(), other.end());
+            }
+            btree_map(btree_map &&other) noexcept
+                : tree(other.tree.store, other.tree.comp)
+            {
+                tree.swap(other.tree);
+            }
+            btree_map(btree_map const &other, Allocator const &A)
+                : tree(A.get_storage(), other.tree.comp)
+            {
+                tree.bulk_load(other.begin(), other.end());
+            }
+            /// takes other's nodes if A uses the same storage, otherwise copies its elements into A
+            btree_map(btree_map &&other, Allocator const &A)
+                : tree(A.get_storage(), other.tree.comp)
+            {
+                if (tree.store == other.tree.store)
+                    tree.swap(other.tree);
+                else
+                    tree.bulk_load(other.begin(), other.end());
+            }
+            template <class II>
+            btree_map(II F, II L, Predicate const &Pr = Predicate(), Allocator const &A = Allocator())
+                : tree(A.get_storage(), Pr)
+            {
+                insert(F, L);
+            }
+            /// make the map bottom-up from a range sorted by Pr, with no equivalent keys
+            template <class FI>
+            btree_map(ordered_unique_range_t, FI F, FI L, Predicate const &Pr = Predicate(), Allocator const &A = Allocator())
+                : tree(A.get_storage(), Pr)
+            {
+                tree.bulk_load(F, L);
+            }
+
+            btree_map &operator=(btree_map const &other)
+            {
+                if (this != &other)
+                {
+                    tree.clear();
+                    tree.comp = other.tree.comp;
+                    tree.bulk_load(other.begin(), other.end());
+                }
+                return *this;
+            }
+            btree_map &operator=(btree_map &&other)
+            {
+                if (this == &other)
+                    return *this;
+                if (tree.store == other.tree.store)
+                {
+                    // other keeps our nodes for reuse
+                    tree.swap(other.tree);
+                    other.tree.clear();
+                    return *this;
+                }
+                tree.clear();
+                tree.comp = other.tree.comp;
+                tree.bulk_load(other.begin(), other.end());
+                return *this;
+            }
+
+            Allocator get_allocator() const
+            {
+                return Allocator(*tree.store);
+            }
+            key_compare key_comp() const
+            {
+                return tree.comp;
+            }
+            bool empty() const
+            {
+                return tree.count == 0;
+            }
+            size_type size() const
+            {
+                return tree.count;
+            }
+
+            std::pair<iterator, bool> insert(value_type const &value)
+            {
+                return tree.emplace(value.first, value.second);
+            }
+            template <class II>
+            void insert(II F, II L)
+            {
+                for (; F != L; ++F)
+                    insert(*F);
+            }
+            /// add an entry for key with a value made from args, if key is not in the map
+            template <class... Args>
+            std::pair<iterator, bool> emplace(key_type const &key, Args&&... args)
+            {
+                return tree.emplace(key, std::forward<Args>(args)...);
+            }
+
+            mapped_type &operator[](key_type const &key)
+            {
+                iterator where = tree.find(key);
+                if (where == end())
+                    where = tree.emplace(key, Create::Given(this->Parent::get_storage())).first;
+                return (*where).second;
+            }
+            mapped_type &at(key_type const &key)
+            {
+                iterator where = tree.find(key);
+                if (where == end())
+                    throw std::out_of_range("btree_map");
+                return (*where).second;
+            }
+            mapped_type const &at(key_type const &key) const
+            {
+                return const_cast<This &>(*this).at(key);
+            }
+
+            iterator find(key_type const &key)
+            {
+                return tree.find(key);
+            }
+            const_iterator find(key_type const &key) const
+            {
+                return tree.find(key);
+            }
+            size_type count(key_type const &key) const
+            {
+                return tree.find(key) != tree.end();
+            }
+            iterator lower_bound(key_type const &key)
+            {
+                return tree.lower_bound(key);
+            }
+            const_iterator lower_bound(key_type const &key) const
+            {
+                return tree.lower_bound(key);
+            }
+            iterator upper_bound(key_type const &key)
+            {
+                return tree.upper_bound(key);
+            }
+            const_iterator upper_bound(key_type const &key) const
+            {
+                return tree.upper_bound(key);
+            }
+            std::pair<iterator, iterator> equal_range(key_type const &key)
+            {
+                return std::make_pair(lower_bound(key), upper_bound(key));
+            }
+            std::pair<const_iterator, const_iterator> equal_range(key_type const &key) const
+            {
+                return std::make_pair(lower_bound(key), upper_bound(key));
+            }
+
+            /// remove an entry. nodes are not merged, and the memory of an emptied node is
+            /// not reclaimed until the map is cleared
+            iterator erase(const_iterator where)
+            {
+                return tree.erase(iterator(where.leaf, where.index));
+            }
+            size_type erase(key_type const &key)
+            {
+                iterator where = tree.find(key);
+                if (where == end())
+                    return 0;
+                tree.erase(where);
+                return 1;
+            }
+            /// remove all entries, keeping the nodes for reuse
+            void clear()
+            {
+                tree.clear();
+            }
+
+            iterator begin()
+            {
+                return tree.begin();
+            }
+            iterator end()
+            {
+                return tree.end();
+            }
+            const_iterator begin() const
+            {
+                return tree.begin();
+            }
+            const_iterator end() const
+            {
+                return tree.end();
+            }
+
+            void swap(This &other)
+            {
+                tree.swap(other.tree);
+            }
+        };
+
+        template <class K, class T, class R, class P, class Acc, class R2, class Acc2>
+        bool operator==(btree_map<K,T,R,P,Acc> const &A, btree_map<K,T,R2,P,Acc2> const &B)
+        {
+            return A.size() == B.size() && std::equal(A.begin(), A.end(), B.begin());
+        }
+        template <class K, class T, class R, class P, class Acc, class R2, class Acc2>
+        bool operator!=(btree_map<K,T,R,P,Acc> const &A, btree_map<K,T,R2,P,Acc2> const &B)
+        {
+            return !(A == B);
+        }
+
+    } // namespace monotonic
+
+} // namespace boost
+
+#include <monotonic/detail/postfix.hpp>
+
+#endif // BOOST_MONOTONIC_CONTAINERS_BTREE_MAP_HPP
+
+//EOF
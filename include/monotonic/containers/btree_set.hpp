@@ -0,0 +1,232 @@
+// Copyright (C) 2009-2020 Christian@Schladetsch.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MONOTONIC_CONTAINERS_BTREE_SET_HPP
+#define BOOST_MONOTONIC_CONTAINERS_BTREE_SET_HPP
+
+#include <iterator>
+#include <utility>
+#include <monotonic/detail/prefix.hpp>
+#include <monotonic/detail/container.hpp>
+#include <monotonic/detail/btree.hpp>
+#include <monotonic/allocator.hpp>
+
+namespace boost
+{
+    namespace monotonic
+    {
+        /// an ordered set whose nodes are made directly in monotonic storage.
+        ///
+        /// this is the B+tree of btree_map, without mapped values. inserting and erasing
+        /// invalidate iterators.
+        template <class T
+            , class Region = default_region_tag        // allocation region
+            , class P = std::less<T>                // predicate
+            , class Access = default_access_tag>    // access type
+        struct btree_set : detail::container<btree_set<T,Region,P,Access> >
+        {
+            typedef allocator<T,Region,Access> Allocator;
+            typedef Allocator allocator_type;
+            typedef P Predicate;
+            typedef detail::btree<T, void, P> Tree;
+
+            typedef T key_type;
+            typedef T value_type;
+            typedef P key_compare;
+            typedef P value_compare;
+            typedef T const &reference;
+            typedef T const &const_reference;
+            typedef typename Tree::const_iterator iterator;
+            typedef typename Tree::const_iterator const_iterator;
+            typedef size_t size_type;
+            typedef btree_set<T,Region,P,Access> This;
+
+        private:
+            Tree tree;
+
+        public:
+            btree_set()
+                : tree(Allocator().get_storage(), Predicate()) { }
+            btree_set(Allocator const &A)
+                : tree(A.get_storage(), Predicate()) { }
+            btree_set(Predicate const &Pr, Allocator const &A = Allocator())
+                : tree(A.get_storage(), Pr) { }
+            btree_set(btree_set const &other)
+                : tree(other.tree.store, other.tree.comp)
+            {
+                tree.bulk_load(other.begin(), other.end());
+            }
+            btree_set(btree_set &&other) noexcept
+                : tree(other.tree.store, other.tree.comp)
+            {
+                tree.swap(other.tree);
+            }
+            btree_set(btree_set const &other, Allocator const &A)
+                : tree(A.get_storage(), other.tree.comp)
+            {
+                tree.bulk_load(other.begin(), other.end());
+            }
+            /// takes other's nodes if A uses the same storage, otherwise copies its elements into A
+            btree_set(btree_set &&other, Allocator const &A)
+                : tree(A.get_storage(), other.tree.comp)
+            {
+                if (tree.store == other.tree.store)
+                    tree.swap(other.tree);
+                else
+                    tree.bulk_load(other.begin(), other.end());
+            }
+            template <class II>
+            btree_set(II F, II L, Predicate const &Pr = Predicate(), Allocator const &A = Allocator())
+                : tree(A.get_storage(), Pr)
+            {
+                insert(F, L);
+            }
+            /// make the set bottom-up from a range sorted by Pr, with no equivalent values
+            template <class FI>
+            btree_set(ordered_unique_range_t, FI F, FI L, Predicate const &Pr = Predicate(), Allocator const &A = Allocator())
+                : tree(A.get_storage(), Pr)
+            {
+                tree.bulk_load(F, L);
+            }
+
+            btree_set &operator=(btree_set const &other)
+            {
+                if (this != &other)
+                {
+                    tree.clear();
+                    tree.comp = other.tree.comp;
+                    tree.bulk_load(other.begin(), other.end());
+                }
+                return *this;
+            }
+            btree_set &operator=(btree_set &&other)
+            {
+                if (this == &other)
+                    return *this;
+                if (tree.store == other.tree.store)
+                {
+                    // other keeps our nodes for reuse
+                    tree.swap(other.tree);
+                    other.tree.clear();
+                    return *this;
+                }
+                tree.clear();
+                tree.comp = other.tree.comp;
+                tree.bulk_load(other.begin(), other.end());
+                return *this;
+            }
+
+            Allocator get_allocator() const
+            {
+                return Allocator(*tree.store);
+            }
+            key_compare key_comp() const
+            {
+                return tree.comp;
+            }
+            value_compare value_comp() const
+            {
+                return tree.comp;
+            }
+            bool empty() const
+            {
+                return tree.count == 0;
+            }
+            size_type size() const
+            {
+                return tree.count;
+            }
+
+            std::pair<iterator, bool> insert(value_type const &value)
+            {
+                return tree.emplace(value);
+            }
+            std::pair<iterator, bool> insert(value_type &&value)
+            {
+                return tree.emplace(std::move(value));
+            }
+            template <class II>
+            void insert(II F, II L)
+            {
+                for (; F != L; ++F)
+                    insert(*F);
+            }
+
+            iterator find(value_type const &value) const
+            {
+                return tree.find(value);
+            }
+            size_type count(value_type const &value) const
+            {
+                return tree.find(value) != tree.end();
+            }
+            iterator lower_bound(value_type const &value) const
+            {
+                return tree.lower_bound(value);
+            }
+            iterator upper_bound(value_type const &value) const
+            {
+                return tree.upper_bound(value);
+            }
+            std::pair<iterator, iterator> equal_range(value_type const &value) const
+            {
+                return std::make_pair(lower_bound(value), upper_bound(value));
+            }
+
+            /// remove a value. nodes are not merged, and the memory of an emptied node is
+            /// not reclaimed until the set is cleared
+            iterator erase(const_iterator where)
+            {
+                return tree.erase(typename Tree::iterator(where.leaf, where.index));
+            }
+            size_type erase(value_type const &value)
+            {
+                typename Tree::iterator where = tree.find(value);
+                if (where == tree.end())
+                    return 0;
+                tree.erase(where);
+                return 1;
+            }
+            /// remove all values, keeping the nodes for reuse
+            void clear()
+            {
+                tree.clear();
+            }
+
+            iterator begin() const
+            {
+                return tree.begin();
+            }
+            iterator end() const
+            {
+                return tree.end();
+            }
+
+            void swap(This &other)
+            {
+                tree.swap(other.tree);
+            }
+        };
+
+        template <class T, class R, class P, class Acc, class R2, class Acc2>
+        bool operator==(btree_set<T,R,P,Acc> const &A, btree_set<T,R2,P,Acc2> const &B)
+        {
+            return A.size() == B.size() && std::equal(A.begin(), A.end(), B.begin());
+        }
+        template <class T, class R, class P, class Acc, class R2, class Acc2>
+        bool operator!=(btree_set<T,R,P,Acc> const &A, btree_set<T,R2,P,Acc2> const &B)
+        {
+            return !(A == B);
+        }
+
+    } // namespace monotonic
+
+} // namespace boost
+
+#include <monotonic/detail/postfix.hpp>
+
+#endif // BOOST_MONOTONIC_CONTAINERS_BTREE_SET_HPP
+
+//EOF
@@ -7,6 +7,7 @@
 
 #include <boost/iterator.hpp>
 #include <boost/iterator/iterator_categories.hpp>
+#include <boost/foreach.hpp>
 #include <monotonic/utility/iter_range.hpp>
 
 #include <monotonic/detail/prefix.hpp>
@@ -1,147 +1,689 @@
 // Copyright (C) 2009-2020 Christian@Schladetsch.com
 //
-//  Distributed under the Boost Software License, Version 1.0. (See accompanying 
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
 //  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 
 #pragma once
 
+#include <new>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 #include <monotonic/detail/prefix.hpp>
-#include <boost/interprocess/containers/deque.hpp>
 #include <monotonic/detail/container.hpp>
+#include <monotonic/allocator.hpp>
 
 namespace boost
 {
     namespace monotonic
     {
-        /// a vector that uses a monotonic allocator in the given region, with given access system
+        namespace detail
+        {
+            /// the number of T in each block of a deque: 512 bytes, but at least 8
+            template <class T>
+            struct deque_block_size
+            {
+                static constexpr size_t value = 8*sizeof(T) > 512 ? 8 : 512/sizeof(T);
+            };
+
+            /// a fixed-size piece of the map of a deque, holding pointers to blocks of
+            /// elements. segments are chained in both directions, and numbered so that
+            /// iterators can find the distance between blocks in different segments
+            template <class T>
+            struct deque_segment
+            {
+                enum { Size = 32 };
+
+                deque_segment *prev, *next;
+                ptrdiff_t number;
+                T *blocks[Size];            ///< null if the slot has no block
+            };
+
+            /// the quotient of a/b, rounded down
+            inline ptrdiff_t floor_divide(ptrdiff_t a, ptrdiff_t b)
+            {
+                return a >= 0 ? a/b : -((-a - 1)/b) - 1;
+            }
+
+            /// a bidirectional iterator that also has the operators of a random access one.
+            /// the difference of two iterators and their ordering are constant time, but
+            /// jumps with +=, -= and [] walk the chain of segments, so the iterator does not
+            /// claim random access, for which standard algorithms expect constant-time jumps
+            template <class T, class Value>
+            struct deque_iterator
+            {
+                typedef std::bidirectional_iterator_tag iterator_category;
+                typedef T value_type;
+                typedef ptrdiff_t difference_type;
+                typedef Value *pointer;
+                typedef Value &reference;
+                typedef deque_segment<T> Segment;
+
+                enum { BlockSize = deque_block_size<T>::value };
+
+                T *cur, *first, *last;        ///< the element, and the bounds of its block
+                Segment *segment;
+                ptrdiff_t slot;
+
+                deque_iterator() : cur(0), first(0), last(0), segment(0), slot(0) { }
+                deque_iterator(Segment *S, ptrdiff_t N, T *C) : cur(C), segment(S), slot(N)
+                {
+                    first = S->blocks[N];
+                    last = first + BlockSize;
+                }
+                /// a const_iterator from an iterator
+                template <class V, detail::enable_const_conversion<V, T, Value> = 0>
+                deque_iterator(deque_iterator<T, V> const &other)
+                    : cur(other.cur), first(other.first), last(other.last), segment(other.segment), slot(other.slot) { }
+
+                /// move to the start of the block at the given slot, counted from the start of
+                /// the current segment. the block must exist
+                void set_block(ptrdiff_t index)
+                {
+                    for (; index >= ptrdiff_t(Segment::Size); index -= Segment::Size)
+                        segment = segment->next;
+                    for (; index < 0; index += Segment::Size)
+                        segment = segment->prev;
+                    slot = index;
+                    cur = first = segment->blocks[slot];
+                    last = first + BlockSize;
+                }
+
+                reference operator*() const
+                {
+                    return *cur;
+                }
+                pointer operator->() const
+                {
+                    return cur;
+                }
+                reference operator[](difference_type n) const
+                {
+                    return *(*this + n);
+                }
+                deque_iterator &operator++()
+                {
+                    if (++cur == last)
+                    {
+                        if (++slot == Segment::Size)
+                        {
+                            segment = segment->next;
+                            slot = 0;
+                        }
+                        cur = first = segment->blocks[slot];
+                        last = first + BlockSize;
+                    }
+                    return *this;
+                }
+                deque_iterator operator++(int)
+                {
+                    deque_iterator tmp = *this;
+                    ++*this;
+                    return tmp;
+                }
+                deque_iterator &operator--()
+                {
+                    if (cur == first)
+                    {
+                        set_block(slot - 1);
+                        cur = last;
+                    }
+                    --cur;
+                    return *this;
+                }
+                deque_iterator operator--(int)
+                {
+                    deque_iterator tmp = *this;
+                    --*this;
+                    return tmp;
+                }
+                /// moving across blocks walks the chain of segments, one segment per
+                /// Segment::Size*BlockSize elements
+                deque_iterator &operator+=(difference_type n)
+                {
+                    difference_type offset = (cur - first) + n;
+                    if (offset >= 0 && offset < difference_type(BlockSize))
+                    {
+                        cur += n;
+                        return *this;
+                    }
+                    difference_type blocks = floor_divide(offset, BlockSize);
+                    set_block(slot + blocks);
+                    cur = first + (offset - blocks*difference_type(BlockSize));
+                    return *this;
+                }
+                deque_iterator &operator-=(difference_type n)
+                {
+                    return *this += -n;
+                }
+                friend deque_iterator operator+(deque_iterator A, difference_type n)
+                {
+                    return A += n;
+                }
+                friend deque_iterator operator+(difference_type n, deque_iterator A)
+                {
+                    return A += n;
+                }
+                friend deque_iterator operator-(deque_iterator A, difference_type n)
+                {
+                    return A -= n;
+                }
+                friend difference_type operator-(deque_iterator const &A, deque_iterator const &B)
+                {
+                    if (A.segment == B.segment && A.slot == B.slot)
+                        return A.cur - B.cur;
+                    difference_type blocks = (A.segment->number - B.segment->number)*Segment::Size + A.slot - B.slot;
+                    return blocks*difference_type(BlockSize) + (A.cur - A.first) - (B.cur - B.first);
+                }
+                friend bool operator==(deque_iterator const &A, deque_iterator const &B)
+                {
+                    return A.cur == B.cur;
+                }
+                friend bool operator!=(deque_iterator const &A, deque_iterator const &B)
+                {
+                    return A.cur != B.cur;
+                }
+                friend bool operator<(deque_iterator const &A, deque_iterator const &B)
+                {
+                    return A - B < 0;
+                }
+                friend bool operator>(deque_iterator const &A, deque_iterator const &B)
+                {
+                    return B < A;
+                }
+                friend bool operator<=(deque_iterator const &A, deque_iterator const &B)
+                {
+                    return !(B < A);
+                }
+                friend bool operator>=(deque_iterator const &A, deque_iterator const &B)
+                {
+                    return !(A < B);
+                }
+            };
+
+        } // namespace detail
+
+        /// a double-ended queue that uses a monotonic allocator in the given region, with given access system.
+        ///
+        /// elements are kept in fixed-size blocks, and the map of blocks is itself a chain of
+        /// fixed-size segments. growing at either end adds a block, and sometimes a segment, but
+        /// never copies or abandons the map as a std::deque does. blocks and segments emptied by
+        /// popping are kept by the deque and reused, so a deque used as a queue stops taking
+        /// memory from the storage once it reaches its largest size.
+        ///
+        /// indexing is constant time within a segment, but otherwise walks the chain of
+        /// segments, each of which holds 32 blocks, so it is linear in the distance. for
+        /// that reason the iterators are bidirectional; see detail::deque_iterator
         template <class T, class Region = default_region_tag, class Access = default_access_tag>
         struct deque : detail::container<deque<T,Region,Access> >
         {
             typedef allocator<T,Region,Access> Allocator;
-            typedef detail::container<std::vector<T, Allocator > > Parent;
-            typedef detail::Create<detail::is_monotonic<T>::value, T> Create;
-            typedef interprocess::deque<T,Allocator> Impl;
-
-            typedef typename Impl::iterator iterator;
-            typedef typename Impl::const_iterator const_iterator;
-            typedef typename Impl::size_type size_type;
-            typedef typename Impl::value_type value_type;
-            typedef typename Impl::reference reference;
-            typedef typename Impl::const_reference const_reference;
+            typedef Allocator allocator_type;
+            typedef T value_type;
+            typedef T &reference;
+            typedef T const &const_reference;
+            typedef size_t size_type;
+            typedef ptrdiff_t difference_type;
+            typedef detail::deque_iterator<T, T> iterator;
+            typedef detail::deque_iterator<T, T const> const_iterator;
+            typedef deque<T,Region,Access> This;
 
         private:
-            Impl impl;
+            typedef detail::deque_segment<T> Segment;
+
+            enum
+            {
+                BlockSize = detail::deque_block_size<T>::value,
+                SegmentSize = Segment::Size,
+                BlockAlignment = alignof(T) > alignof(void *) ? alignof(T) : alignof(void *),
+            };
+
+            /// a block or segment that is not in use, kept for reuse
+            struct spare_link
+            {
+                spare_link *next;
+            };
+
+            storage_base *store;
+            iterator start, finish;        ///< once the map exists, finish always has room for one more element
+            size_type count;
+            spare_link *spare_blocks, *spare_segments;
 
         public:
-            deque() { }
-            deque(Allocator A) 
-                : impl(A) { }
-            deque(size_t N, T const &X, Allocator A = Allocator())
-                : impl(N,X,A) { }
-            template <class II>
-            deque(II F, II L, Allocator A = Allocator())
-                : impl(F,L,A) { }
+            deque()
+                : store(Allocator().get_storage()), count(0), spare_blocks(0), spare_segments(0) { }
+            deque(Allocator const &A)
+                : store(A.get_storage()), count(0), spare_blocks(0), spare_segments(0) { }
+            deque(deque const &other)
+                : store(other.store), count(0), spare_blocks(0), spare_segments(0)
+            {
+                append(other.begin(), other.end());
+            }
+            deque(deque &&other) noexcept
+                : store(other.store), count(0), spare_blocks(0), spare_segments(0)
+            {
+                swap(other);
+            }
+            deque(deque const &other, Allocator const &A)
+                : store(A.get_storage()), count(0), spare_blocks(0), spare_segments(0)
+            {
+                append(other.begin(), other.end());
+            }
+            /// takes other's blocks if A uses the same storage, otherwise moves its elements into A
+            deque(deque &&other, Allocator const &A)
+                : store(A.get_storage()), count(0), spare_blocks(0), spare_segments(0)
+            {
+                if (store == other.store)
+                    swap(other);
+                else
+                    append(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+            }
+            deque(size_t N, T const &X, Allocator const &A = Allocator())
+                : store(A.get_storage()), count(0), spare_blocks(0), spare_segments(0)
+            {
+                resize(N, X);
+            }
+            template <class II, class = typename std::iterator_traits<II>::iterator_category>
+            deque(II F, II L, Allocator const &A = Allocator())
+                : store(A.get_storage()), count(0), spare_blocks(0), spare_segments(0)
+            {
+                append(F, L);
+            }
 
-            Allocator get_allocator() const
+            ~deque()
             {
-                return impl.get_allocator();
+                destroy_elements(std::is_trivially_destructible<T>());
             }
-            Impl const &get_impl() const
+
+            deque &operator=(deque const &other)
             {
-                return impl;
+                if (this != &other)
+                {
+                    clear();
+                    append(other.begin(), other.end());
+                }
+                return *this;
             }
-            Impl &get_impl()
+            deque &operator=(deque &&other)
             {
-                return impl;
+                if (this == &other)
+                    return *this;
+                if (store == other.store)
+                {
+                    // other keeps our blocks for reuse
+                    swap(other);
+                    other.clear();
+                    return *this;
+                }
+                clear();
+                append(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+                return *this;
+            }
+
+            Allocator get_allocator() const
+            {
+                return Allocator(*store);
             }
             bool empty() const
             {
-                return impl.empty();
+                return count == 0;
             }
             size_type size() const
             {
-                return impl.size();
+                return count;
             }
             void resize(size_type size)
             {
-                impl.resize(size);//, Creator::Create(GetStorage()));
-            }
-            void reserve(size_type size)
-            {
-                impl.reserve(size);
+                while (count > size)
+                    pop_back();
+                while (count < size)
+                    emplace_back();
             }
-            size_type capacity() const
+            void resize(size_type size, value_type const &value)
             {
-                return impl.capacity();
+                while (count > size)
+                    pop_back();
+                while (count < size)
+                    push_back(value);
             }
             reference at(size_type index)
             {
-                return impl.at(index);
+                if (index >= count)
+                    throw std::out_of_range("deque");
+                return (*this)[index];
             }
             const_reference at(size_type index) const
             {
-                return impl.at(index);
+                if (index >= count)
+                    throw std::out_of_range("deque");
+                return (*this)[index];
             }
+            /// walks from the nearer end, one segment per 32 blocks
             reference operator[](size_type index)
             {
-                return impl[index];
+                if (index < count/2)
+                    return *(begin() + index);
+                return *(end() - (count - index));
             }
             const_reference operator[](size_type index) const
             {
-                return impl[index];
+                return const_cast<This &>(*this)[index];
+            }
+
+            template <class... Args>
+            reference emplace_back(Args&&... args)
+            {
+                make_map();
+                new (finish.cur) T(std::forward<Args>(args)...);
+                return commit_back();
             }
             void push_back(value_type const &value)
             {
-                impl.push_back(value);
+                make_map();
+                get_allocator().construct(finish.cur, value);
+                commit_back();
+            }
+            void push_back(value_type &&value)
+            {
+                make_map();
+                get_allocator().construct(finish.cur, std::move(value));
+                commit_back();
             }
             void pop_back()
             {
-                impl.pop_back();
+                if (finish.cur == finish.first)
+                {
+                    // the block at finish becomes unused
+                    Segment *segment = finish.segment;
+                    ptrdiff_t slot = finish.slot;
+                    --finish;
+                    release_block(segment->blocks[slot]);
+                    if (finish.segment != segment)
+                        release_segments_after(finish.segment);
+                }
+                else
+                    --finish.cur;
+                --count;
+                finish.cur->~T();
+            }
+
+            template <class... Args>
+            reference emplace_front(Args&&... args)
+            {
+                iterator where = prepare_front();
+                new (where.cur) T(std::forward<Args>(args)...);
+                return commit_front(where);
             }
             void push_front(value_type const &value)
             {
-                impl.push_front(value);
+                iterator where = prepare_front();
+                get_allocator().construct(where.cur, value);
+                commit_front(where);
+            }
+            void push_front(value_type &&value)
+            {
+                iterator where = prepare_front();
+                get_allocator().construct(where.cur, std::move(value));
+                commit_front(where);
             }
             void pop_front()
             {
-                impl.pop_front();
+                start.cur->~T();
+                --count;
+                if (start.cur + 1 == start.last)
+                {
+                    // the block at start becomes unused
+                    Segment *segment = start.segment;
+                    ptrdiff_t slot = start.slot;
+                    ++start;
+                    release_block(segment->blocks[slot]);
+                    if (start.segment != segment)
+                        release_segments_before(start.segment);
+                }
+                else
+                    ++start.cur;
             }
+
+            /// append a range of values to the end
+            template <class II>
+            void append(II first, II last)
+            {
+                for (; first != last; ++first)
+                    emplace_back(*first);
+            }
+
+            /// remove all elements, keeping one block and segment; the others are kept for reuse
+            void clear()
+            {
+                if (start.segment == 0)
+                    return;
+                destroy_elements(std::is_trivially_destructible<T>());
+                while (finish.segment != start.segment || finish.slot != start.slot)
+                {
+                    release_block(finish.segment->blocks[finish.slot]);
+                    finish.set_block(finish.slot - 1);
+                }
+                release_segments_after(start.segment);
+                start.cur = start.first + BlockSize/2;
+                finish = start;
+                count = 0;
+            }
+
             iterator begin()
             {
-                return impl.begin();
+                return start;
             }
             iterator end()
             {
-                return impl.end();
+                return finish;
             }
             const_iterator begin() const
             {
-                return impl.begin();
+                return start;
             }
             const_iterator end() const
             {
-                return impl.end();
+                return finish;
             }
             value_type const &front() const
             {
-                return impl.front();
+                return *start;
             }
             value_type &front()
             {
-                return impl.front();
+                return *start;
             }
             value_type const &back() const
             {
-                return impl.back();
+                return *(finish - 1);
             }
             value_type &back()
             {
-                return impl.back();
+                return *(finish - 1);
+            }
+
+            void swap(This &other)
+            {
+                std::swap(store, other.store);
+                std::swap(start, other.start);
+                std::swap(finish, other.finish);
+                std::swap(count, other.count);
+                std::swap(spare_blocks, other.spare_blocks);
+                std::swap(spare_segments, other.spare_segments);
+            }
+
+        private:
+            void *allocate_bytes(size_t num_bytes, size_t alignment)
+            {
+                void *ptr = store->allocate(num_bytes, alignment);
+                if (ptr == 0)
+                    throw std::bad_alloc();
+                return ptr;
+            }
+
+            T *acquire_block()
+            {
+                if (spare_link *spare = spare_blocks)
+                {
+                    spare_blocks = spare->next;
+                    return reinterpret_cast<T *>(spare);
+                }
+                return static_cast<T *>(allocate_bytes(BlockSize*sizeof(T), BlockAlignment));
+            }
+
+            void release_block(T *&block)
+            {
+                spare_blocks = new (block) spare_link{spare_blocks};
+                block = 0;
+            }
+
+            Segment *acquire_segment()
+            {
+                void *ptr = spare_segments;
+                if (ptr)
+                    spare_segments = spare_segments->next;
+                else
+                    ptr = allocate_bytes(sizeof(Segment), alignof(Segment));
+                Segment *segment = static_cast<Segment *>(ptr);
+                segment->prev = segment->next = 0;
+                std::fill_n(segment->blocks, SegmentSize, static_cast<T *>(0));
+                return segment;
+            }
+
+            void release_segment(Segment *segment)
+            {
+                for (ptrdiff_t slot = 0; slot < SegmentSize; ++slot)
+                {
+                    if (segment->blocks[slot])
+                        release_block(segment->blocks[slot]);
+                }
+                spare_segments = new (segment) spare_link{spare_segments};
+            }
+
+            void release_segments_after(Segment *segment)
+            {
+                for (Segment *next = segment->next; next != 0; )
+                {
+                    Segment *after = next->next;
+                    release_segment(next);
+                    next = after;
+                }
+                segment->next = 0;
+            }
+
+            void release_segments_before(Segment *segment)
+            {
+                for (Segment *prev = segment->prev; prev != 0; )
+                {
+                    Segment *before = prev->prev;
+                    release_segment(prev);
+                    prev = before;
+                }
+                segment->prev = 0;
+            }
+
+            /// make the first segment and block, starting in the middle of both so that
+            /// the deque can grow in either direction
+            void make_map()
+            {
+                if (start.segment != 0)
+                    return;
+                Segment *segment = acquire_segment();
+                segment->number = 0;
+                ptrdiff_t slot = SegmentSize/2;
+                segment->blocks[slot] = acquire_block();
+                start = iterator(segment, slot, segment->blocks[slot] + BlockSize/2);
+                finish = start;
+            }
+
+            /// make sure the block after the one at finish exists
+            void reserve_block_after()
+            {
+                Segment *segment = finish.segment;
+                ptrdiff_t slot = finish.slot + 1;
+                if (slot == SegmentSize)
+                {
+                    if (segment->next == 0)
+                    {
+                        Segment *next = acquire_segment();
+                        next->number = segment->number + 1;
+                        next->prev = segment;
+                        segment->next = next;
+                    }
+                    segment = segment->next;
+                    slot = 0;
+                }
+                if (segment->blocks[slot] == 0)
+                    segment->blocks[slot] = acquire_block();
+            }
+
+            /// make sure the block before the one at start exists
+            void reserve_block_before()
+            {
+                Segment *segment = start.segment;
+                ptrdiff_t slot = start.slot - 1;
+                if (slot < 0)
+                {
+                    if (segment->prev == 0)
+                    {
+                        Segment *prev = acquire_segment();
+                        prev->number = segment->number - 1;
+                        prev->next = segment;
+                        segment->prev = prev;
+                    }
+                    segment = segment->prev;
+                    slot = SegmentSize - 1;
+                }
+                if (segment->blocks[slot] == 0)
+                    segment->blocks[slot] = acquire_block();
+            }
+
+            /// account for the element just made at finish, keeping room for the next
+            reference commit_back()
+            {
+                if (finish.cur + 1 == finish.last)
+                {
+                    try
+                    {
+                        reserve_block_after();
+                    }
+                    catch (...)
+                    {
+                        finish.cur->~T();
+                        throw;
+                    }
+                }
+                ++count;
+                return *finish++;
+            }
+
+            /// the position of a new front element
+            iterator prepare_front()
+            {
+                make_map();
+                if (start.cur == start.first)
+                    reserve_block_before();
+                iterator where = start;
+                return --where;
+            }
+
+            reference commit_front(iterator const &where)
+            {
+                start = where;
+                ++count;
+                return *start;
+            }
+
+            void destroy_elements(std::true_type)
+            {
             }
 
-            void swap(deque &other)
+            void destroy_elements(std::false_type)
             {
-                impl.swap(other.impl);
+                for (iterator iter = start; iter != finish; ++iter)
+                    iter.cur->~T();
             }
         };
 
@@ -0,0 +1,572 @@
+// Copyright (C) 2009-2020 Christian@Schladetsch.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MONOTONIC_CONTAINERS_DYNAMIC_BITSET_HPP
+#define BOOST_MONOTONIC_CONTAINERS_DYNAMIC_BITSET_HPP
+
+#include <new>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <monotonic/detail/prefix.hpp>
+#include <monotonic/detail/container.hpp>
+#include <monotonic/allocator.hpp>
+
+#ifdef BOOST_MONOTONIC_SSE2
+#    include <emmintrin.h>
+#endif
+#ifdef _MSC_VER
+#    include <intrin.h>
+#endif
+
+namespace boost
+{
+    namespace monotonic
+    {
+        namespace detail
+        {
+            typedef std::uint64_t bitset_block;
+
+            /// the number of set bits in a block
+            inline size_t bitset_popcount(bitset_block x)
+            {
+#if defined(BOOST_MONOTONIC_POPCNT) && defined(_MSC_VER)
+                return size_t(__popcnt64(x));
+#elif defined(__GNUC__)
+                return size_t(__builtin_popcountll(x));
+#else
+                x = x - ((x >> 1) & 0x5555555555555555ull);
+                x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+                x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+                return size_t((x*0x0101010101010101ull) >> 56);
+#endif
+            }
+
+            /// the index of the lowest set bit of a block that is not zero
+            inline size_t bitset_lowest(bitset_block x)
+            {
+#if defined(__GNUC__)
+                return size_t(__builtin_ctzll(x));
+#elif defined(_MSC_VER) && defined(_M_X64)
+                unsigned long index;
+                _BitScanForward64(&index, x);
+                return size_t(index);
+#else
+                return bitset_popcount((x & (0 - x)) - 1);
+#endif
+            }
+
+            /// the number of set bits in num blocks. without POPCNT, pairs of blocks are
+            /// counted in parallel with SSE2, summing the bytes of each pair with psadbw
+            inline size_t bitset_count(bitset_block const *blocks, size_t num)
+            {
+                size_t total = 0;
+                size_t n = 0;
+#if defined(BOOST_MONOTONIC_SSE2) && !defined(BOOST_MONOTONIC_POPCNT)
+                __m128i const m1 = _mm_set1_epi8(0x55);
+                __m128i const m2 = _mm_set1_epi8(0x33);
+                __m128i const m4 = _mm_set1_epi8(0x0F);
+                __m128i const zero = _mm_setzero_si128();
+                __m128i sum = zero;
+                for (; n + 2 <= num; n += 2)
+                {
+                    __m128i x = _mm_loadu_si128(reinterpret_cast<__m128i const *>(blocks + n));
+                    x = _mm_sub_epi8(x, _mm_and_si128(_mm_srli_epi64(x, 1), m1));
+                    x = _mm_add_epi8(_mm_and_si128(x, m2), _mm_and_si128(_mm_srli_epi64(x, 2), m2));
+                    x = _mm_and_si128(_mm_add_epi8(x, _mm_srli_epi64(x, 4)), m4);
+                    sum = _mm_add_epi64(sum, _mm_sad_epu8(x, zero));
+                }
+                alignas(16) bitset_block parts[2];
+                _mm_store_si128(reinterpret_cast<__m128i *>(parts), sum);
+                total = size_t(parts[0] + parts[1]);
+#endif
+                for (; n < num; ++n)
+                    total += bitset_popcount(blocks[n]);
+                return total;
+            }
+
+            struct bitset_and
+            {
+                static bitset_block apply(bitset_block a, bitset_block b) { return a & b; }
+#ifdef BOOST_MONOTONIC_SSE2
+                static __m128i apply(__m128i a, __m128i b) { return _mm_and_si128(a, b); }
+#endif
+            };
+            struct bitset_or
+            {
+                static bitset_block apply(bitset_block a, bitset_block b) { return a | b; }
+#ifdef BOOST_MONOTONIC_SSE2
+                static __m128i apply(__m128i a, __m128i b) { return _mm_or_si128(a, b); }
+#endif
+            };
+            struct bitset_xor
+            {
+                static bitset_block apply(bitset_block a, bitset_block b) { return a ^ b; }
+#ifdef BOOST_MONOTONIC_SSE2
+                static __m128i apply(__m128i a, __m128i b) { return _mm_xor_si128(a, b); }
+#endif
+            };
+            struct bitset_and_not
+            {
+                static bitset_block apply(bitset_block a, bitset_block b) { return a & ~b; }
+#ifdef BOOST_MONOTONIC_SSE2
+                static __m128i apply(__m128i a, __m128i b) { return _mm_andnot_si128(b, a); }
+#endif
+            };
+
+            /// dest[n] = Op(dest[n], src[n]) for num blocks, two blocks at a time with SSE2
+            template <class Op>
+            void bitset_combine(bitset_block *dest, bitset_block const *src, size_t num)
+            {
+                size_t n = 0;
+#ifdef BOOST_MONOTONIC_SSE2
+                for (; n + 2 <= num; n += 2)
+                {
+                    __m128i a = _mm_loadu_si128(reinterpret_cast<__m128i const *>(dest + n));
+                    __m128i b = _mm_loadu_si128(reinterpret_cast<__m128i const *>(src + n));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + n), Op::apply(a, b));
+                }
+#endif
+                for (; n < num; ++n)
+                    dest[n] = Op::apply(dest[n], src[n]);
+            }
+
+        } // namespace detail
+
+        /// a bitset whose size is set at runtime, with blocks made in monotonic storage.
+        ///
+        /// the bits are packed into 64-bit blocks, so that count, find_first and
+        /// find_next skip whole blocks at a time, and the bulk operations combine two
+        /// blocks per instruction with SSE2. bits past size() in the last block are always
+        /// zero. the bulk operations require both bitsets to have the same size.
+        template <class Region = default_region_tag, class Access = default_access_tag>
+        struct dynamic_bitset : detail::container<dynamic_bitset<Region,Access> >
+        {
+            typedef detail::bitset_block block_type;
+            typedef allocator<block_type,Region,Access> Allocator;
+            typedef Allocator allocator_type;
+            typedef size_t size_type;
+            typedef dynamic_bitset<Region,Access> This;
+
+            static constexpr size_type bits_per_block = 64;
+            static constexpr size_type npos = size_type(-1);
+
+            /// a proxy for one bit
+            struct reference
+            {
+                block_type *block;
+                block_type mask;
+
+                reference(block_type *B, block_type M) : block(B), mask(M) { }
+
+                operator bool() const
+                {
+                    return (*block & mask) != 0;
+                }
+                bool operator~() const
+                {
+                    return (*block & mask) == 0;
+                }
+                reference &operator=(bool value)
+                {
+                    if (value)
+                        *block |= mask;
+                    else
+                        *block &= ~mask;
+                    return *this;
+                }
+                reference &operator=(reference const &other)
+                {
+                    return *this = bool(other);
+                }
+                reference &flip()
+                {
+                    *block ^= mask;
+                    return *this;
+                }
+            };
+
+        private:
+            storage_base *store;
+            block_type *blocks;
+            size_type num_bits;
+            size_type capacity;        ///< in blocks
+
+        public:
+            dynamic_bitset()
+                : store(Allocator().get_storage()), blocks(0), num_bits(0), capacity(0) { }
+            dynamic_bitset(Allocator const &A)
+                : store(A.get_storage()), blocks(0), num_bits(0), capacity(0) { }
+            dynamic_bitset(size_type num, Allocator const &A = Allocator())
+                : store(A.get_storage()), blocks(0), num_bits(0), capacity(0)
+            {
+                resize(num);
+            }
+            dynamic_bitset(size_type num, bool value, Allocator const &A = Allocator())
+                : store(A.get_storage()), blocks(0), num_bits(0), capacity(0)
+            {
+                resize(num, value);
+            }
+            dynamic_bitset(dynamic_bitset const &other)
+                : store(other.store), blocks(0), num_bits(0), capacity(0)
+            {
+                assign(other);
+            }
+            dynamic_bitset(dynamic_bitset &&other) noexcept
+                : store(other.store), blocks(0), num_bits(0), capacity(0)
+            {
+                take(other);
+            }
+            dynamic_bitset(dynamic_bitset const &other, Allocator const &A)
+                : store(A.get_storage()), blocks(0), num_bits(0), capacity(0)
+            {
+                assign(other);
+            }
+            /// takes other's blocks if A uses the same storage, otherwise copies them into A
+            dynamic_bitset(dynamic_bitset &&other, Allocator const &A)
+                : store(A.get_storage()), blocks(0), num_bits(0), capacity(0)
+            {
+                if (store == other.store)
+                    take(other);
+                else
+                    assign(other);
+            }
+
+            dynamic_bitset &operator=(dynamic_bitset const &other)
+            {
+                if (this != &other)
+                    assign(other);
+                return *this;
+            }
+            dynamic_bitset &operator=(dynamic_bitset &&other)
+            {
+                if (this == &other)
+                    return *this;
+                if (store == other.store)
+                {
+                    abandon();
+                    take(other);
+                }
+                else
+                {
+                    assign(other);
+                }
+                return *this;
+            }
+
+            Allocator get_allocator() const
+            {
+                return Allocator(*store);
+            }
+            bool empty() const
+            {
+                return num_bits == 0;
+            }
+            size_type size() const
+            {
+                return num_bits;
+            }
+            size_type num_blocks() const
+            {
+                return BlocksFor(num_bits);
+            }
+            block_type const *data() const
+            {
+                return blocks;
+            }
+
+            /// make room for num bits
+            void reserve(size_type num)
+            {
+                size_type required = BlocksFor(num);
+                if (required > capacity)
+                    Grow(required);
+            }
+            /// change the number of bits, setting any new bits to value
+            void resize(size_type num, bool value = false)
+            {
+                size_type old_blocks = num_blocks();
+                size_type new_blocks = BlocksFor(num);
+                if (new_blocks > capacity)
+                    Grow((std::max)(new_blocks, 2*capacity));
+                if (new_blocks > old_blocks)
+                    std::memset(blocks + old_blocks, value ? 0xFF : 0, (new_blocks - old_blocks)*sizeof(block_type));
+                if (value && num > num_bits && num_bits % bits_per_block != 0)
+                    blocks[old_blocks - 1] |= ~block_type(0) << (num_bits % bits_per_block);
+                num_bits = num;
+                Trim();
+            }
+            void push_back(bool value)
+            {
+                if (num_bits % bits_per_block == 0)
+                {
+                    resize(num_bits + 1, value);
+                    return;
+                }
+                set(num_bits++, value);
+            }
+            /// remove all bits, keeping the blocks
+            void clear()
+            {
+                num_bits = 0;
+            }
+
+            bool test(size_type pos) const
+            {
+                if (pos >= num_bits)
+                    throw std::out_of_range("dynamic_bitset");
+                return (*this)[pos];
+            }
+            bool operator[](size_type pos) const
+            {
+                return (blocks[pos / bits_per_block] >> (pos % bits_per_block)) & 1;
+            }
+            reference operator[](size_type pos)
+            {
+                return reference(blocks + pos / bits_per_block, Mask(pos));
+            }
+
+            This &set(size_type pos, bool value = true)
+            {
+                (*this)[pos] = value;
+                return *this;
+            }
+            This &set()
+            {
+                std::memset(blocks, 0xFF, num_blocks()*sizeof(block_type));
+                Trim();
+                return *this;
+            }
+            This &reset(size_type pos)
+            {
+                blocks[pos / bits_per_block] &= ~Mask(pos);
+                return *this;
+            }
+            This &reset()
+            {
+                std::memset(blocks, 0, num_blocks()*sizeof(block_type));
+                return *this;
+            }
+            This &flip(size_type pos)
+            {
+                blocks[pos / bits_per_block] ^= Mask(pos);
+                return *this;
+            }
+            This &flip()
+            {
+                for (size_type n = 0, end = num_blocks(); n < end; ++n)
+                    blocks[n] = ~blocks[n];
+                Trim();
+                return *this;
+            }
+
+            /// the number of set bits
+            size_type count() const
+            {
+                return detail::bitset_count(blocks, num_blocks());
+            }
+            bool any() const
+            {
+                for (size_type n = 0, end = num_blocks(); n < end; ++n)
+                {
+                    if (blocks[n] != 0)
+                        return true;
+                }
+                return false;
+            }
+            bool none() const
+            {
+                return !any();
+            }
+            bool all() const
+            {
+                return count() == num_bits;
+            }
+
+            /// the index of the first set bit, or npos if there is none
+            size_type find_first() const
+            {
+                return FindFrom(0);
+            }
+            /// the index of the first set bit after pos, or npos if there is none
+            size_type find_next(size_type pos) const
+            {
+                if (pos + 1 >= num_bits)
+                    return npos;
+                return FindFrom(pos + 1);
+            }
+
+            This &operator&=(This const &other)
+            {
+                return Combine<detail::bitset_and>(other);
+            }
+            This &operator|=(This const &other)
+            {
+                return Combine<detail::bitset_or>(other);
+            }
+            This &operator^=(This const &other)
+            {
+                return Combine<detail::bitset_xor>(other);
+            }
+            /// clear the bits that are set in other
+            This &operator-=(This const &other)
+            {
+                return Combine<detail::bitset_and_not>(other);
+            }
+            This operator~() const
+            {
+                This result(*this);
+                result.flip();
+                return result;
+            }
+
+            /// true if any bit is set in both
+            bool intersects(This const &other) const
+            {
+                for (size_type n = 0, end = (std::min)(num_blocks(), other.num_blocks()); n < end; ++n)
+                {
+                    if ((blocks[n] & other.blocks[n]) != 0)
+                        return true;
+                }
+                return false;
+            }
+            /// true if every bit set here is also set in other
+            bool is_subset_of(This const &other) const
+            {
+                RequireSameSize(other);
+                for (size_type n = 0, end = num_blocks(); n < end; ++n)
+                {
+                    if ((blocks[n] & ~other.blocks[n]) != 0)
+                        return false;
+                }
+                return true;
+            }
+
+            friend bool operator==(This const &A, This const &B)
+            {
+                return A.num_bits == B.num_bits
+                    && (A.num_bits == 0 || std::memcmp(A.blocks, B.blocks, A.num_blocks()*sizeof(block_type)) == 0);
+            }
+            friend bool operator!=(This const &A, This const &B)
+            {
+                return !(A == B);
+            }
+
+            void swap(This &other)
+            {
+                std::swap(store, other.store);
+                std::swap(blocks, other.blocks);
+                std::swap(num_bits, other.num_bits);
+                std::swap(capacity, other.capacity);
+            }
+
+        private:
+            static size_type BlocksFor(size_type num)
+            {
+                return (num + bits_per_block - 1) / bits_per_block;
+            }
+            static block_type Mask(size_type pos)
+            {
+                return block_type(1) << (pos % bits_per_block);
+            }
+
+            /// clear the bits of the last block that are past size()
+            void Trim()
+            {
+                if (num_bits % bits_per_block != 0)
+                    blocks[num_bits / bits_per_block] &= ~(~block_type(0) << (num_bits % bits_per_block));
+            }
+
+            size_type FindFrom(size_type pos) const
+            {
+                size_type index = pos / bits_per_block;
+                size_type end = num_blocks();
+                if (index >= end)
+                    return npos;
+                block_type block = blocks[index] & (~block_type(0) << (pos % bits_per_block));
+                while (block == 0)
+                {
+                    if (++index == end)
+                        return npos;
+                    block = blocks[index];
+                }
+                return index*bits_per_block + detail::bitset_lowest(block);
+            }
+
+            void RequireSameSize(This const &other) const
+            {
+                if (num_bits != other.num_bits)
+                    throw std::invalid_argument("dynamic_bitset");
+            }
+
+            template <class Op>
+            This &Combine(This const &other)
+            {
+                RequireSameSize(other);
+                detail::bitset_combine<Op>(blocks, other.blocks, num_blocks());
+                return *this;
+            }
+
+            void assign(This const &other)
+            {
+                size_type required = other.num_blocks();
+                if (required > capacity)
+                    Grow(required);
+                if (required > 0)
+                    std::memcpy(blocks, other.blocks, required*sizeof(block_type));
+                num_bits = other.num_bits;
+            }
+
+            void take(This &other)
+            {
+                blocks = other.blocks;
+                num_bits = other.num_bits;
+                capacity = other.capacity;
+                other.blocks = 0;
+                other.num_bits = 0;
+                other.capacity = 0;
+            }
+
+            void abandon()
+            {
+                if (blocks)
+                    store->deallocate(blocks);
+                blocks = 0;
+                num_bits = 0;
+                capacity = 0;
+            }
+
+            /// make room for num blocks, in place if the blocks are the last allocation
+            void Grow(size_type num)
+            {
+                if (blocks && store->extend(blocks, capacity*sizeof(block_type), num*sizeof(block_type)))
+                {
+                    capacity = num;
+                    return;
+                }
+                void *ptr = store->allocate(num*sizeof(block_type), alignof(block_type));
+                if (ptr == 0)
+                    throw std::bad_alloc();
+                if (blocks)
+                {
+                    std::memcpy(ptr, blocks, num_blocks()*sizeof(block_type));
+                    store->deallocate(blocks);
+                }
+                blocks = static_cast<block_type *>(ptr);
+                capacity = num;
+            }
+        };
+
+    } // namespace monotonic
+
+} // namespace boost
+
+#include <monotonic/detail/postfix.hpp>
+
+#endif // BOOST_MONOTONIC_CONTAINERS_DYNAMIC_BITSET_HPP
+
+//EOF
@@ -0,0 +1,413 @@
+// Copyright (C) 2009-2020 Christian@Schladetsch.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MONOTONIC_CONTAINERS_ILIST_HPP
+#define BOOST_MONOTONIC_CONTAINERS_ILIST_HPP
+
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <monotonic/detail/prefix.hpp>
+#include <monotonic/containers/slist.hpp>
+
+namespace boost
+{
+    namespace monotonic
+    {
+        namespace detail
+        {
+            struct ilist_link
+            {
+                ilist_link *next, *prev;
+            };
+
+            template <class T>
+            struct ilist_node : ilist_link
+            {
+                T value;
+
+                template <class... Args>
+                ilist_node(Args&&... args) : value(std::forward<Args>(args)...) { }
+            };
+
+            template <class T, class Value>
+            struct ilist_iterator
+            {
+                typedef std::bidirectional_iterator_tag iterator_category;
+                typedef T value_type;
+                typedef ptrdiff_t difference_type;
+                typedef Value *pointer;
+                typedef Value &reference;
+
+                ilist_link *link;
+
+                ilist_iterator(ilist_link *L = 0) : link(L) { }
+                /// a const_iterator from an iterator
+                template <class V, detail::enable_const_conversion<V, T, Value> = 0>
+                ilist_iterator(ilist_iterator<T, V> const &other) : link(other.link) { }
+
+                reference operator*() const
+                {
+                    return static_cast<ilist_node<T> *>(link)->value;
+                }
+                pointer operator->() const
+                {
+                    return &**this;
+                }
+                ilist_iterator &operator++()
+                {
+                    link = link->next;
+                    return *this;
+                }
+                ilist_iterator operator++(int)
+                {
+                    ilist_iterator tmp = *this;
+                    link = link->next;
+                    return tmp;
+                }
+                ilist_iterator &operator--()
+                {
+                    link = link->prev;
+                    return *this;
+                }
+                ilist_iterator operator--(int)
+                {
+                    ilist_iterator tmp = *this;
+                    link = link->prev;
+                    return tmp;
+                }
+                friend bool operator==(ilist_iterator const &A, ilist_iterator const &B)
+                {
+                    return A.link == B.link;
+                }
+                friend bool operator!=(ilist_iterator const &A, ilist_iterator const &B)
+                {
+                    return A.link != B.link;
+                }
+            };
+
+        } // namespace detail
+
+        /// a doubly-linked list whose nodes are made directly in monotonic storage.
+        ///
+        /// as slist, but elements can also be inserted and erased anywhere, and ranges
+        /// can be spliced at any position.
+        template <class T, class Region = default_region_tag, class Access = default_access_tag>
+        struct ilist : detail::container<ilist<T,Region,Access> >
+        {
+            typedef allocator<T,Region,Access> Allocator;
+            typedef Allocator allocator_type;
+            typedef T value_type;
+            typedef T &reference;
+            typedef T const &const_reference;
+            typedef size_t size_type;
+            typedef detail::ilist_iterator<T, T> iterator;
+            typedef detail::ilist_iterator<T, T const> const_iterator;
+            typedef ilist<T,Region,Access> This;
+
+        private:
+            typedef detail::ilist_link Link;
+            typedef detail::ilist_node<T> Node;
+
+            storage_base *store;
+            Link root;            ///< the end of the list; root.next is the front and root.prev the back
+            size_type count;
+
+        public:
+            ilist()
+                : store(Allocator().get_storage()), count(0)
+            {
+                root.next = root.prev = &root;
+            }
+            ilist(Allocator const &A)
+                : store(A.get_storage()), count(0)
+            {
+                root.next = root.prev = &root;
+            }
+            ilist(ilist const &other)
+                : store(other.store), count(0)
+            {
+                root.next = root.prev = &root;
+                append(other.begin(), other.end());
+            }
+            ilist(ilist &&other) noexcept
+                : store(other.store), count(0)
+            {
+                root.next = root.prev = &root;
+                splice(end(), other);
+            }
+            ilist(ilist const &other, Allocator const &A)
+                : store(A.get_storage()), count(0)
+            {
+                root.next = root.prev = &root;
+                append(other.begin(), other.end());
+            }
+            /// takes other's nodes if A uses the same storage, otherwise moves its elements into A
+            ilist(ilist &&other, Allocator const &A)
+                : store(A.get_storage()), count(0)
+            {
+                root.next = root.prev = &root;
+                if (store == other.store)
+                    splice(end(), other);
+                else
+                    append(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+            }
+
+            template <class II, class = typename std::iterator_traits<II>::iterator_category>
+            ilist(II F, II L, Allocator const &A = Allocator())
+                : store(A.get_storage()), count(0)
+            {
+                root.next = root.prev = &root;
+                append(F, L);
+            }
+
+            ~ilist()
+            {
+                clear();
+            }
+
+            ilist &operator=(ilist const &other)
+            {
+                if (this != &other)
+                {
+                    clear();
+                    append(other.begin(), other.end());
+                }
+                return *this;
+            }
+            ilist &operator=(ilist &&other)
+            {
+                if (this != &other)
+                {
+                    clear();
+                    if (store == other.store)
+                        splice(end(), other);
+                    else
+                        append(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+                }
+                return *this;
+            }
+
+            Allocator get_allocator() const
+            {
+                return Allocator(*store);
+            }
+            bool empty() const
+            {
+                return count == 0;
+            }
+            size_type size() const
+            {
+                return count;
+            }
+
+            template <class... Args>
+            iterator emplace(const_iterator where, Args&&... args)
+            {
+                Node *node = new (detail::allocate_nodes<Node>(*store, 1)) Node(std::forward<Args>(args)...);
+                link_before(where.link, node);
+                return iterator(node);
+            }
+            iterator insert(const_iterator where, value_type const &value)
+            {
+                return emplace(where, value);
+            }
+            iterator insert(const_iterator where, value_type &&value)
+            {
+                return emplace(where, std::move(value));
+            }
+            template <class... Args>
+            reference emplace_front(Args&&... args)
+            {
+                return *emplace(begin(), std::forward<Args>(args)...);
+            }
+            template <class... Args>
+            reference emplace_back(Args&&... args)
+            {
+                return *emplace(end(), std::forward<Args>(args)...);
+            }
+            void push_front(value_type const &value)
+            {
+                emplace(begin(), value);
+            }
+            void push_front(value_type &&value)
+            {
+                emplace(begin(), std::move(value));
+            }
+            void push_back(value_type const &value)
+            {
+                emplace(end(), value);
+            }
+            void push_back(value_type &&value)
+            {
+                emplace(end(), std::move(value));
+            }
+            void pop_front()
+            {
+                erase(begin());
+            }
+            void pop_back()
+            {
+                erase(iterator(root.prev));
+            }
+
+            /// remove an element. its memory is not reclaimed until the storage is reset
+            iterator erase(const_iterator where)
+            {
+                Link *link = where.link;
+                Link *next = link->next;
+                link->prev->next = next;
+                next->prev = link->prev;
+                --count;
+                static_cast<Node *>(link)->~Node();
+                return iterator(next);
+            }
+
+            /// append a range of values. for forward iterators, all the new nodes are made
+            /// with one allocation
+            template <class II, class = typename std::iterator_traits<II>::iterator_category>
+            void append(II first, II last)
+            {
+                append(first, last, typename std::iterator_traits<II>::iterator_category());
+            }
+            void append(size_type num, value_type const &value)
+            {
+                Node *nodes = detail::allocate_nodes<Node>(*store, num);
+                for (size_type n = 0; n < num; ++n)
+                    link_before(&root, new (nodes + n) Node(value));
+            }
+
+            /// move all elements of other to before where, in constant time.
+            /// both lists must use the same storage
+            void splice(const_iterator where, This &other)
+            {
+                if (store != other.store)
+                    throw std::invalid_argument("ilist::splice: lists use different storage");
+                if (other.empty())
+                    return;
+                Link *first = other.root.next;
+                Link *last = other.root.prev;
+                Link *pos = where.link;
+                first->prev = pos->prev;
+                pos->prev->next = first;
+                last->next = pos;
+                pos->prev = last;
+                count += other.count;
+                other.root.next = other.root.prev = &other.root;
+                other.count = 0;
+            }
+
+            /// remove all elements. this is constant time if T is trivially destructible
+            void clear()
+            {
+                destroy(std::is_trivially_destructible<T>());
+                root.next = root.prev = &root;
+                count = 0;
+            }
+
+            iterator begin()
+            {
+                return iterator(root.next);
+            }
+            iterator end()
+            {
+                return iterator(&root);
+            }
+            const_iterator begin() const
+            {
+                return const_iterator(root.next);
+            }
+            const_iterator end() const
+            {
+                return const_iterator(const_cast<Link *>(&root));
+            }
+            value_type const &front() const
+            {
+                return static_cast<Node const *>(root.next)->value;
+            }
+            value_type &front()
+            {
+                return static_cast<Node *>(root.next)->value;
+            }
+            value_type const &back() const
+            {
+                return static_cast<Node const *>(root.prev)->value;
+            }
+            value_type &back()
+            {
+                return static_cast<Node *>(root.prev)->value;
+            }
+
+            void swap(This &other)
+            {
+                This tmp(std::move(other));
+                other = std::move(*this);
+                *this = std::move(tmp);
+            }
+
+        private:
+            void link_before(Link *pos, Link *link)
+            {
+                link->next = pos;
+                link->prev = pos->prev;
+                pos->prev->next = link;
+                pos->prev = link;
+                ++count;
+            }
+
+            template <class II>
+            void append(II first, II last, std::input_iterator_tag)
+            {
+                for (; first != last; ++first)
+                    emplace_back(*first);
+            }
+
+            template <class FI>
+            void append(FI first, FI last, std::forward_iterator_tag)
+            {
+                size_type num = std::distance(first, last);
+                if (num == 0)
+                    return;
+                Node *nodes = detail::allocate_nodes<Node>(*store, num);
+                for (; first != last; ++first)
+                    link_before(&root, new (nodes++) Node(*first));
+            }
+
+            void destroy(std::true_type)
+            {
+            }
+
+            void destroy(std::false_type)
+            {
+                for (Link *link = root.next; link != &root; )
+                {
+                    Node *node = static_cast<Node *>(link);
+                    link = link->next;
+                    node->~Node();
+                }
+            }
+        };
+
+        template <class Ty,class R,class Acc,class Ty2,class R2,class Acc2>
+        bool operator==(ilist<Ty,R,Acc> const &A, ilist<Ty2,R2,Acc2> const &B)
+        {
+            return A.size() == B.size() && std::equal(A.begin(), A.end(), B.begin());
+        }
+        template <class Ty,class R,class Acc,class Ty2,class R2,class Acc2>
+        bool operator!=(ilist<Ty,R,Acc> const &A, ilist<Ty2,R2,Acc2> const &B)
+        {
+            return !(A == B);
+        }
+
+    } // namespace monotonic
+
+} // namespace boost
+
+#include <monotonic/detail/postfix.hpp>
+
+#endif // BOOST_MONOTONIC_CONTAINERS_ILIST_HPP
+
+//EOF
@@ -27,6 +27,7 @@ V5.03:0009 */
 #pragma once
 
 #include <list>
+#include <type_traits>
 //#include <monotonic/interprocess/containers/list.hpp>
 #include <monotonic/detail/prefix.hpp>
 #include <monotonic/detail/container.hpp>
@@ -51,6 +52,7 @@ namespace boost
             typedef typename List::reference reference;
             typedef typename List::const_reference const_reference;
             typedef list<T,Region,Access> This;
+            typedef Allocator allocator_type;
 
         private:
             Implementation impl;
@@ -59,12 +61,32 @@ namespace boost
             list() { }
             list(Allocator A) 
                 : impl(A) { }
+            list(list const &other)
+                : impl(other.impl) { }
+            list(list &&other) noexcept(std::is_nothrow_move_constructible<Implementation>::value)
+                : impl(std::move(other.impl)) { }
+            list(list const &other, Allocator const &A)
+                : impl(other.impl, A) { }
+            /// takes other's nodes if A uses the same storage, otherwise moves its elements into A
+            list(list &&other, Allocator const &A)
+                : impl(std::move(other.impl), A) { }
 
             template <class II>
             list(II F, II L, Allocator A = Allocator())
                 : impl(F,L,A) { }
         
-            Allocator get_allocator()
+            list &operator=(list const &other)
+            {
+                impl = other.impl;
+                return *this;
+            }
+            list &operator=(list &&other)
+            {
+                impl = std::move(other.impl);
+                return *this;
+            }
+
+            Allocator get_allocator() const
             {
                 return impl.get_allocator();
             }
@@ -80,6 +102,10 @@ namespace boost
             {
                 impl.push_back(value);
             }
+            void push_back(value_type &&value)
+            {
+                impl.push_back(std::move(value));
+            }
             void pop_back()
             {
                 impl.pop_back();
@@ -88,6 +114,10 @@ namespace boost
             {
                 impl.push_front(value);
             }
+            void push_front(value_type &&value)
+            {
+                impl.push_front(std::move(value));
+            }
             void pop_front()
             {
                 impl.pop_front();
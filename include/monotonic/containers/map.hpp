@@ -6,6 +6,7 @@
 #pragma once
 
 #include <map>
+#include <type_traits>
 #include <boost/interprocess/containers/map.hpp>
 #include <monotonic/detail/prefix.hpp>
 #include <monotonic/detail/container.hpp>
@@ -35,6 +36,7 @@ namespace boost
             typedef typename Map::value_type value_type;
             typedef typename Map::key_type key_type;
             typedef typename Map::size_type size_type;
+            typedef Allocator allocator_type;
 
         private:
             Implementation impl;
@@ -49,10 +51,30 @@ namespace boost
                 : impl(Pr, A), pred(Pr) { }
             map(const map& other)
                 : impl(other.impl), pred(other.pred) { }
+            map(map &&other) noexcept(std::is_nothrow_move_constructible<Implementation>::value)
+                : impl(std::move(other.impl)), pred(other.pred) { }
+            map(map const &other, Allocator const &A)
+                : impl(other.impl, A), pred(other.pred) { }
+            /// takes other's nodes if A uses the same storage, otherwise moves its elements into A
+            map(map &&other, Allocator const &A)
+                : impl(std::move(other.impl), A), pred(other.pred) { }
             template <class II>
             map(II F, II L, Predicate const &Pr = Predicate(), Allocator A = Allocator())
                 : impl(F,L,Pr,A), pred(Pr) { }
 
+            map &operator=(map const &other)
+            {
+                impl = other.impl;
+                pred = other.pred;
+                return *this;
+            }
+            map &operator=(map &&other)
+            {
+                impl = std::move(other.impl);
+                pred = other.pred;
+                return *this;
+            }
+
             Allocator get_allocator() const
             {
                 return impl.get_allocator();
@@ -90,6 +112,10 @@ namespace boost
             {
                 impl.insert(value);
             }
+            void insert(value_type &&value)
+            {
+                impl.insert(std::move(value));
+            }
             void erase(iterator first)
             {
                 impl.erase(first);
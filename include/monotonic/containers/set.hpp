@@ -30,6 +30,7 @@ namespace boost
             typedef typename Set::size_type size_type;
             typedef detail::Create<detail::is_monotonic<T>::value, T> Create;
             typedef detail::container<set<T,Region,P,Access> > Parent;
+            typedef Allocator allocator_type;
 
         private:
             Set impl;
@@ -38,6 +39,15 @@ namespace boost
             set() { }
             set(Allocator A) 
                 : impl(Predicate(), A) { }    
+            set(set const &other)
+                : impl(other.impl) { }
+            set(set &&other) noexcept
+                : impl(std::move(other.impl)) { }
+            set(set const &other, Allocator const &A)
+                : impl(other.impl, A) { }
+            /// takes other's nodes if A uses the same storage, otherwise moves its elements into A
+            set(set &&other, Allocator const &A)
+                : impl(std::move(other.impl), A) { }
             set(Predicate Pr, Allocator A) 
                 : impl(Pr, A) { }
             template <class II>
@@ -47,6 +57,17 @@ namespace boost
             set(II F, II L, Predicate Pr, Allocator A = Allocator())
                 : impl(F,L,Pr,A) { }
 
+            set &operator=(set const &other)
+            {
+                impl = other.impl;
+                return *this;
+            }
+            set &operator=(set &&other)
+            {
+                impl = std::move(other.impl);
+                return *this;
+            }
+
             Allocator get_allocator() const
             {
                 return impl.get_allocator();
@@ -84,6 +105,10 @@ namespace boost
             {
                 impl.insert(Create::Given(this->Parent::get_storage(), value));
             }
+            void insert(value_type &&value)
+            {
+                impl.insert(Create::Given(this->Parent::get_storage(), std::move(value)));
+            }
             void erase(iterator first)
             {
                 impl.erase(first);
@@ -0,0 +1,404 @@
+// Copyright (C) 2009-2020 Christian@Schladetsch.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MONOTONIC_CONTAINERS_SLIST_HPP
+#define BOOST_MONOTONIC_CONTAINERS_SLIST_HPP
+
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <monotonic/detail/prefix.hpp>
+#include <monotonic/detail/container.hpp>
+#include <monotonic/allocator.hpp>
+
+namespace boost
+{
+    namespace monotonic
+    {
+        namespace detail
+        {
+            struct slist_link
+            {
+                slist_link *next;
+            };
+
+            template <class T>
+            struct slist_node : slist_link
+            {
+                T value;
+
+                template <class... Args>
+                slist_node(Args&&... args) : value(std::forward<Args>(args)...) { }
+            };
+
+            template <class T, class Value>
+            struct slist_iterator
+            {
+                typedef std::forward_iterator_tag iterator_category;
+                typedef T value_type;
+                typedef ptrdiff_t difference_type;
+                typedef Value *pointer;
+                typedef Value &reference;
+
+                slist_link *link;
+
+                slist_iterator(slist_link *L = 0) : link(L) { }
+                /// a const_iterator from an iterator
+                template <class V, detail::enable_const_conversion<V, T, Value> = 0>
+                slist_iterator(slist_iterator<T, V> const &other) : link(other.link) { }
+
+                reference operator*() const
+                {
+                    return static_cast<slist_node<T> *>(link)->value;
+                }
+                pointer operator->() const
+                {
+                    return &**this;
+                }
+                slist_iterator &operator++()
+                {
+                    link = link->next;
+                    return *this;
+                }
+                slist_iterator operator++(int)
+                {
+                    slist_iterator tmp = *this;
+                    link = link->next;
+                    return tmp;
+                }
+                friend bool operator==(slist_iterator const &A, slist_iterator const &B)
+                {
+                    return A.link == B.link;
+                }
+                friend bool operator!=(slist_iterator const &A, slist_iterator const &B)
+                {
+                    return A.link != B.link;
+                }
+            };
+
+            /// make storage for num nodes, in one contiguous block
+            template <class Node>
+            Node *allocate_nodes(storage_base &store, size_t num)
+            {
+                void *ptr = store.allocate(num*sizeof(Node), alignof(Node));
+                if (ptr == 0)
+                    throw std::bad_alloc();
+                return static_cast<Node *>(ptr);
+            }
+
+        } // namespace detail
+
+        /// a singly-linked list whose nodes are made directly in monotonic storage.
+        ///
+        /// each node is just the link and the value, with no allocator padding. ranges
+        /// are appended with one allocation, lists using the same storage can be spliced
+        /// in constant time, and clear() is constant time for trivially destructible T.
+        /// memory for removed elements is not reclaimed until the storage is reset.
+        template <class T, class Region = default_region_tag, class Access = default_access_tag>
+        struct slist : detail::container<slist<T,Region,Access> >
+        {
+            typedef allocator<T,Region,Access> Allocator;
+            typedef Allocator allocator_type;
+            typedef T value_type;
+            typedef T &reference;
+            typedef T const &const_reference;
+            typedef size_t size_type;
+            typedef detail::slist_iterator<T, T> iterator;
+            typedef detail::slist_iterator<T, T const> const_iterator;
+            typedef slist<T,Region,Access> This;
+
+        private:
+            typedef detail::slist_link Link;
+            typedef detail::slist_node<T> Node;
+
+            storage_base *store;
+            Link head;
+            Link *tail;
+            size_type count;
+
+        public:
+            slist()
+                : store(Allocator().get_storage()), tail(&head), count(0)
+            {
+                head.next = 0;
+            }
+            slist(Allocator const &A)
+                : store(A.get_storage()), tail(&head), count(0)
+            {
+                head.next = 0;
+            }
+            slist(slist const &other)
+                : store(other.store), tail(&head), count(0)
+            {
+                head.next = 0;
+                append(other.begin(), other.end());
+            }
+            slist(slist &&other) noexcept
+                : store(other.store), tail(&head), count(0)
+            {
+                head.next = 0;
+                steal(other);
+            }
+            slist(slist const &other, Allocator const &A)
+                : store(A.get_storage()), tail(&head), count(0)
+            {
+                head.next = 0;
+                append(other.begin(), other.end());
+            }
+            /// takes other's nodes if A uses the same storage, otherwise moves its elements into A
+            slist(slist &&other, Allocator const &A)
+                : store(A.get_storage()), tail(&head), count(0)
+            {
+                head.next = 0;
+                if (store == other.store)
+                    steal(other);
+                else
+                    append(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+            }
+
+            template <class II, class = typename std::iterator_traits<II>::iterator_category>
+            slist(II F, II L, Allocator const &A = Allocator())
+                : store(A.get_storage()), tail(&head), count(0)
+            {
+                head.next = 0;
+                append(F, L);
+            }
+
+            ~slist()
+            {
+                clear();
+            }
+
+            slist &operator=(slist const &other)
+            {
+                if (this != &other)
+                {
+                    clear();
+                    append(other.begin(), other.end());
+                }
+                return *this;
+            }
+            slist &operator=(slist &&other)
+            {
+                if (this != &other)
+                {
+                    clear();
+                    if (store == other.store)
+                        steal(other);
+                    else
+                        append(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+                }
+                return *this;
+            }
+
+            Allocator get_allocator() const
+            {
+                return Allocator(*store);
+            }
+            bool empty() const
+            {
+                return count == 0;
+            }
+            size_type size() const
+            {
+                return count;
+            }
+
+            template <class... Args>
+            reference emplace_front(Args&&... args)
+            {
+                Node *node = new (detail::allocate_nodes<Node>(*store, 1)) Node(std::forward<Args>(args)...);
+                node->next = head.next;
+                head.next = node;
+                if (tail == &head)
+                    tail = node;
+                ++count;
+                return node->value;
+            }
+            template <class... Args>
+            reference emplace_back(Args&&... args)
+            {
+                Node *node = new (detail::allocate_nodes<Node>(*store, 1)) Node(std::forward<Args>(args)...);
+                link_back(node);
+                return node->value;
+            }
+            void push_front(value_type const &value)
+            {
+                emplace_front(value);
+            }
+            void push_front(value_type &&value)
+            {
+                emplace_front(std::move(value));
+            }
+            void push_back(value_type const &value)
+            {
+                emplace_back(value);
+            }
+            void push_back(value_type &&value)
+            {
+                emplace_back(std::move(value));
+            }
+            void pop_front()
+            {
+                Node *node = static_cast<Node *>(head.next);
+                head.next = node->next;
+                if (tail == node)
+                    tail = &head;
+                --count;
+                node->~Node();
+            }
+
+            /// append a range of values. for forward iterators, all the new nodes are made
+            /// with one allocation
+            template <class II, class = typename std::iterator_traits<II>::iterator_category>
+            void append(II first, II last)
+            {
+                append(first, last, typename std::iterator_traits<II>::iterator_category());
+            }
+            void append(size_type num, value_type const &value)
+            {
+                Node *nodes = detail::allocate_nodes<Node>(*store, num);
+                for (size_type n = 0; n < num; ++n)
+                    link_back(new (nodes + n) Node(value));
+            }
+
+            /// move all elements of other to the end of this list, in constant time.
+            /// both lists must use the same storage
+            void splice(This &other)
+            {
+                if (store != other.store)
+                    throw std::invalid_argument("slist::splice: lists use different storage");
+                if (other.empty())
+                    return;
+                tail->next = other.head.next;
+                tail = other.tail;
+                count += other.count;
+                other.head.next = 0;
+                other.tail = &other.head;
+                other.count = 0;
+            }
+
+            /// remove all elements. this is constant time if T is trivially destructible
+            void clear()
+            {
+                destroy(std::is_trivially_destructible<T>());
+                head.next = 0;
+                tail = &head;
+                count = 0;
+            }
+
+            iterator begin()
+            {
+                return iterator(head.next);
+            }
+            iterator end()
+            {
+                return iterator();
+            }
+            const_iterator begin() const
+            {
+                return const_iterator(head.next);
+            }
+            const_iterator end() const
+            {
+                return const_iterator();
+            }
+            value_type const &front() const
+            {
+                return static_cast<Node const *>(head.next)->value;
+            }
+            value_type &front()
+            {
+                return static_cast<Node *>(head.next)->value;
+            }
+            value_type const &back() const
+            {
+                return static_cast<Node const *>(tail)->value;
+            }
+            value_type &back()
+            {
+                return static_cast<Node *>(tail)->value;
+            }
+
+            void swap(This &other)
+            {
+                This tmp(std::move(other));
+                other = std::move(*this);
+                *this = std::move(tmp);
+            }
+
+        private:
+            void link_back(Node *node)
+            {
+                node->next = 0;
+                tail->next = node;
+                tail = node;
+                ++count;
+            }
+
+            void steal(This &other)
+            {
+                head.next = other.head.next;
+                tail = other.empty() ? &head : other.tail;
+                count = other.count;
+                other.head.next = 0;
+                other.tail = &other.head;
+                other.count = 0;
+            }
+
+            template <class II>
+            void append(II first, II last, std::input_iterator_tag)
+            {
+                for (; first != last; ++first)
+                    emplace_back(*first);
+            }
+
+            template <class FI>
+            void append(FI first, FI last, std::forward_iterator_tag)
+            {
+                size_type num = std::distance(first, last);
+                if (num == 0)
+                    return;
+                Node *nodes = detail::allocate_nodes<Node>(*store, num);
+                for (; first != last; ++first)
+                    link_back(new (nodes++) Node(*first));
+            }
+
+            void destroy(std::true_type)
+            {
+            }
+
+            void destroy(std::false_type)
+            {
+                for (Link *link = head.next; link != 0; )
+                {
+                    Node *node = static_cast<Node *>(link);
+                    link = link->next;
+                    node->~Node();
+                }
+            }
+        };
+
+        template <class Ty,class R,class Acc,class Ty2,class R2,class Acc2>
+        bool operator==(slist<Ty,R,Acc> const &A, slist<Ty2,R2,Acc2> const &B)
+        {
+            return A.size() == B.size() && std::equal(A.begin(), A.end(), B.begin());
+        }
+        template <class Ty,class R,class Acc,class Ty2,class R2,class Acc2>
+        bool operator!=(slist<Ty,R,Acc> const &A, slist<Ty2,R2,Acc2> const &B)
+        {
+            return !(A == B);
+        }
+
+    } // namespace monotonic
+
+} // namespace boost
+
+#include <monotonic/detail/postfix.hpp>
+
+#endif // BOOST_MONOTONIC_CONTAINERS_SLIST_HPP
+
+//EOF
@@ -0,0 +1,536 @@
+// Copyright (C) 2009-2020 Christian@Schladetsch.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MONOTONIC_CONTAINERS_SMALL_VECTOR_HPP
+#define BOOST_MONOTONIC_CONTAINERS_SMALL_VECTOR_HPP
+
+#include <new>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <monotonic/detail/prefix.hpp>
+#include <monotonic/detail/container.hpp>
+#include <monotonic/detail/construct.hpp>
+#include <monotonic/allocator.hpp>
+
+namespace boost
+{
+    namespace monotonic
+    {
+        /// a vector that holds up to N elements inline, and only uses its monotonic
+        /// storage once it has more than that.
+        ///
+        /// a spilled buffer that is the last allocation made from the storage is grown
+        /// in place, so a vector that is filled without other allocations in between is
+        /// not copied as it grows. otherwise the buffer is doubled, and the old one is
+        /// left in the storage until it is reset.
+        template <class T
+            , size_t N
+            , class Region = default_region_tag
+            , class Access = default_access_tag>
+        struct small_vector : detail::container<small_vector<T,N,Region,Access> >
+        {
+            static_assert(N > 0, "small_vector must have room for at least one inline element");
+
+            typedef allocator<T,Region,Access> Allocator;
+            typedef Allocator allocator_type;
+            typedef detail::Create<detail::is_monotonic<T>::value, T> Create;
+            typedef T value_type;
+            typedef T &reference;
+            typedef T const &const_reference;
+            typedef T *pointer;
+            typedef T const *const_pointer;
+            typedef T *iterator;
+            typedef T const *const_iterator;
+            typedef std::reverse_iterator<iterator> reverse_iterator;
+            typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+            typedef size_t size_type;
+            typedef ptrdiff_t difference_type;
+            typedef small_vector<T,N,Region,Access> This;
+
+            static constexpr size_type inline_capacity = N;
+
+        private:
+            storage_base *store;
+            T *first;                ///< the inline buffer, or a buffer in the storage
+            size_type count;
+            size_type cap;
+            alignas(T) unsigned char bytes[N*sizeof(T)];
+
+        public:
+            small_vector()
+                : store(Allocator().get_storage()), first(inline_data()), count(0), cap(N) { }
+            small_vector(Allocator const &A)
+                : store(A.get_storage()), first(inline_data()), count(0), cap(N) { }
+            small_vector(small_vector const &other)
+                : store(other.store), first(inline_data()), count(0), cap(N)
+            {
+                append(other.begin(), other.end());
+            }
+            small_vector(small_vector &&other) noexcept(std::is_nothrow_move_constructible<T>::value)
+                : store(other.store), first(inline_data()), count(0), cap(N)
+            {
+                take(other);
+            }
+            small_vector(small_vector const &other, Allocator const &A)
+                : store(A.get_storage()), first(inline_data()), count(0), cap(N)
+            {
+                append(other.begin(), other.end());
+            }
+            /// takes other's buffer if it has spilled to the same storage as A, otherwise
+            /// moves its elements into A
+            small_vector(small_vector &&other, Allocator const &A)
+                : store(A.get_storage()), first(inline_data()), count(0), cap(N)
+            {
+                if (store == other.store)
+                    take(other);
+                else
+                    append(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+            }
+            small_vector(size_type num, T const &X, Allocator const &A = Allocator())
+                : store(A.get_storage()), first(inline_data()), count(0), cap(N)
+            {
+                resize(num, X);
+            }
+            template <class II, class = typename std::iterator_traits<II>::iterator_category>
+            small_vector(II F, II L, Allocator const &A = Allocator())
+                : store(A.get_storage()), first(inline_data()), count(0), cap(N)
+            {
+                append(F, L);
+            }
+
+            ~small_vector()
+            {
+                Destroy(first, count);
+            }
+
+            small_vector &operator=(small_vector const &other)
+            {
+                if (this != &other)
+                {
+                    clear();
+                    append(other.begin(), other.end());
+                }
+                return *this;
+            }
+            small_vector &operator=(small_vector &&other)
+            {
+                if (this == &other)
+                    return *this;
+                clear();
+                if (store == other.store && !other.is_inline())
+                {
+                    abandon();
+                    take(other);
+                }
+                else
+                {
+                    append(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+                }
+                return *this;
+            }
+
+            Allocator get_allocator() const
+            {
+                return Allocator(*store);
+            }
+            bool empty() const
+            {
+                return count == 0;
+            }
+            size_type size() const
+            {
+                return count;
+            }
+            size_type capacity() const
+            {
+                return cap;
+            }
+            /// true if the elements are in the inline buffer rather than in the storage
+            bool is_inline() const
+            {
+                return first == inline_data();
+            }
+
+            void reserve(size_type num)
+            {
+                if (num > cap)
+                    Grow(num);
+            }
+            void resize(size_type num)
+            {
+                if (num <= count)
+                {
+                    truncate(num);
+                    return;
+                }
+                reserve(num);
+                for (; count < num; ++count)
+                    get_allocator().construct(first + count);
+            }
+            void resize(size_type num, value_type const &X)
+            {
+                if (num <= count)
+                {
+                    truncate(num);
+                    return;
+                }
+                reserve(num);
+                for (; count < num; ++count)
+                    get_allocator().construct(first + count, X);
+            }
+
+            reference at(size_type index)
+            {
+                if (index >= count)
+                    throw std::out_of_range("small_vector");
+                return first[index];
+            }
+            const_reference at(size_type index) const
+            {
+                return const_cast<This &>(*this).at(index);
+            }
+            reference operator[](size_type index)
+            {
+                return first[index];
+            }
+            const_reference operator[](size_type index) const
+            {
+                return first[index];
+            }
+
+            void push_back(value_type const &value)
+            {
+                Append([&](T *ptr) { get_allocator().construct(ptr, value); });
+            }
+            void push_back(value_type &&value)
+            {
+                Append([&](T *ptr) { get_allocator().construct(ptr, std::move(value)); });
+            }
+            template <class... Args>
+            reference emplace_back(Args&&... args)
+            {
+                return Append([&](T *ptr) { new (ptr) T(std::forward<Args>(args)...); });
+            }
+            void pop_back()
+            {
+                first[--count].~T();
+            }
+
+            /// make a new element before where
+            template <class... Args>
+            iterator emplace(const_iterator where, Args&&... args)
+            {
+                size_type index = where - begin();
+                if (index == count)
+                {
+                    emplace_back(std::forward<Args>(args)...);
+                    return begin() + index;
+                }
+                return Insert(index, T(std::forward<Args>(args)...));
+            }
+            iterator insert(const_iterator where, value_type const &value)
+            {
+                size_type index = where - begin();
+                if (index == count)
+                {
+                    push_back(value);
+                    return begin() + index;
+                }
+                return Insert(index, Create::Given(*store, value));
+            }
+            iterator insert(const_iterator where, value_type &&value)
+            {
+                size_type index = where - begin();
+                if (index == count)
+                {
+                    push_back(std::move(value));
+                    return begin() + index;
+                }
+                return Insert(index, Create::Given(*store, std::move(value)));
+            }
+
+            iterator erase(const_iterator where)
+            {
+                return erase(where, where + 1);
+            }
+            iterator erase(const_iterator F, const_iterator L)
+            {
+                iterator dest = begin() + (F - begin());
+                if (F != L)
+                    truncate(std::move(dest + (L - F), end(), dest) - begin());
+                return dest;
+            }
+
+            /// append a range of values, growing the buffer at most once for forward iterators
+            template <class II, class = typename std::iterator_traits<II>::iterator_category>
+            void append(II F, II L)
+            {
+                Reserve(F, L, typename std::iterator_traits<II>::iterator_category());
+                for (; F != L; ++F)
+                    push_back(*F);
+            }
+
+            /// destroy all elements, keeping the buffer
+            void clear()
+            {
+                truncate(0);
+            }
+
+            pointer data()
+            {
+                return first;
+            }
+            const_pointer data() const
+            {
+                return first;
+            }
+            iterator begin()
+            {
+                return first;
+            }
+            iterator end()
+            {
+                return first + count;
+            }
+            const_iterator begin() const
+            {
+                return first;
+            }
+            const_iterator end() const
+            {
+                return first + count;
+            }
+            reverse_iterator rbegin()
+            {
+                return reverse_iterator(end());
+            }
+            reverse_iterator rend()
+            {
+                return reverse_iterator(begin());
+            }
+            const_reverse_iterator rbegin() const
+            {
+                return const_reverse_iterator(end());
+            }
+            const_reverse_iterator rend() const
+            {
+                return const_reverse_iterator(begin());
+            }
+            value_type const &front() const
+            {
+                return first[0];
+            }
+            value_type &front()
+            {
+                return first[0];
+            }
+            value_type const &back() const
+            {
+                return first[count - 1];
+            }
+            value_type &back()
+            {
+                return first[count - 1];
+            }
+
+            void swap(This &other)
+            {
+                This tmp(std::move(other));
+                other = std::move(*this);
+                *this = std::move(tmp);
+            }
+
+        private:
+            T *inline_data()
+            {
+                return reinterpret_cast<T *>(bytes);
+            }
+            T const *inline_data() const
+            {
+                return reinterpret_cast<T const *>(bytes);
+            }
+
+            /// take other's spilled buffer, or move its inline elements into ours
+            void take(This &other)
+            {
+                if (other.is_inline())
+                {
+                    Relocate(other.first, other.count, first);
+                    count = other.count;
+                    other.count = 0;
+                    return;
+                }
+                first = other.first;
+                count = other.count;
+                cap = other.cap;
+                other.first = other.inline_data();
+                other.count = 0;
+                other.cap = N;
+            }
+
+            /// return a spilled buffer to the storage, and use the inline buffer again
+            void abandon()
+            {
+                if (!is_inline())
+                    store->deallocate(first);
+                first = inline_data();
+                cap = N;
+            }
+
+            void truncate(size_type num)
+            {
+                Destroy(first + num, count - num);
+                count = num;
+            }
+
+            /// try to grow the spilled buffer in place to num elements
+            bool extend(size_type num)
+            {
+                if (is_inline() || !store->extend(first, cap*sizeof(T), num*sizeof(T)))
+                    return false;
+                cap = num;
+                return true;
+            }
+
+            T *allocate(size_type num)
+            {
+                void *ptr = store->allocate(num*sizeof(T), alignof(T));
+                if (ptr == 0)
+                    throw std::bad_alloc();
+                return static_cast<T *>(ptr);
+            }
+
+            /// make room for num elements, in place if possible
+            void Grow(size_type num)
+            {
+                if (extend(num))
+                    return;
+                T *ptr = allocate(num);
+                Relocate(first, count, ptr);
+                abandon();
+                first = ptr;
+                cap = num;
+            }
+
+            /// make a new last element with make. when the buffer must be moved, the new
+            /// element is made first, so make may refer to an existing element
+            template <class Make>
+            reference Append(Make make)
+            {
+                if (count < cap || extend(2*cap))
+                {
+                    make(first + count);
+                    return first[count++];
+                }
+                size_type num = 2*cap;
+                T *ptr = allocate(num);
+                make(ptr + count);
+                try
+                {
+                    Relocate(first, count, ptr);
+                }
+                catch (...)
+                {
+                    ptr[count].~T();
+                    throw;
+                }
+                abandon();
+                first = ptr;
+                cap = num;
+                return first[count++];
+            }
+
+            iterator Insert(size_type index, T &&value)
+            {
+                if (count == cap)
+                    Grow(2*cap);
+                new (first + count) T(std::move(first[count - 1]));
+                ++count;
+                std::move_backward(first + index, first + count - 2, first + count - 1);
+                first[index] = std::move(value);
+                return begin() + index;
+            }
+
+            template <class II>
+            void Reserve(II, II, std::input_iterator_tag)
+            {
+            }
+            template <class FI>
+            void Reserve(FI F, FI L, std::forward_iterator_tag)
+            {
+                reserve(count + std::distance(F, L));
+            }
+
+            /// move-construct num items to dest, destroying the originals. if a move
+            /// throws, the originals are kept and the copies destroyed
+            static void Relocate(T *src, size_type num, T *dest)
+            {
+                size_type n = 0;
+                try
+                {
+                    for (; n < num; ++n)
+                        new (dest + n) T(std::move_if_noexcept(src[n]));
+                }
+                catch (...)
+                {
+                    Destroy(dest, n);
+                    throw;
+                }
+                Destroy(src, num);
+            }
+
+            static void Destroy(T *items, size_type num)
+            {
+                if (!std::is_trivially_destructible<T>::value)
+                {
+                    for (size_type n = 0; n < num; ++n)
+                        items[n].~T();
+                }
+            }
+        };
+
+        template <class Ty,size_t N,class R,class Acc,class Ty2,size_t N2,class R2,class Acc2>
+        bool operator==(small_vector<Ty,N,R,Acc> const &A, small_vector<Ty2,N2,R2,Acc2> const &B)
+        {
+            return A.size() == B.size() && std::equal(A.begin(), A.end(), B.begin());
+        }
+        template <class Ty,size_t N,class R,class Acc,class Ty2,size_t N2,class R2,class Acc2>
+        bool operator!=(small_vector<Ty,N,R,Acc> const &A, small_vector<Ty2,N2,R2,Acc2> const &B)
+        {
+            return !(A == B);
+        }
+        template <class Ty,size_t N,class R,class Acc,class Ty2,size_t N2,class R2,class Acc2>
+        bool operator<(small_vector<Ty,N,R,Acc> const &A, small_vector<Ty2,N2,R2,Acc2> const &B)
+        {
+            return std::lexicographical_compare(A.begin(), A.end(), B.begin(), B.end());
+        }
+        template <class Ty,size_t N,class R,class Acc,class Ty2,size_t N2,class R2,class Acc2>
+        bool operator>(small_vector<Ty,N,R,Acc> const &A, small_vector<Ty2,N2,R2,Acc2> const &B)
+        {
+            return B < A;
+        }
+        template <class Ty,size_t N,class R,class Acc,class Ty2,size_t N2,class R2,class Acc2>
+        bool operator<=(small_vector<Ty,N,R,Acc> const &A, small_vector<Ty2,N2,R2,Acc2> const &B)
+        {
+            return !(B < A);
+        }
+        template <class Ty,size_t N,class R,class Acc,class Ty2,size_t N2,class R2,class Acc2>
+        bool operator>=(small_vector<Ty,N,R,Acc> const &A, small_vector<Ty2,N2,R2,Acc2> const &B)
+        {
+            return !(A < B);
+        }
+
+    } // namespace monotonic
+
+} // namespace boost
+
+#include <monotonic/detail/postfix.hpp>
+
+#endif // BOOST_MONOTONIC_CONTAINERS_SMALL_VECTOR_HPP
+
+//EOF
@@ -26,6 +26,7 @@ namespace boost
             typedef typename Impl::iterator iterator;
             typedef typename Impl::const_iterator const_iterator;
             typedef typename Impl::value_type value_type;
+            typedef Allocator allocator_type;
 
         private:
             Impl impl;
@@ -34,6 +35,23 @@ namespace boost
             string()
             {
             }
+            string(string const &other)
+                : impl(other.impl)
+            {
+            }
+            string(string &&other) noexcept
+                : impl(std::move(other.impl))
+            {
+            }
+            string(string const &other, Allocator const &alloc)
+                : impl(other.impl, alloc)
+            {
+            }
+            /// takes other's buffer if alloc uses the same storage, otherwise copies it into alloc
+            string(string &&other, Allocator const &alloc)
+                : impl(std::move(other.impl), alloc)
+            {
+            }
             template <class Reg2, class Acc2>
             string(string<Reg2,Acc2> const &other)
                 : impl(other.impl)
@@ -78,6 +96,11 @@ namespace boost
                 impl = other.get_impl();
                 return *this;
             }
+            string &operator=(string &&other)
+            {
+                impl = std::move(other.impl);
+                return *this;
+            }
 
             Allocator get_allocator() const
             {
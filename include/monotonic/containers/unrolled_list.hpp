@@ -0,0 +1,653 @@
+// Copyright (C) 2009-2020 Christian@Schladetsch.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MONOTONIC_CONTAINERS_UNROLLED_LIST_HPP
+#define BOOST_MONOTONIC_CONTAINERS_UNROLLED_LIST_HPP
+
+#include <memory>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <monotonic/detail/prefix.hpp>
+#include <monotonic/containers/slist.hpp>
+
+namespace boost
+{
+    namespace monotonic
+    {
+        namespace detail
+        {
+            /// the number of T that fit in a node of two cache lines, but at least 4
+            template <class T>
+            struct unrolled_capacity
+            {
+                static constexpr size_t bytes = 2*DefaultSizes::CacheLineSize - 2*sizeof(void *) - sizeof(size_t);
+                static constexpr size_t value = 4*sizeof(T) > bytes ? 4 : bytes/sizeof(T);
+            };
+
+            struct unrolled_link
+            {
+                unrolled_link *next, *prev;
+            };
+
+            /// a node of an unrolled list. nodes are aligned to, and sized in multiples
+            /// of, a cache line
+            template <class T, size_t Capacity>
+            struct alignas(DefaultSizes::CacheLineSize) unrolled_node : unrolled_link
+            {
+                size_t size;
+                alignas(T) unsigned char bytes[Capacity*sizeof(T)];
+
+                T *items()
+                {
+                    return reinterpret_cast<T *>(bytes);
+                }
+                T const *items() const
+                {
+                    return reinterpret_cast<T const *>(bytes);
+                }
+            };
+
+            template <class T, size_t Capacity, class Value>
+            struct unrolled_iterator
+            {
+                typedef std::bidirectional_iterator_tag iterator_category;
+                typedef T value_type;
+                typedef ptrdiff_t difference_type;
+                typedef Value *pointer;
+                typedef Value &reference;
+                typedef unrolled_node<T, Capacity> Node;
+
+                unrolled_link *link;
+                size_t index;
+
+                unrolled_iterator(unrolled_link *L = 0, size_t N = 0) : link(L), index(N) { }
+                /// a const_iterator from an iterator
+                template <class V, detail::enable_const_conversion<V, T, Value> = 0>
+                unrolled_iterator(unrolled_iterator<T, Capacity, V> const &other) : link(other.link), index(other.index) { }
+
+                reference operator*() const
+                {
+                    return static_cast<Node *>(link)->items()[index];
+                }
+                pointer operator->() const
+                {
+                    return &**this;
+                }
+                unrolled_iterator &operator++()
+                {
+                    if (++index == static_cast<Node *>(link)->size)
+                    {
+                        link = link->next;
+                        index = 0;
+                    }
+                    return *this;
+                }
+                unrolled_iterator operator++(int)
+                {
+                    unrolled_iterator tmp = *this;
+                    ++*this;
+                    return tmp;
+                }
+                unrolled_iterator &operator--()
+                {
+                    if (index == 0)
+                    {
+                        link = link->prev;
+                        index = static_cast<Node *>(link)->size;
+                    }
+                    --index;
+                    return *this;
+                }
+                unrolled_iterator operator--(int)
+                {
+                    unrolled_iterator tmp = *this;
+                    --*this;
+                    return tmp;
+                }
+                friend bool operator==(unrolled_iterator const &A, unrolled_iterator const &B)
+                {
+                    return A.link == B.link && A.index == B.index;
+                }
+                friend bool operator!=(unrolled_iterator const &A, unrolled_iterator const &B)
+                {
+                    return !(A == B);
+                }
+            };
+
+        } // namespace detail
+
+        /// a doubly-linked list of nodes, where each node holds up to NodeCapacity
+        /// elements in an array.
+        ///
+        /// inserting into a full node splits it in two, and erasing compacts the node so
+        /// that its free slots are used by later inserts. nodes that become empty are
+        /// kept for re-use rather than being abandoned in the storage. there are far
+        /// fewer links than elements, so iteration is mostly a linear scan.
+        template <class T
+            , size_t NodeCapacity = detail::unrolled_capacity<T>::value
+            , class Region = default_region_tag
+            , class Access = default_access_tag>
+        struct unrolled_list : detail::container<unrolled_list<T,NodeCapacity,Region,Access> >
+        {
+            static_assert(NodeCapacity >= 2, "unrolled_list nodes must hold at least two elements");
+
+            typedef allocator<T,Region,Access> Allocator;
+            typedef Allocator allocator_type;
+            typedef T value_type;
+            typedef T &reference;
+            typedef T const &const_reference;
+            typedef size_t size_type;
+            typedef detail::unrolled_iterator<T, NodeCapacity, T> iterator;
+            typedef detail::unrolled_iterator<T, NodeCapacity, T const> const_iterator;
+            typedef unrolled_list<T,NodeCapacity,Region,Access> This;
+
+        private:
+            typedef detail::unrolled_link Link;
+            typedef detail::unrolled_node<T, NodeCapacity> Node;
+
+            storage_base *store;
+            Link root;            ///< root.next is the first node and root.prev the last
+            Link *spare;        ///< empty nodes available for re-use, linked by next
+            size_type count;
+
+        public:
+            unrolled_list()
+                : store(Allocator().get_storage()), spare(0), count(0)
+            {
+                root.next = root.prev = &root;
+            }
+            unrolled_list(Allocator const &A)
+                : store(A.get_storage()), spare(0), count(0)
+            {
+                root.next = root.prev = &root;
+            }
+            unrolled_list(unrolled_list const &other)
+                : store(other.store), spare(0), count(0)
+            {
+                root.next = root.prev = &root;
+                append(other.begin(), other.end());
+            }
+            unrolled_list(unrolled_list &&other) noexcept
+                : store(other.store), spare(0), count(0)
+            {
+                root.next = root.prev = &root;
+                steal(other);
+            }
+            unrolled_list(unrolled_list const &other, Allocator const &A)
+                : store(A.get_storage()), spare(0), count(0)
+            {
+                root.next = root.prev = &root;
+                append(other.begin(), other.end());
+            }
+            /// takes other's nodes if A uses the same storage, otherwise moves its elements into A
+            unrolled_list(unrolled_list &&other, Allocator const &A)
+                : store(A.get_storage()), spare(0), count(0)
+            {
+                root.next = root.prev = &root;
+                if (store == other.store)
+                    steal(other);
+                else
+                    append(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+            }
+
+            template <class II, class = typename std::iterator_traits<II>::iterator_category>
+            unrolled_list(II F, II L, Allocator const &A = Allocator())
+                : store(A.get_storage()), spare(0), count(0)
+            {
+                root.next = root.prev = &root;
+                append(F, L);
+            }
+
+            ~unrolled_list()
+            {
+                clear();
+            }
+
+            unrolled_list &operator=(unrolled_list const &other)
+            {
+                if (this != &other)
+                {
+                    clear();
+                    append(other.begin(), other.end());
+                }
+                return *this;
+            }
+            unrolled_list &operator=(unrolled_list &&other)
+            {
+                if (this != &other)
+                {
+                    clear();
+                    if (store == other.store)
+                        steal(other);
+                    else
+                        append(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+                }
+                return *this;
+            }
+
+            Allocator get_allocator() const
+            {
+                return Allocator(*store);
+            }
+            bool empty() const
+            {
+                return count == 0;
+            }
+            size_type size() const
+            {
+                return count;
+            }
+
+            /// make a new element before where
+            template <class... Args>
+            iterator emplace(const_iterator where, Args&&... args)
+            {
+                Link *link = where.link;
+                size_t index = where.index;
+                if (link == &root)
+                {
+                    // at the end: use the space at the end of the last node, if any
+                    link = root.prev;
+                    if (link == &root || static_cast<Node *>(link)->size == NodeCapacity)
+                        link = link_node_before(&root);
+                    index = static_cast<Node *>(link)->size;
+                }
+                else if (static_cast<Node *>(link)->size == NodeCapacity)
+                {
+                    Node *node = static_cast<Node *>(link);
+                    Node *half = static_cast<Node *>(Split(node));
+                    if (index > node->size)
+                    {
+                        index -= node->size;
+                        link = half;
+                    }
+                }
+                Node *node = static_cast<Node *>(link);
+                T *items = node->items();
+                OpenGap(items, node->size, index);
+                try
+                {
+                    new (items + index) T(std::forward<Args>(args)...);
+                }
+                catch (...)
+                {
+                    CloseGap(items, node->size + 1, index);
+                    throw;
+                }
+                ++node->size;
+                ++count;
+                return iterator(link, index);
+            }
+            iterator insert(const_iterator where, value_type const &value)
+            {
+                return emplace(where, value);
+            }
+            iterator insert(const_iterator where, value_type &&value)
+            {
+                return emplace(where, std::move(value));
+            }
+            template <class... Args>
+            reference emplace_back(Args&&... args)
+            {
+                return *emplace(end(), std::forward<Args>(args)...);
+            }
+            template <class... Args>
+            reference emplace_front(Args&&... args)
+            {
+                return *emplace(begin(), std::forward<Args>(args)...);
+            }
+            void push_back(value_type const &value)
+            {
+                emplace(end(), value);
+            }
+            void push_back(value_type &&value)
+            {
+                emplace(end(), std::move(value));
+            }
+            void push_front(value_type const &value)
+            {
+                emplace(begin(), value);
+            }
+            void push_front(value_type &&value)
+            {
+                emplace(begin(), std::move(value));
+            }
+            void pop_front()
+            {
+                erase(begin());
+            }
+            void pop_back()
+            {
+                erase(--end());
+            }
+
+            /// remove an element, compacting its node. a node that becomes empty is kept
+            /// for re-use, and a node that becomes less than half full is merged with
+            /// the next node if they fit in one
+            iterator erase(const_iterator where)
+            {
+                Node *node = static_cast<Node *>(where.link);
+                size_t index = where.index;
+                T *items = node->items();
+                items[index].~T();
+                CloseGap(items, node->size, index);
+                --node->size;
+                --count;
+                if (node->size == 0)
+                {
+                    Link *next = node->next;
+                    release_node(node);
+                    return iterator(next, 0);
+                }
+                Link *next = node->next;
+                if (next != &root && 2*node->size < NodeCapacity && node->size + static_cast<Node *>(next)->size <= NodeCapacity)
+                {
+                    Node *other = static_cast<Node *>(next);
+                    MoveItems(other->items(), other->size, items + node->size);
+                    node->size += other->size;
+                    other->size = 0;
+                    release_node(other);
+                }
+                if (index == node->size)
+                    return iterator(node->next, 0);
+                return iterator(node, index);
+            }
+
+            /// append a range of values, filling each node in turn
+            template <class II, class = typename std::iterator_traits<II>::iterator_category>
+            void append(II first, II last)
+            {
+                for (; first != last; ++first)
+                    emplace(end(), *first);
+            }
+
+            /// stable sort of the elements, without a side buffer. each node is sorted in
+            /// place by insertion, then runs of nodes are merged pairwise as in
+            /// std::list::sort. a merge moves the elements into nodes taken from the spare
+            /// list, and returns each node to it once emptied, so at most a few nodes are
+            /// ever taken from the storage
+            template <class Pred>
+            void sort(Pred pred)
+            {
+                if (count < 2)
+                    return;
+                Run bins[64];
+                size_t filled = 0;
+                Link *link = root.next;
+                root.next = root.prev = &root;
+                while (link != &root)
+                {
+                    Node *node = static_cast<Node *>(link);
+                    link = link->next;
+                    InsertionSort(node->items(), node->size, pred);
+                    node->next = 0;
+                    Run run = { node, node };
+                    size_t bin = 0;
+                    for (; bin < filled && bins[bin].head; ++bin)
+                    {
+                        run = MergeRuns(bins[bin], run, pred);
+                        bins[bin].head = 0;
+                    }
+                    bins[bin] = run;
+                    if (bin == filled)
+                        ++filled;
+                }
+                Run run = { 0, 0 };
+                for (size_t bin = 0; bin < filled; ++bin)
+                {
+                    if (bins[bin].head)
+                        run = run.head ? MergeRuns(bins[bin], run, pred) : bins[bin];
+                }
+                Link *prev = &root;
+                for (Link *node = run.head; node; node = node->next)
+                {
+                    node->prev = prev;
+                    prev->next = node;
+                    prev = node;
+                }
+                prev->next = &root;
+                root.prev = prev;
+            }
+
+            void sort()
+            {
+                sort(std::less<T>());
+            }
+
+            /// remove all elements. all nodes are kept for re-use
+            void clear()
+            {
+                while (root.next != &root)
+                {
+                    Node *node = static_cast<Node *>(root.next);
+                    DestroyItems(node->items(), node->size, std::is_trivially_destructible<T>());
+                    node->size = 0;
+                    release_node(node);
+                }
+                count = 0;
+            }
+
+            iterator begin()
+            {
+                return iterator(root.next, 0);
+            }
+            iterator end()
+            {
+                return iterator(&root, 0);
+            }
+            const_iterator begin() const
+            {
+                return const_iterator(root.next, 0);
+            }
+            const_iterator end() const
+            {
+                return const_iterator(const_cast<Link *>(&root), 0);
+            }
+            value_type const &front() const
+            {
+                return *begin();
+            }
+            value_type &front()
+            {
+                return *begin();
+            }
+            value_type const &back() const
+            {
+                return *--end();
+            }
+            value_type &back()
+            {
+                return *--end();
+            }
+
+            void swap(This &other)
+            {
+                This tmp(std::move(other));
+                other = std::move(*this);
+                *this = std::move(tmp);
+            }
+
+        private:
+            /// a chain of nodes linked by next and ending in null, sorted in order
+            struct Run
+            {
+                Link *head, *tail;
+            };
+
+            /// move the elements of two sorted runs into one, preferring first on ties.
+            /// the nodes of the merged run are full but for the last
+            template <class Pred>
+            Run MergeRuns(Run first, Run second, Pred &pred)
+            {
+                Run run = { 0, 0 };
+                Node *dest = 0;
+                Node *left = static_cast<Node *>(first.head), *right = static_cast<Node *>(second.head);
+                size_t at_left = 0, at_right = 0;
+                while (left || right)
+                {
+                    bool from_right = !left || (right && pred(right->items()[at_right], left->items()[at_left]));
+                    Node *&src = from_right ? right : left;
+                    size_t &at = from_right ? at_right : at_left;
+                    if (!dest || dest->size == NodeCapacity)
+                    {
+                        dest = TakeNode();
+                        dest->next = 0;
+                        if (run.tail)
+                            run.tail->next = dest;
+                        else
+                            run.head = dest;
+                        run.tail = dest;
+                    }
+                    T &value = src->items()[at];
+                    new (dest->items() + dest->size) T(std::move(value));
+                    value.~T();
+                    ++dest->size;
+                    if (++at == src->size)
+                    {
+                        Node *done = src;
+                        src = static_cast<Node *>(done->next);
+                        at = 0;
+                        done->size = 0;
+                        done->next = spare;
+                        spare = done;
+                    }
+                }
+                return run;
+            }
+
+            /// stable sort of the items of one node
+            template <class Pred>
+            static void InsertionSort(T *items, size_t size, Pred &pred)
+            {
+                for (size_t n = 1; n < size; ++n)
+                    std::rotate(std::upper_bound(items, items + n, items[n], pred), items + n, items + n + 1);
+            }
+
+            /// take a node from the free list, or make a new one
+            Node *TakeNode()
+            {
+                Node *node;
+                if (spare)
+                {
+                    node = static_cast<Node *>(spare);
+                    spare = spare->next;
+                }
+                else
+                {
+                    node = detail::allocate_nodes<Node>(*store, 1);
+                }
+                node->size = 0;
+                return node;
+            }
+
+            void steal(This &other)
+            {
+                if (other.root.next != &other.root)
+                {
+                    root.next = other.root.next;
+                    root.prev = other.root.prev;
+                    root.next->prev = &root;
+                    root.prev->next = &root;
+                }
+                count = other.count;
+                other.root.next = other.root.prev = &other.root;
+                other.count = 0;
+            }
+
+            /// take a node from the free list, or make a new one, and link it before pos
+            Link *link_node_before(Link *pos)
+            {
+                Node *node = TakeNode();
+                node->next = pos;
+                node->prev = pos->prev;
+                pos->prev->next = node;
+                pos->prev = node;
+                return node;
+            }
+
+            /// unlink an empty node, and keep it for re-use
+            void release_node(Node *node)
+            {
+                node->prev->next = node->next;
+                node->next->prev = node->prev;
+                node->next = spare;
+                spare = node;
+            }
+
+            /// move the upper half of a full node to a new node after it
+            Link *Split(Node *node)
+            {
+                Node *half = static_cast<Node *>(link_node_before(node->next));
+                size_t keep = node->size/2;
+                MoveItems(node->items() + keep, node->size - keep, half->items());
+                half->size = node->size - keep;
+                node->size = keep;
+                return half;
+            }
+
+            /// move-construct num items to dest, destroying the originals
+            static void MoveItems(T *src, size_t num, T *dest)
+            {
+                for (size_t n = 0; n < num; ++n)
+                {
+                    new (dest + n) T(std::move(src[n]));
+                    src[n].~T();
+                }
+            }
+
+            /// make an uninitialised slot at index, shifting the items above it up by one
+            static void OpenGap(T *items, size_t size, size_t index)
+            {
+                for (size_t n = size; n > index; --n)
+                {
+                    new (items + n) T(std::move(items[n - 1]));
+                    items[n - 1].~T();
+                }
+            }
+
+            /// fill the uninitialised slot at index, shifting the items above it down by one
+            static void CloseGap(T *items, size_t size, size_t index)
+            {
+                for (size_t n = index + 1; n < size; ++n)
+                {
+                    new (items + n - 1) T(std::move(items[n]));
+                    items[n].~T();
+                }
+            }
+
+            static void DestroyItems(T *, size_t, std::true_type)
+            {
+            }
+
+            static void DestroyItems(T *items, size_t size, std::false_type)
+            {
+                for (size_t n = 0; n < size; ++n)
+                    items[n].~T();
+            }
+        };
+
+        template <class Ty,size_t N,class R,class Acc,class Ty2,size_t N2,class R2,class Acc2>
+        bool operator==(unrolled_list<Ty,N,R,Acc> const &A, unrolled_list<Ty2,N2,R2,Acc2> const &B)
+        {
+            return A.size() == B.size() && std::equal(A.begin(), A.end(), B.begin());
+        }
+        template <class Ty,size_t N,class R,class Acc,class Ty2,size_t N2,class R2,class Acc2>
+        bool operator!=(unrolled_list<Ty,N,R,Acc> const &A, unrolled_list<Ty2,N2,R2,Acc2> const &B)
+        {
+            return !(A == B);
+        }
+
+    } // namespace monotonic
+
+} // namespace boost
+
+#include <monotonic/detail/postfix.hpp>
+
+#endif // BOOST_MONOTONIC_CONTAINERS_UNROLLED_LIST_HPP
+
+//EOF
@@ -24,6 +24,7 @@ namespace boost
             typedef detail::Create<detail::is_monotonic<T>::value, T> Create;
             //typedef interprocess::vector<T,Allocator> Impl;
             typedef std::vector<T,Allocator> Impl;
+            typedef Allocator allocator_type;
 
             typedef typename Impl::iterator iterator;
             typedef typename Impl::const_iterator const_iterator;
@@ -39,17 +40,32 @@ namespace boost
             vector() { }
             vector(Allocator const &A) 
                 : impl(A) { }
-            vector(vector const &other, Allocator A)
-                : impl(A)
-            {
-                impl = other.impl;
-            }
+            vector(vector const &other)
+                : impl(other.impl) { }
+            vector(vector &&other) noexcept
+                : impl(std::move(other.impl)) { }
+            vector(vector const &other, Allocator const &A)
+                : impl(other.impl, A) { }
+            /// takes other's buffer if A uses the same storage, otherwise moves its elements into A
+            vector(vector &&other, Allocator const &A)
+                : impl(std::move(other.impl), A) { }
             vector(size_t N, T const &X, Allocator A = Allocator())
                 : impl(N,X,A) { }
             template <class II>
             vector(II F, II L, Allocator A = Allocator())
                 : impl(F,L,A) { }
 
+            vector &operator=(vector const &other)
+            {
+                impl = other.impl;
+                return *this;
+            }
+            vector &operator=(vector &&other)
+            {
+                impl = std::move(other.impl);
+                return *this;
+            }
+
             Allocator get_allocator() const
             {
                 return impl.get_allocator();
@@ -102,6 +118,15 @@ namespace boost
             {
                 impl.push_back(value);
             }
+            void push_back(value_type &&value)
+            {
+                impl.push_back(std::move(value));
+            }
+            template <class... Args>
+            reference emplace_back(Args&&... args)
+            {
+                return impl.emplace_back(std::forward<Args>(args)...);
+            }
             void pop_back()
             {
                 impl.pop_back();
@@ -0,0 +1,962 @@
+// Copyright (C) 2009-2020 Christian@Schladetsch.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MONOTONIC_DETAIL_BTREE_HPP
+#define BOOST_MONOTONIC_DETAIL_BTREE_HPP
+
+#include <new>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <monotonic/detail/prefix.hpp>
+#include <monotonic/storage_base.hpp>
+#include <monotonic/detail/container.hpp>
+
+#ifdef BOOST_MONOTONIC_SSE2
+#    include <emmintrin.h>
+#endif
+
+namespace boost
+{
+    namespace monotonic
+    {
+        /// tag to make a btree_map or btree_set from a range that is sorted and has no equivalent keys
+        struct ordered_unique_range_t { };
+        inline constexpr ordered_unique_range_t ordered_unique_range = ordered_unique_range_t();
+
+        namespace detail
+        {
+            template <class Mapped>
+            struct btree_mapped_size : std::integral_constant<size_t, sizeof(Mapped)> { };
+
+            template <>
+            struct btree_mapped_size<void> : std::integral_constant<size_t, 0> { };
+
+            /// the number of entries in the leaves and inner nodes of a btree. nodes are four
+            /// cache lines, but hold at least 4 entries
+            template <class Key, class Mapped>
+            struct btree_capacity
+            {
+                static constexpr size_t node_bytes = 4*DefaultSizes::CacheLineSize;
+                static constexpr size_t leaf_bytes = node_bytes - 3*sizeof(void *);
+                static constexpr size_t leaf_entry = sizeof(Key) + btree_mapped_size<Mapped>::value;
+                static constexpr size_t inner_bytes = node_bytes - 2*sizeof(void *);
+                static constexpr size_t inner_entry = sizeof(Key) + sizeof(void *);
+
+                static constexpr size_t leaf = 4*leaf_entry > leaf_bytes ? 4 : leaf_bytes/leaf_entry;
+                static constexpr size_t inner = 4*inner_entry > inner_bytes ? 4 : inner_bytes/inner_entry;
+            };
+
+            template <class Mapped, size_t Capacity>
+            struct btree_values
+            {
+                alignas(Mapped) unsigned char value_bytes[Capacity*sizeof(Mapped)];
+
+                Mapped *values()
+                {
+                    return reinterpret_cast<Mapped *>(value_bytes);
+                }
+                Mapped const *values() const
+                {
+                    return reinterpret_cast<Mapped const *>(value_bytes);
+                }
+            };
+
+            template <size_t Capacity>
+            struct btree_values<void, Capacity>
+            {
+            };
+
+            /// a leaf of a btree. the keys are kept apart from the mapped values, so that
+            /// searching a leaf only reads its keys
+            template <class Key, class Mapped, size_t Capacity>
+            struct alignas(DefaultSizes::CacheLineSize) btree_leaf : btree_values<Mapped, Capacity>
+            {
+                btree_leaf *prev, *next;
+                size_t count;
+                alignas(Key) unsigned char key_bytes[Capacity*sizeof(Key)];
+
+                Key *keys()
+                {
+                    return reinterpret_cast<Key *>(key_bytes);
+                }
+                Key const *keys() const
+                {
+                    return reinterpret_cast<Key const *>(key_bytes);
+                }
+            };
+
+            /// an inner node of a btree. keys()[n] is the smallest key of children[n + 1]
+            /// when the child was made
+            template <class Key, size_t Capacity>
+            struct alignas(DefaultSizes::CacheLineSize) btree_inner
+            {
+                size_t count;                    ///< the number of keys; there is one more child
+                alignas(Key) unsigned char key_bytes[Capacity*sizeof(Key)];
+                void *children[Capacity + 1];
+
+                Key *keys()
+                {
+                    return reinterpret_cast<Key *>(key_bytes);
+                }
+                Key const *keys() const
+                {
+                    return reinterpret_cast<Key const *>(key_bytes);
+                }
+            };
+
+            /// binary search of the keys of a node, for any key type and ordering
+            template <class Key, class Compare>
+            struct btree_binary_search
+            {
+                /// the index of the first key not less than key
+                static size_t lower(Key const *keys, size_t count, Key const &key, Compare const &comp)
+                {
+                    return std::lower_bound(keys, keys + count, key, comp) - keys;
+                }
+                /// the index of the first key greater than key
+                static size_t upper(Key const *keys, size_t count, Key const &key, Compare const &comp)
+                {
+                    return std::upper_bound(keys, keys + count, key, comp) - keys;
+                }
+            };
+
+            /// linear search of the keys of a node, for arithmetic keys ordered by operator<.
+            /// counting the smaller keys has no unpredictable branches, and can be vectorised
+            template <class Key>
+            struct btree_linear_search
+            {
+                template <class Compare>
+                static size_t lower(Key const *keys, size_t count, Key key, Compare const &)
+                {
+                    size_t index = 0;
+                    for (size_t n = 0; n < count; ++n)
+                        index += keys[n] < key;
+                    return index;
+                }
+                template <class Compare>
+                static size_t upper(Key const *keys, size_t count, Key key, Compare const &)
+                {
+                    size_t index = 0;
+                    for (size_t n = 0; n < count; ++n)
+                        index += !(key < keys[n]);
+                    return index;
+                }
+            };
+
+#ifdef BOOST_MONOTONIC_SSE2
+            /// the number of set bits in the low four bits of mask
+            inline size_t btree_bits(int mask)
+            {
+                return (mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) + ((mask >> 3) & 1);
+            }
+
+            /// as the keys are sorted, the keys less than the one sought are a prefix of each
+            /// group, so the search stops at the first group that is not entirely less
+            template <>
+            struct btree_linear_search<int>
+            {
+                template <class Compare>
+                static size_t lower(int const *keys, size_t count, int key, Compare const &)
+                {
+                    __m128i const K = _mm_set1_epi32(key);
+                    size_t n = 0;
+                    for (; n + 4 <= count; n += 4)
+                    {
+                        __m128i less = _mm_cmplt_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const *>(keys + n)), K);
+                        int mask = _mm_movemask_ps(_mm_castsi128_ps(less));
+                        if (mask != 0xF)
+                            return n + btree_bits(mask);
+                    }
+                    for (; n < count && keys[n] < key; ++n)
+                        ;
+                    return n;
+                }
+                template <class Compare>
+                static size_t upper(int const *keys, size_t count, int key, Compare const &)
+                {
+                    __m128i const K = _mm_set1_epi32(key);
+                    size_t n = 0;
+                    for (; n + 4 <= count; n += 4)
+                    {
+                        __m128i greater = _mm_cmpgt_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const *>(keys + n)), K);
+                        int mask = _mm_movemask_ps(_mm_castsi128_ps(greater));
+                        if (mask != 0)
+                            return n + 4 - btree_bits(mask);
+                    }
+                    for (; n < count && !(key < keys[n]); ++n)
+                        ;
+                    return n;
+                }
+            };
+
+            template <>
+            struct btree_linear_search<float>
+            {
+                template <class Compare>
+                static size_t lower(float const *keys, size_t count, float key, Compare const &)
+                {
+                    __m128 const K = _mm_set1_ps(key);
+                    size_t n = 0;
+                    for (; n + 4 <= count; n += 4)
+                    {
+                        int mask = _mm_movemask_ps(_mm_cmplt_ps(_mm_loadu_ps(keys + n), K));
+                        if (mask != 0xF)
+                            return n + btree_bits(mask);
+                    }
+                    for (; n < count && keys[n] < key; ++n)
+                        ;
+                    return n;
+                }
+                template <class Compare>
+                static size_t upper(float const *keys, size_t count, float key, Compare const &)
+                {
+                    __m128 const K = _mm_set1_ps(key);
+                    size_t n = 0;
+                    for (; n + 4 <= count; n += 4)
+                    {
+                        int mask = _mm_movemask_ps(_mm_cmpgt_ps(_mm_loadu_ps(keys + n), K));
+                        if (mask != 0)
+                            return n + 4 - btree_bits(mask);
+                    }
+                    for (; n < count && !(key < keys[n]); ++n)
+                        ;
+                    return n;
+                }
+            };
+
+            template <>
+            struct btree_linear_search<double>
+            {
+                template <class Compare>
+                static size_t lower(double const *keys, size_t count, double key, Compare const &)
+                {
+                    __m128d const K = _mm_set1_pd(key);
+                    size_t n = 0;
+                    for (; n + 2 <= count; n += 2)
+                    {
+                        int mask = _mm_movemask_pd(_mm_cmplt_pd(_mm_loadu_pd(keys + n), K));
+                        if (mask != 0x3)
+                            return n + btree_bits(mask);
+                    }
+                    for (; n < count && keys[n] < key; ++n)
+                        ;
+                    return n;
+                }
+                template <class Compare>
+                static size_t upper(double const *keys, size_t count, double key, Compare const &)
+                {
+                    __m128d const K = _mm_set1_pd(key);
+                    size_t n = 0;
+                    for (; n + 2 <= count; n += 2)
+                    {
+                        int mask = _mm_movemask_pd(_mm_cmpgt_pd(_mm_loadu_pd(keys + n), K));
+                        if (mask != 0)
+                            return n + 2 - btree_bits(mask);
+                    }
+                    for (; n < count && !(key < keys[n]); ++n)
+                        ;
+                    return n;
+                }
+            };
+#endif // BOOST_MONOTONIC_SSE2
+
+            template <class Key, class Compare>
+            struct btree_search : btree_binary_search<Key, Compare> { };
+
+            template <class Key>
+            struct btree_search<Key, std::less<Key> >
+                : std::conditional<std::is_arithmetic<Key>::value
+                    , btree_linear_search<Key>
+                    , btree_binary_search<Key, std::less<Key> > >::type { };
+
+            /// make items[index] uninitialised, moving the count - index items after it up by one
+            template <class T>
+            void btree_open_gap(T *items, size_t index, size_t count)
+            {
+                if (index == count)
+                    return;
+                new (items + count) T(std::move(items[count - 1]));
+                std::move_backward(items + index, items + count - 1, items + count);
+                items[index].~T();
+            }
+
+            /// fill the uninitialised items[index] by moving the items after it down by one
+            template <class T>
+            void btree_close_gap(T *items, size_t index, size_t count)
+            {
+                if (index + 1 >= count)
+                    return;
+                new (items + index) T(std::move(items[index + 1]));
+                std::move(items + index + 2, items + count, items + index + 1);
+                items[count - 1].~T();
+            }
+
+            /// move num items to uninitialised memory, destroying the originals
+            template <class T>
+            void btree_relocate(T *from, size_t num, T *to)
+            {
+                for (size_t n = 0; n < num; ++n)
+                {
+                    new (to + n) T(std::move(from[n]));
+                    from[n].~T();
+                }
+            }
+
+            /// how the elements of a btree_map are presented
+            template <class Key, class Mapped>
+            struct btree_traits
+            {
+                typedef std::pair<const Key, Mapped> value_type;
+                typedef std::pair<Key const &, Mapped &> reference;
+                typedef std::pair<Key const &, Mapped const &> const_reference;
+
+                template <class Reference, class Leaf>
+                static Reference get(Leaf *leaf, size_t index)
+                {
+                    return Reference(leaf->keys()[index], leaf->values()[index]);
+                }
+                template <class V>
+                static Key const &key_of(V const &value)
+                {
+                    return value.first;
+                }
+                template <class Leaf, class V>
+                static void construct(Leaf *leaf, size_t index, V const &value)
+                {
+                    new (leaf->keys() + index) Key(value.first);
+                    try
+                    {
+                        new (leaf->values() + index) Mapped(value.second);
+                    }
+                    catch (...)
+                    {
+                        leaf->keys()[index].~Key();
+                        throw;
+                    }
+                }
+            };
+
+            /// how the elements of a btree_set are presented
+            template <class Key>
+            struct btree_traits<Key, void>
+            {
+                typedef Key value_type;
+                typedef Key const &reference;
+                typedef Key const &const_reference;
+
+                template <class Reference, class Leaf>
+                static Reference get(Leaf *leaf, size_t index)
+                {
+                    return leaf->keys()[index];
+                }
+                static Key const &key_of(Key const &value)
+                {
+                    return value;
+                }
+                template <class Leaf>
+                static void construct(Leaf *leaf, size_t index, Key const &value)
+                {
+                    new (leaf->keys() + index) Key(value);
+                }
+            };
+
+            /// the result of operator-> for iterators whose reference is a proxy
+            template <class Reference>
+            struct btree_arrow
+            {
+                Reference ref;
+
+                Reference const *operator->() const
+                {
+                    return &ref;
+                }
+            };
+
+            template <class Leaf, class Traits, bool Const>
+            struct btree_iterator
+            {
+                typedef std::bidirectional_iterator_tag iterator_category;
+                typedef typename Traits::value_type value_type;
+                typedef ptrdiff_t difference_type;
+                typedef typename std::conditional<Const
+                    , typename Traits::const_reference
+                    , typename Traits::reference>::type reference;
+                typedef typename std::conditional<std::is_reference<reference>::value
+                    , typename std::remove_reference<reference>::type *
+                    , btree_arrow<reference> >::type pointer;
+
+                Leaf *leaf;
+                size_t index;
+
+                btree_iterator(Leaf *L = 0, size_t N = 0) : leaf(L), index(N) { }
+                /// a const iterator from an iterator
+                template <bool C, enable_const_conversion<std::integral_constant<bool, C>
+                    , std::false_type, std::integral_constant<bool, Const> > = 0>
+                btree_iterator(btree_iterator<Leaf, Traits, C> const &other) : leaf(other.leaf), index(other.index) { }
+
+                reference operator*() const
+                {
+                    return Traits::template get<reference>(leaf, index);
+                }
+                pointer operator->() const
+                {
+                    return arrow(std::is_reference<reference>());
+                }
+                btree_iterator &operator++()
+                {
+                    ++index;
+                    skip_empty();
+                    return *this;
+                }
+                btree_iterator operator++(int)
+                {
+                    btree_iterator tmp = *this;
+                    ++*this;
+                    return tmp;
+                }
+                btree_iterator &operator--()
+                {
+                    while (index == 0)
+                    {
+                        leaf = leaf->prev;
+                        index = leaf->count;
+                    }
+                    --index;
+                    return *this;
+                }
+                btree_iterator operator--(int)
+                {
+                    btree_iterator tmp = *this;
+                    --*this;
+                    return tmp;
+                }
+                friend bool operator==(btree_iterator const &A, btree_iterator const &B)
+                {
+                    return A.leaf == B.leaf && A.index == B.index;
+                }
+                friend bool operator!=(btree_iterator const &A, btree_iterator const &B)
+                {
+                    return !(A == B);
+                }
+
+                /// move from the end of a leaf to the start of the next leaf that is not empty.
+                /// the end of the last leaf is the end of the tree
+                void skip_empty()
+                {
+                    while (index == leaf->count && leaf->next != 0)
+                    {
+                        leaf = leaf->next;
+                        index = 0;
+                    }
+                }
+
+            private:
+                pointer arrow(std::true_type) const
+                {
+                    return &**this;
+                }
+                pointer arrow(std::false_type) const
+                {
+                    return pointer{**this};
+                }
+            };
+
+            /// a B+tree of unique keys whose nodes are made directly in monotonic storage. used
+            /// by btree_map, with Mapped the type of the mapped values, and by btree_set, with
+            /// Mapped void.
+            ///
+            /// entries are only in the leaves, which are chained in order. nodes are not merged
+            /// as entries are erased; leaves may become empty, and are skipped by iterators.
+            /// clear() keeps all nodes for reuse
+            template <class Key, class Mapped, class Compare>
+            struct btree
+            {
+                typedef btree_capacity<Key, Mapped> Capacity;
+                typedef btree_leaf<Key, Mapped, Capacity::leaf> Leaf;
+                typedef btree_inner<Key, Capacity::inner> Inner;
+                typedef btree_search<Key, Compare> Search;
+                typedef btree_traits<Key, Mapped> Traits;
+                typedef btree_iterator<Leaf, Traits, false> iterator;
+                typedef btree_iterator<Leaf, Traits, true> const_iterator;
+
+                enum { MaxHeight = 64 };
+
+                struct spare_link
+                {
+                    spare_link *next;
+                };
+
+                storage_base *store;
+                Compare comp;
+                void *root;
+                size_t height;                ///< the number of levels of inner nodes
+                Leaf *head, *tail;
+                size_t count;
+                spare_link *spare_leaves, *spare_inners;
+
+                btree(storage_base *S, Compare const &C)
+                    : store(S), comp(C), root(0), height(0), head(0), tail(0), count(0), spare_leaves(0), spare_inners(0) { }
+
+                btree(btree const &) = delete;
+                btree &operator=(btree const &) = delete;
+
+                ~btree()
+                {
+                    clear();
+                }
+
+                void swap(btree &other)
+                {
+                    std::swap(store, other.store);
+                    std::swap(comp, other.comp);
+                    std::swap(root, other.root);
+                    std::swap(height, other.height);
+                    std::swap(head, other.head);
+                    std::swap(tail, other.tail);
+                    std::swap(count, other.count);
+                    std::swap(spare_leaves, other.spare_leaves);
+                    std::swap(spare_inners, other.spare_inners);
+                }
+
+                iterator begin() const
+                {
+                    if (head == 0)
+                        return iterator();
+                    iterator iter(head, 0);
+                    iter.skip_empty();
+                    return iter;
+                }
+                iterator end() const
+                {
+                    if (tail == 0)
+                        return iterator();
+                    return iterator(tail, tail->count);
+                }
+
+                Leaf *find_leaf(Key const &key) const
+                {
+                    void *node = root;
+                    for (size_t level = 0; level < height; ++level)
+                    {
+                        Inner *inner = static_cast<Inner *>(node);
+                        node = inner->children[Search::upper(inner->keys(), inner->count, key, comp)];
+                    }
+                    return static_cast<Leaf *>(node);
+                }
+                iterator lower_bound(Key const &key) const
+                {
+                    if (root == 0)
+                        return end();
+                    Leaf *leaf = find_leaf(key);
+                    iterator iter(leaf, Search::lower(leaf->keys(), leaf->count, key, comp));
+                    iter.skip_empty();
+                    return iter;
+                }
+                iterator upper_bound(Key const &key) const
+                {
+                    if (root == 0)
+                        return end();
+                    Leaf *leaf = find_leaf(key);
+                    iterator iter(leaf, Search::upper(leaf->keys(), leaf->count, key, comp));
+                    iter.skip_empty();
+                    return iter;
+                }
+                iterator find(Key const &key) const
+                {
+                    if (root == 0)
+                        return end();
+                    Leaf *leaf = find_leaf(key);
+                    size_t index = Search::lower(leaf->keys(), leaf->count, key, comp);
+                    if (index == leaf->count || comp(key, leaf->keys()[index]))
+                        return end();
+                    return iterator(leaf, index);
+                }
+
+                /// add an entry for key, with a mapped value made from args, if there is no
+                /// entry for key already
+                template <class K, class... Args>
+                std::pair<iterator, bool> emplace(K &&key, Args&&... args)
+                {
+                    if (root == 0)
+                    {
+                        head = tail = new_leaf();
+                        root = head;
+                        height = 0;
+                    }
+
+                    Inner *path[MaxHeight];
+                    size_t slots[MaxHeight];
+                    void *node = root;
+                    for (size_t level = 0; level < height; ++level)
+                    {
+                        Inner *inner = static_cast<Inner *>(node);
+                        slots[level] = Search::upper(inner->keys(), inner->count, key, comp);
+                        path[level] = inner;
+                        node = inner->children[slots[level]];
+                    }
+                    Leaf *leaf = static_cast<Leaf *>(node);
+                    size_t index = Search::lower(leaf->keys(), leaf->count, key, comp);
+                    if (index < leaf->count && !comp(key, leaf->keys()[index]))
+                        return std::make_pair(iterator(leaf, index), false);
+
+                    if (leaf->count == Capacity::leaf)
+                    {
+                        // appending to the last leaf leaves the full nodes full, so that ascending
+                        // keys fill every node
+                        bool append = leaf->next == 0 && index == leaf->count;
+                        Key separator(append ? Key(key) : leaf->keys()[leaf->count/2]);
+                        split(leaf, path, slots, append, separator);
+                        if (append || index > leaf->count)
+                        {
+                            index -= leaf->count;
+                            leaf = leaf->next;
+                        }
+                    }
+                    insert_entry(leaf, index, std::forward<K>(key), std::forward<Args>(args)...);
+                    ++count;
+                    return std::make_pair(iterator(leaf, index), true);
+                }
+
+                iterator erase(iterator pos)
+                {
+                    Leaf *leaf = pos.leaf;
+                    size_t index = pos.index;
+                    leaf->keys()[index].~Key();
+                    btree_close_gap(leaf->keys(), index, leaf->count);
+                    erase_value(leaf, index, std::is_void<Mapped>());
+                    --leaf->count;
+                    --count;
+                    pos.skip_empty();
+                    return pos;
+                }
+
+                /// make the tree from a sorted range of unique keys. the tree must be empty.
+                /// the leaves are filled, and made in one block, as is each level of inner
+                /// nodes above them, so that no other memory is needed to find the children
+                template <class FI>
+                void bulk_load(FI first, FI last)
+                {
+                    size_t num = std::distance(first, last);
+                    if (num == 0)
+                        return;
+                    size_t num_leaves = (num + Capacity::leaf - 1)/Capacity::leaf;
+                    Leaf *leaves = static_cast<Leaf *>(allocate_bytes(num_leaves*sizeof(Leaf), alignof(Leaf)));
+                    for (size_t n = 0; n < num_leaves; ++n)
+                    {
+                        Leaf *leaf = new (leaves + n) Leaf;
+                        leaf->prev = tail;
+                        leaf->next = 0;
+                        leaf->count = 0;
+                        if (tail)
+                            tail->next = leaf;
+                        else
+                            head = leaf;
+                        tail = leaf;
+                    }
+                    try
+                    {
+                        size_t n = 0;
+                        for (Leaf *leaf = head; leaf != 0; leaf = leaf->next, ++n)
+                        {
+                            size_t fill = num/num_leaves + (n < num % num_leaves);
+                            for (; leaf->count < fill; ++first)
+                            {
+                                Traits::construct(leaf, leaf->count, *first);
+                                ++leaf->count;
+                                ++count;
+                            }
+                        }
+                    }
+                    catch (...)
+                    {
+                        for (Leaf *leaf = head; leaf != 0; leaf = leaf->next)
+                        {
+                            destroy(leaf->keys(), leaf->count);
+                            destroy_values(leaf, std::is_void<Mapped>());
+                        }
+                        head = tail = 0;
+                        count = 0;
+                        throw;
+                    }
+
+                    // build each level of inner nodes from the one below, sharing the nodes
+                    // evenly between parents
+                    root = head;
+                    height = 0;
+                    for (size_t num_nodes = num_leaves; num_nodes > 1; )
+                    {
+                        size_t parents = (num_nodes + Capacity::inner)/(Capacity::inner + 1);
+                        Inner *inners = static_cast<Inner *>(allocate_bytes(parents*sizeof(Inner), alignof(Inner)));
+                        size_t child = 0;
+                        for (size_t n = 0; n < parents; ++n)
+                        {
+                            size_t fanout = num_nodes/parents + (n < num_nodes % parents);
+                            Inner *inner = new (inners + n) Inner;
+                            inner->count = 0;
+                            inner->children[0] = level_node(child);
+                            for (size_t c = 1; c < fanout; ++c)
+                            {
+                                void *node = level_node(child + c);
+                                new (inner->keys() + c - 1) Key(*lowest_key(node, height));
+                                inner->children[c] = node;
+                                inner->count = c;
+                            }
+                            child += fanout;
+                        }
+                        root = inners;
+                        num_nodes = parents;
+                        ++height;
+                    }
+                }
+
+                /// destroy all entries. the nodes are kept for reuse
+                void clear()
+                {
+                    if (root != 0)
+                        release(root, height);
+                    root = 0;
+                    head = tail = 0;
+                    height = 0;
+                    count = 0;
+                }
+
+            private:
+                /// the node at the given index in the level below root, while bulk_load
+                /// builds the tree, when the nodes of the level are in one block
+                void *level_node(size_t index) const
+                {
+                    if (height == 0)
+                        return static_cast<Leaf *>(root) + index;
+                    return static_cast<Inner *>(root) + index;
+                }
+
+                /// the lowest key under a node at the given level
+                static Key const *lowest_key(void *node, size_t level)
+                {
+                    for (; level > 0; --level)
+                        node = static_cast<Inner *>(node)->children[0];
+                    return static_cast<Leaf *>(node)->keys();
+                }
+
+                void *allocate_bytes(size_t num_bytes, size_t alignment)
+                {
+                    void *ptr = store->allocate(num_bytes, alignment);
+                    if (ptr == 0)
+                        throw std::bad_alloc();
+                    return ptr;
+                }
+
+                Leaf *new_leaf()
+                {
+                    void *ptr = spare_leaves;
+                    if (ptr)
+                        spare_leaves = spare_leaves->next;
+                    else
+                        ptr = allocate_bytes(sizeof(Leaf), alignof(Leaf));
+                    Leaf *leaf = new (ptr) Leaf;
+                    leaf->prev = leaf->next = 0;
+                    leaf->count = 0;
+                    return leaf;
+                }
+
+                Inner *new_inner()
+                {
+                    void *ptr = spare_inners;
+                    if (ptr)
+                        spare_inners = spare_inners->next;
+                    else
+                        ptr = allocate_bytes(sizeof(Inner), alignof(Inner));
+                    Inner *inner = new (ptr) Inner;
+                    inner->count = 0;
+                    return inner;
+                }
+
+                /// destroy the entries and keys under node, and keep the nodes for reuse
+                void release(void *node, size_t level)
+                {
+                    if (level == 0)
+                    {
+                        Leaf *leaf = static_cast<Leaf *>(node);
+                        destroy(leaf->keys(), leaf->count);
+                        destroy_values(leaf, std::is_void<Mapped>());
+                        spare_leaves = new (leaf) spare_link{spare_leaves};
+                        return;
+                    }
+                    Inner *inner = static_cast<Inner *>(node);
+                    for (size_t n = 0; n <= inner->count; ++n)
+                        release(inner->children[n], level - 1);
+                    destroy(inner->keys(), inner->count);
+                    spare_inners = new (inner) spare_link{spare_inners};
+                }
+
+                template <class T>
+                static void destroy(T *items, size_t num)
+                {
+                    if (std::is_trivially_destructible<T>::value)
+                        return;
+                    for (size_t n = 0; n < num; ++n)
+                        items[n].~T();
+                }
+                void destroy_values(Leaf *, std::true_type)
+                {
+                }
+                void destroy_values(Leaf *leaf, std::false_type)
+                {
+                    destroy(leaf->values(), leaf->count);
+                }
+
+                void erase_value(Leaf *, size_t, std::true_type)
+                {
+                }
+                void erase_value(Leaf *leaf, size_t index, std::false_type)
+                {
+                    leaf->values()[index].~Mapped();
+                    btree_close_gap(leaf->values(), index, leaf->count);
+                }
+
+                /// split a full leaf, moving its upper half, or nothing if appending, to a new leaf
+                /// after it, and add the new leaf to the parents. the nodes that will be needed are
+                /// made first, so a failed allocation leaves the tree unchanged
+                void split(Leaf *leaf, Inner **path, size_t *slots, bool append, Key &separator)
+                {
+                    size_t full = 0;
+                    while (full < height && path[height - 1 - full]->count == Capacity::inner)
+                        ++full;
+                    Inner *fresh[MaxHeight + 1];
+                    size_t num_fresh = full + (full == height);
+                    Leaf *right = new_leaf();
+                    try
+                    {
+                        for (size_t n = 0; n < num_fresh; ++n)
+                            fresh[n] = new_inner();
+                    }
+                    catch (...)
+                    {
+                        spare_leaves = new (right) spare_link{spare_leaves};
+                        throw;
+                    }
+
+                    size_t mid = append ? leaf->count : leaf->count/2;
+                    btree_relocate(leaf->keys() + mid, leaf->count - mid, right->keys());
+                    relocate_values(leaf, mid, right, std::is_void<Mapped>());
+                    right->count = leaf->count - mid;
+                    leaf->count = mid;
+                    right->prev = leaf;
+                    right->next = leaf->next;
+                    if (leaf->next)
+                        leaf->next->prev = right;
+                    else
+                        tail = right;
+                    leaf->next = right;
+
+                    void *child = right;
+                    for (size_t level = height; level-- > 0; )
+                    {
+                        Inner *inner = path[level];
+                        size_t slot = slots[level];
+                        if (inner->count < Capacity::inner)
+                        {
+                            insert_child(inner, slot, separator, child);
+                            return;
+                        }
+
+                        // the left node keeps keys [0, mid) and children [0, mid], keys[mid]
+                        // moves up, and the right node takes the rest
+                        Inner *upper = fresh[--num_fresh];
+                        size_t mid = append ? inner->count - 1 : inner->count/2;
+                        Key promoted(std::move(inner->keys()[mid]));
+                        inner->keys()[mid].~Key();
+                        btree_relocate(inner->keys() + mid + 1, inner->count - mid - 1, upper->keys());
+                        std::copy(inner->children + mid + 1, inner->children + inner->count + 1, upper->children);
+                        upper->count = inner->count - mid - 1;
+                        inner->count = mid;
+                        if (slot <= mid)
+                            insert_child(inner, slot, separator, child);
+                        else
+                            insert_child(upper, slot - mid - 1, separator, child);
+                        separator = std::move(promoted);
+                        child = upper;
+                    }
+
+                    // the root was split
+                    Inner *new_root = fresh[--num_fresh];
+                    new (new_root->keys()) Key(std::move(separator));
+                    new_root->children[0] = root;
+                    new_root->children[1] = child;
+                    new_root->count = 1;
+                    root = new_root;
+                    ++height;
+                }
+
+                void relocate_values(Leaf *, size_t, Leaf *, std::true_type)
+                {
+                }
+                void relocate_values(Leaf *leaf, size_t mid, Leaf *right, std::false_type)
+                {
+                    btree_relocate(leaf->values() + mid, leaf->count - mid, right->values());
+                }
+
+                /// add a key at keys()[slot], and the child to its right
+                static void insert_child(Inner *inner, size_t slot, Key &key, void *child)
+                {
+                    btree_open_gap(inner->keys(), slot, inner->count);
+                    new (inner->keys() + slot) Key(std::move(key));
+                    std::copy_backward(inner->children + slot + 1, inner->children + inner->count + 1, inner->children + inner->count + 2);
+                    inner->children[slot + 1] = child;
+                    ++inner->count;
+                }
+
+                template <class K, class... Args>
+                void insert_entry(Leaf *leaf, size_t index, K &&key, Args&&... args)
+                {
+                    btree_open_gap(leaf->keys(), index, leaf->count);
+                    try
+                    {
+                        new (leaf->keys() + index) Key(std::forward<K>(key));
+                    }
+                    catch (...)
+                    {
+                        btree_close_gap(leaf->keys(), index, leaf->count + 1);
+                        throw;
+                    }
+                    insert_value(leaf, index, std::is_void<Mapped>(), std::forward<Args>(args)...);
+                    ++leaf->count;
+                }
+
+                void insert_value(Leaf *, size_t, std::true_type)
+                {
+                }
+                template <class... Args>
+                void insert_value(Leaf *leaf, size_t index, std::false_type, Args&&... args)
+                {
+                    btree_open_gap(leaf->values(), index, leaf->count);
+                    try
+                    {
+                        new (leaf->values() + index) Mapped(std::forward<Args>(args)...);
+                    }
+                    catch (...)
+                    {
+                        btree_close_gap(leaf->values(), index, leaf->count + 1);
+                        leaf->keys()[index].~Key();
+                        btree_close_gap(leaf->keys(), index, leaf->count + 1);
+                        throw;
+                    }
+                }
+            };
+
+        } // namespace detail
+
+    } // namespace monotonic
+
+} // namespace boost
+
+#include <monotonic/detail/postfix.hpp>
+
+#endif // BOOST_MONOTONIC_DETAIL_BTREE_HPP
+
+//EOF
@@ -6,6 +6,8 @@
 #ifndef BOOST_MONOTONIC_ALLOCATOR_DETAIL_CONSTRUCT_HPP
 #define BOOST_MONOTONIC_ALLOCATOR_DETAIL_CONSTRUCT_HPP
 
+#include <utility>
+
 namespace boost
 {
     namespace monotonic
@@ -25,6 +27,11 @@ namespace boost
                 {
                     new (ptr) T(val);
                 }
+                template <class T, class Alloc>
+                static void Given(T *ptr, T &&val, Alloc * /*allocator*/)
+                {
+                    new (ptr) T(std::move(val));
+                }
             };
             template <>
             struct Construct<true>
@@ -34,13 +41,19 @@ namespace boost
                 {
                     new (ptr) T(*allocator);
                 }
+                // monotonic containers all have allocator-extended copy and move
+                // constructors, so the new element uses the given allocator directly
                 template <class T, class Alloc>
                 static void Given(T *ptr, T const &val, Alloc *allocator)
                 {
-                    // unfortunately, there is no requirement for a container to 
-                    // have a copy-ctor that also passes an allocator.
-                    new (ptr) T(*allocator);
-                    *ptr = val;
+                    new (ptr) T(val, *allocator);
+                }
+                // relocates val if it uses the same storage as allocator, otherwise
+                // moves its elements into the storage of allocator
+                template <class T, class Alloc>
+                static void Given(T *ptr, T &&val, Alloc *allocator)
+                {
+                    new (ptr) T(std::move(val), *allocator);
                 }
             };
 
@@ -57,6 +70,11 @@ namespace boost
                 {
                     return T(X);
                 }
+                template <class Storage>
+                static T Given(Storage &, T &&X)
+                {
+                    return T(std::move(X));
+                }
             };
             template <class T>
             struct Create<true, T>
@@ -71,6 +89,11 @@ namespace boost
                 {
                     return T(X, storage);
                 }
+                template <class Storage>
+                static T Given(Storage &storage, T &&X)
+                {
+                    return T(std::move(X), storage);
+                }
             };
         }
         namespace detail
@@ -27,6 +27,15 @@ namespace boost
             template <class Impl>
             struct is_monotonic<container<Impl> > : std::true_type { };
 
+            /// constrains the constructor of a const iterator from an iterator. From is the
+            /// parameter of the iterator converted from, Mutable that of the container's
+            /// iterator and Self that of the iterator constructed. the constructor is a
+            /// template so that it is never a copy constructor, which keeps the implicit
+            /// copy assignment of the iterator
+            template <class From, class Mutable, class Self>
+            using enable_const_conversion = typename std::enable_if<
+                std::is_same<From, Mutable>::value && !std::is_same<From, Self>::value, int>::type;
+
             template <class Impl>
             struct container : container_base
             {
@@ -6,6 +6,10 @@
 #ifndef BOOST_MONOTONIC_ALLOCATOR_DETAIL_LINK_HPP
 #define BOOST_MONOTONIC_ALLOCATOR_DETAIL_LINK_HPP
 
+#include <memory>
+
+#include <monotonic/detail/poison.hpp>
+
 namespace boost
 {
     namespace monotonic
@@ -30,11 +34,12 @@ namespace boost
                 template <class Al2>
                 Link(Al2 const &al, size_t cap)
                     : capacity(cap), cursor(0), buffer(0)
-                    , alloc(typename Al2::template rebind<char>::other(al))
+                    , alloc(CharAllocator(al))
                 {
                     buffer = alloc.allocate(capacity);
                     if (buffer == 0)
                         capacity = 0;
+                    detail::poison(buffer, capacity);
                 }
                 size_t max_size() const
                 {
@@ -50,15 +55,19 @@ namespace boost
                 }
                 void set_cursor(size_t C)
                 {
+                    if (C < cursor)
+                        detail::poison(buffer + C, cursor - C);
                     cursor = C;
                 }
                 void reset()
                 {
+                    detail::poison(buffer, cursor);
                     cursor = 0;
                 }
                 void release()
                 {
-                    alloc.deallocate(buffer, 1);
+                    detail::unpoison(buffer, capacity);
+                    alloc.deallocate(buffer, capacity);
                 }
                 size_t used() const
                 {
@@ -66,16 +75,29 @@ namespace boost
                 }
                 inline void *allocate(size_t num_bytes, size_t alignment)
                 {
-                    size_t extra = cursor & (alignment - 1);
+                    size_t extra = reinterpret_cast<size_t>(buffer + cursor) & (alignment - 1);
                     if (extra > 0)
                         extra = alignment - extra;
-                    size_t required = num_bytes + extra;
+                    size_t required = num_bytes + extra + detail::red_zone;
                     if (capacity - cursor < required)
                         return 0;
                     char *ptr = buffer + cursor;
                     cursor += required;
+                    detail::unpoison(ptr + extra, num_bytes);
                     return ptr + extra;
                 }
+                /// grow the allocation at ptr if it ends at the cursor
+                bool extend(void *ptr, size_t num_bytes, size_t new_num_bytes)
+                {
+                    if (static_cast<char *>(ptr) + num_bytes + detail::red_zone != buffer + cursor)
+                        return false;
+                    size_t more = new_num_bytes - num_bytes;
+                    if (capacity - cursor < more)
+                        return false;
+                    cursor += more;
+                    detail::unpoison(static_cast<char *>(ptr) + num_bytes, more);
+                    return true;
+                }
                 friend bool operator<(Link const &A, Link const &B)
                 {
                     return A.remaining() < B.remaining();
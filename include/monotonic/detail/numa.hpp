@@ -0,0 +1,149 @@
+// Copyright (C) 2009-2020 Christian@Schladetsch.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MONOTONIC_DETAIL_NUMA_HPP
+#define BOOST_MONOTONIC_DETAIL_NUMA_HPP
+
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <monotonic/detail/prefix.hpp>
+
+#ifdef BOOST_MONOTONIC_NUMA
+#    include <sys/mman.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#endif
+
+namespace boost
+{
+    namespace monotonic
+    {
+        namespace detail
+        {
+            /// the number of memory nodes, from the highest that is online. 1 where this
+            /// cannot be known
+            inline int numa_count_nodes()
+            {
+#ifdef BOOST_MONOTONIC_NUMA
+                // a list of ranges such as "0-1,3", so the last number is the highest node
+                std::ifstream online("/sys/devices/system/node/online");
+                std::string list;
+                if (!std::getline(online, list))
+                    return 1;
+                size_t end = list.find_last_of("0123456789");
+                if (end == std::string::npos)
+                    return 1;
+                size_t begin = list.find_last_not_of("0123456789", end);
+                begin = begin == std::string::npos ? 0 : begin + 1;
+                return std::atoi(list.substr(begin, end - begin + 1).c_str()) + 1;
+#else
+                return 1;
+#endif
+            }
+
+            inline int numa_nodes()
+            {
+                static const int count = numa_count_nodes();
+                return count;
+            }
+
+            /// the node of the cpu the calling thread is running on
+            inline int numa_current_node()
+            {
+#ifdef BOOST_MONOTONIC_NUMA
+                unsigned cpu = 0, node = 0;
+                if (syscall(SYS_getcpu, &cpu, &node, 0) != 0)
+                    return 0;
+                return int(node);
+#else
+                return 0;
+#endif
+            }
+
+            /// ask that the pages of the given memory be placed on node when they are first
+            /// touched. the kernel may still place them elsewhere if the node is full
+            inline bool numa_bind(void *ptr, size_t num_bytes, int node)
+            {
+#ifdef BOOST_MONOTONIC_NUMA
+                const int preferred = 1;    // MPOL_PREFERRED
+                const size_t bits = 8*sizeof(unsigned long);
+                std::vector<unsigned long> mask(node/bits + 1, 0);
+                mask[node/bits] = 1ul << (node % bits);
+                // the kernel reads one bit fewer than it is told, as numactl does
+                return syscall(SYS_mbind, ptr, num_bytes, preferred, mask.data(), mask.size()*bits + 1, 0) == 0;
+#else
+                return false;
+#endif
+            }
+
+            /// the node that holds the page at ptr, which is touched if it was not yet;
+            /// -1 if it cannot be known
+            inline int numa_node_of(const void *ptr)
+            {
+#ifdef BOOST_MONOTONIC_NUMA
+                const int node_of_address = 3;    // MPOL_F_NODE | MPOL_F_ADDR
+                int node = -1;
+                if (syscall(SYS_get_mempolicy, &node, 0, 0, ptr, node_of_address) != 0)
+                    return -1;
+                return node;
+#else
+                return ptr ? 0 : -1;
+#endif
+            }
+
+            /// gives links memory on one node: whole pages mapped for them, and bound to
+            /// the node when there is more than one
+            struct numa_node_allocator
+            {
+                typedef char value_type;
+
+                int node;
+
+                explicit numa_node_allocator(int n = 0) : node(n)
+                {
+                }
+
+                char *allocate(size_t num_bytes)
+                {
+#ifdef BOOST_MONOTONIC_NUMA
+                    void *ptr = mmap(0, num_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                    if (ptr == MAP_FAILED)
+                        return 0;
+                    if (numa_nodes() > 1)
+                        numa_bind(ptr, num_bytes, node);
+                    return static_cast<char *>(ptr);
+#else
+                    return static_cast<char *>(::operator new(num_bytes, std::nothrow));
+#endif
+                }
+
+                void deallocate(char *ptr, size_t num_bytes)
+                {
+                    if (ptr == 0)
+                        return;
+#ifdef BOOST_MONOTONIC_NUMA
+                    munmap(ptr, num_bytes);
+#else
+                    ::operator delete(ptr);
+#endif
+                }
+            };
+
+        } // namespace detail
+
+    } // namespace monotonic
+
+} // namespace boost
+
+#include <monotonic/detail/postfix.hpp>
+
+#endif // BOOST_MONOTONIC_DETAIL_NUMA_HPP
+
+//EOF
@@ -0,0 +1,60 @@
+// Copyright (C) 2009-2020 Christian@Schladetsch.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MONOTONIC_DETAIL_POISON_HPP
+#define BOOST_MONOTONIC_DETAIL_POISON_HPP
+
+#include <cstddef>
+
+#include <monotonic/detail/prefix.hpp>
+
+#ifdef BOOST_MONOTONIC_POISON
+#    include <sanitizer/asan_interface.h>
+#endif
+
+namespace boost
+{
+    namespace monotonic
+    {
+        namespace detail
+        {
+#ifdef BOOST_MONOTONIC_POISON
+            /// bytes left poisoned after each allocation from a buffer, so that a
+            /// read or write past its end is reported
+            constexpr size_t red_zone = 16;
+
+            /// mark memory that has not been allocated, or was released by reset()
+            inline void poison(const void *ptr, size_t num_bytes)
+            {
+                ASAN_POISON_MEMORY_REGION(ptr, num_bytes);
+            }
+
+            /// mark memory that has been allocated
+            inline void unpoison(const void *ptr, size_t num_bytes)
+            {
+                ASAN_UNPOISON_MEMORY_REGION(ptr, num_bytes);
+            }
+#else
+            constexpr size_t red_zone = 0;
+
+            inline void poison(const void *, size_t)
+            {
+            }
+
+            inline void unpoison(const void *, size_t)
+            {
+            }
+#endif
+        } // namespace detail
+
+    } // namespace monotonic
+
+} // namespace boost
+
+#include <monotonic/detail/postfix.hpp>
+
+#endif // BOOST_MONOTONIC_DETAIL_POISON_HPP
+
+//EOF
@@ -6,21 +6,24 @@
 #ifndef BOOST_MONOTONIC_DETAIL_POOL_HPP
 #define BOOST_MONOTONIC_DETAIL_POOL_HPP
 
+#include <monotonic/detail/poison.hpp>
+
 namespace boost
 {
     namespace monotonic
     {
         namespace detail
         {
-            /// a pool of same-sized chunks in a storage block
+            /// a pool of same-sized chunks in a storage block. a chunk is at least one byte
+            /// larger than the request it serves
             struct Pool
             {
                 char *first, *next, *last;
                 size_t bucket_size;
-                Pool() : first(0), next(0), last(0), bucket_size(0)
+                constexpr Pool() : first(0), next(0), last(0), bucket_size(0)
                 {
                 }
-                Pool(size_t bs) : first(0), next(0), last(0), bucket_size(bs)
+                constexpr Pool(size_t bs) : first(0), next(0), last(0), bucket_size(bs)
                 {
                 }
                 template <class Storage>
@@ -35,11 +38,12 @@ namespace boost
                 void pop()
                 {
                     next -= bucket_size;
+                    detail::poison(next, bucket_size);
                 }
                 template <class Storage>
                 bool expand(Storage &storage)
                 {
-                    size_t capacity = (std::max)(DefaultSizes::MinPoolSize*bucket_size, (last - first)*bucket_size*2);
+                    size_t capacity = (std::max)(DefaultSizes::MinPoolSize*bucket_size, size_t(last - first)*2);
                     void *ptr = storage.from_fixed(capacity, 16);
                     if (ptr == 0)
                     {
@@ -47,6 +51,8 @@ namespace boost
                         if (ptr == 0)
                             return false;
                     }
+                    // chunks are unpoisoned by the storage as they are allocated
+                    detail::poison(ptr, capacity);
                     first = next = (char *)ptr;
                     last = first + capacity;
                     return true;
@@ -12,6 +12,7 @@
 #include <monotonic/forward_declarations.hpp>
 #include <monotonic/exceptions.hpp>
 #include <monotonic/storage_base.hpp>
+#include <monotonic/detail/poison.hpp>
 #include <type_traits>
 
 //#define BOOST_MONOTONIC_STORAGE_EARLY_OUT
@@ -37,18 +38,35 @@ namespace boost
             size_t cursor;            ///< pointer to current index within storage for next allocation
 #ifndef NDEBUG
             size_t num_allocations;
+#endif
+#ifdef BOOST_MONOTONIC_POISON
+            bool poisoned;            ///< the unallocated part of the buffer has been poisoned
 #endif
         public:
-            fixed_storage() 
-                : cursor(0)
+            /// constexpr so that a fixed_storage with static duration is constant-initialised:
+            /// the buffer and cursor are zero-filled in .bss, with no static constructor
+            constexpr fixed_storage() 
+                : buffer()
+                , cursor(0)
 #ifdef BOOST_MONOTONIC_STORAGE_EARLY_OUT
                 , full(false)
 #endif
 #ifndef NDEBUG
                 , num_allocations(0)
 #endif
+#ifdef BOOST_MONOTONIC_POISON
+                , poisoned(false)
+#endif
+            {
+            }
+
+#ifdef BOOST_MONOTONIC_POISON
+            // the buffer may be on the stack, which must not be left poisoned
+            ~fixed_storage()
             {
+                detail::unpoison(buffer.data(), InlineSize);
             }
+#endif
 
             Buffer const &get_buffer()  const
             {
@@ -64,6 +82,7 @@ namespace boost
             }
             void reset()
             {
+                detail::poison(buffer.data(), cursor);
                 cursor = 0;
 #ifdef BOOST_MONOTONIC_STORAGE_EARLY_OUT
                 full = false;
@@ -84,6 +103,8 @@ namespace boost
 
             void set_cursor(size_t c)
             {
+                if (c < cursor)
+                    detail::poison(buffer.data() + c, cursor - c);
                 cursor = c;
             }
 
@@ -101,10 +122,10 @@ namespace boost
 
             AllocationAttempt TryAllocation(size_t num_bytes, size_t alignment)
             {
-                size_t extra = cursor & (alignment - 1);    // assumes alignment is a power of 2!
+                size_t extra = reinterpret_cast<size_t>(buffer.data() + cursor) & (alignment - 1);    // assumes alignment is a power of 2!
                 if (extra > 0)
                     extra = alignment - extra;
-                size_t required = num_bytes + extra;
+                size_t required = num_bytes + extra + detail::red_zone;
                 if (cursor + required > InlineSize)
                     return AllocationAttempt();
                 return AllocationAttempt(required, extra);
@@ -112,12 +133,16 @@ namespace boost
 
             void *MakeAllocation(AllocationAttempt const &ad)
             {
+                PoisonUnallocated();
                 char *ptr = &buffer[cursor];
                 cursor += ad.required;
+                detail::unpoison(ptr + ad.extra, ad.required - ad.extra - detail::red_zone);
                 return ptr + ad.extra;
             }
             
         public:
+            using storage_base::allocate;
+
             /// allocate storage, given alignment requirement
             void *allocate(size_t num_bytes, size_t alignment)
             {
@@ -126,10 +151,10 @@ namespace boost
                     return 0;
 #endif
 
-                size_t extra = cursor & (alignment - 1);
+                size_t extra = reinterpret_cast<size_t>(buffer.data() + cursor) & (alignment - 1);
                 if (extra > 0)
                     extra = alignment - extra;
-                size_t required = num_bytes + extra;
+                size_t required = num_bytes + extra + detail::red_zone;
                 if (cursor + required > InlineSize)
                 {
 #ifdef BOOST_MONOTONIC_STORAGE_EARLY_OUT
@@ -140,8 +165,10 @@ namespace boost
 #ifndef NDEBUG
                 ++num_allocations;
 #endif
+                PoisonUnallocated();
                 char *ptr = &buffer[cursor];
                 cursor += required;
+                detail::unpoison(ptr + extra, num_bytes);
                 return ptr + extra;
             }
 
@@ -150,6 +177,19 @@ namespace boost
                 // do nothing
             }
 
+            /// grow the allocation at ptr if it ends at the cursor
+            bool extend(void *ptr, size_t num_bytes, size_t new_num_bytes)
+            {
+                if (static_cast<char *>(ptr) + num_bytes + detail::red_zone != buffer.data() + cursor)
+                    return false;
+                size_t more = new_num_bytes - num_bytes;
+                if (InlineSize - cursor < more)
+                    return false;
+                cursor += more;
+                detail::unpoison(static_cast<char *>(ptr) + num_bytes, more);
+                return true;
+            }
+
             size_t max_size() const
             {
                 return InlineSize;
@@ -196,7 +236,7 @@ namespace boost
             Ty &create()
             {
                 Ty *ptr = uninitialised_create<Ty>();
-                construct(ptr, boost::is_pod<Ty>());
+                construct(ptr, std::is_pod<Ty>());
                 return *ptr;
             }
 
@@ -231,7 +271,7 @@ namespace boost
             template <size_t N>
             char *allocate_bytes()
             {
-                return allocate_bytes(N, boost::aligned_storage<N>::alignment);
+                return allocate_bytes(N, alignof(typename std::aligned_storage<N>::type));
             }
 
             char *allocate_bytes(size_t num_bytes, size_t alignment = 1)
@@ -239,6 +279,18 @@ namespace boost
                 return reinterpret_cast<char *>(allocate(num_bytes, alignment));
             }
 
+        private:
+            /// the constructor is constexpr, so the buffer is poisoned by the first allocation
+            void PoisonUnallocated()
+            {
+#ifdef BOOST_MONOTONIC_POISON
+                if (!poisoned)
+                {
+                    detail::poison(buffer.data() + cursor, InlineSize - cursor);
+                    poisoned = true;
+                }
+#endif
+            }
         };
     
     } // namespace monotonic
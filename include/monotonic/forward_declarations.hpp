@@ -73,10 +73,24 @@ namespace boost
         template <class Storage>
         struct shared_storage;
 
-        // thread-local storage
+        // storage that records a trace of the requests made of another storage
+        struct recording_storage;
+
+        // storage that traces the requests made of another storage to a file, with
+        // the time and thread of each
+        template <class Storage, size_t RingSize = DefaultSizes::TraceRingSize>
+        struct tracing_storage;
+
+        // thread-safe storage with a chain of links on each NUMA node, which gives each
+        // thread memory from the node it runs on
+        template <size_t MinHeapIncrement = DefaultSizes::MinHeapIncrement>
+        struct numa_storage;
+
+        // thread-local storage, with a storage on each thread for each region
         template <size_t InlineSize = DefaultSizes::InlineSize
             , size_t MinHeapIncrement = DefaultSizes::MinHeapIncrement
-            , class Al = default_allocator >
+            , class Al = default_allocator
+            , class Region = default_region_tag >
         struct thread_local_storage;
 
         // a globally available storage buffer
@@ -87,6 +101,11 @@ namespace boost
             , class Al = default_allocator >
         struct static_storage;
 
+        // a globally available fixed-size buffer that is constant-initialised
+        template <class Region = default_region_tag
+            , size_t InlineSize = DefaultSizes::InlineSize>
+        struct static_fixed_storage;
+
         /// common to other monotonic allocators for type T of type Derived
         template <class T, class Derived>
         struct allocator_base;
@@ -99,6 +118,10 @@ namespace boost
         template <class T, class Region = default_region_tag, class Access = default_access_tag> 
         struct allocator;
 
+        // a monotonic allocator bound to a given storage instance rather than a region
+        template <class T, class Storage = storage<> >
+        struct arena_allocator;
+
         // a monotonic shared_allocator has a shared storage buffer and a no-op deallocate() method
         // defaults to use static_storage_base<..., shared_storage>
         template <class T, class Region = default_region_tag> 
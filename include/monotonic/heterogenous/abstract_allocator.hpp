@@ -5,8 +5,8 @@
 
 #pragma once
 
-#include <boost/heterogenous/detail/prefix.hpp>
-#include <boost/heterogenous/forward_declarations.hpp>
+#include <monotonic/heterogenous/detail/prefix.hpp>
+#include <monotonic/heterogenous/forward_declarations.hpp>
 
 namespace boost::heterogenous {
 /// base class for (wrapped) allocators to be used with heterogenous::cloneable<>
@@ -31,5 +31,5 @@ struct abstract_allocator
 
 }  // namespace boost::heterogenous
 
-#include <boost/heterogenous/detail/suffix.hpp>
+#include <monotonic/heterogenous/detail/suffix.hpp>
 
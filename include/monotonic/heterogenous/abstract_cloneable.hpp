@@ -8,8 +8,8 @@
 
 #include <string>
 #include <boost/functional/hash_fwd.hpp>
-#include <boost/heterogenous/detail/prefix.hpp>
-#include <boost/heterogenous/abstract_allocator.hpp>
+#include <monotonic/heterogenous/detail/prefix.hpp>
+#include <monotonic/heterogenous/abstract_allocator.hpp>
 
 namespace boost
 {
@@ -43,6 +43,17 @@ namespace boost
             /// be overriden by the user in the derived type if required.
             virtual this_type *copy_construct(abstract_allocator &) const = 0;
 
+            /// the size of the most-derived object, in bytes
+            virtual size_t size_of() const = 0;
+
+            /// the required alignment of the most-derived object
+            virtual size_t align_of() const = 0;
+
+            /// copy-construct the most-derived object at the given address, which must
+            /// be at least size_of() bytes and aligned to align_of(). used to clone many
+            /// objects into one block of memory.
+            virtual this_type *copy_construct_at(void *place) const = 0;
+
             /// optional means to make a clone that does not use copy-construction.
             /// user can overload this in their derived type to provide custom clone implementation.
             virtual this_type *make_copy(abstract_allocator &) const { return 0; }
@@ -103,7 +114,7 @@ namespace boost
 
 } // namespace boost
 
-#include <boost/heterogenous/detail/suffix.hpp>
+#include <monotonic/heterogenous/detail/suffix.hpp>
 
 #endif // BOOST_HETEROGENOUS_COMMON_BASE_HPP
 
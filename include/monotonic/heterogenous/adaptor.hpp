@@ -6,8 +6,8 @@
 #ifndef BOOST_HETEROGENOUS_ADAPTOR_HPP
 #define BOOST_HETEROGENOUS_ADAPTOR_HPP
 
-#include <boost/heterogenous/detail/prefix.hpp>
-#include <boost/heterogenous/cloneable.hpp>
+#include <monotonic/heterogenous/detail/prefix.hpp>
+#include <monotonic/heterogenous/cloneable.hpp>
 
 namespace boost
 {
@@ -41,7 +41,7 @@ namespace boost
 
 } // namespace boost
 
-#include <boost/heterogenous/detail/suffix.hpp>
+#include <monotonic/heterogenous/detail/suffix.hpp>
 
 #endif // BOOST_HETEROGENOUS_ADAPTOR_HPP
 
@@ -6,8 +6,8 @@
 #ifndef BOOST_HETEROGENOUS_ALLOCATOR_HPP
 #define BOOST_HETEROGENOUS_ALLOCATOR_HPP
 
-#include <boost/heterogenous/detail/prefix.hpp>
-#include <boost/heterogenous/detail/allocation.hpp>
+#include <monotonic/heterogenous/detail/prefix.hpp>
+#include <monotonic/heterogenous/detail/allocation.hpp>
 
 namespace boost
 {
@@ -22,10 +22,14 @@ namespace boost
                 throw;
             }
 
+            /// destroy a clone, but do not release its memory: that belongs to the
+            /// allocator that made it, which is typically monotonic
             template <class Base>
             static void deallocate_clone( const Base* clone )
             {
-                throw;
+                if (!clone)
+                    return;
+                const_cast<Base *>(clone)->~Base();
             }
 
             template <class Base, class Alloc>
@@ -66,14 +70,13 @@ namespace boost
             typename Alloc::template rebind<T>::other al(alloc);
             al.destroy(ptr);
             al.deallocate(ptr, 1);
-            return ptr;
         }
 
     } // namespace heterogenous
 
 } // namespace boost
 
-#include <boost/heterogenous/detail/suffix.hpp>
+#include <monotonic/heterogenous/detail/suffix.hpp>
 
 #endif // BOOST_HETEROGENOUS_ALLOCATOR_HPP
 
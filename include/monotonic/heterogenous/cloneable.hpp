@@ -6,9 +6,8 @@
 #ifndef BOOST_HETEROGENOUS_BASE_HPP
 #define BOOST_HETEROGENOUS_BASE_HPP
 
-#include <boost/aligned_storage.hpp>
-#include <boost/heterogenous/detail/prefix.hpp>
-#include <boost/heterogenous/abstract_cloneable.hpp>
+#include <monotonic/heterogenous/detail/prefix.hpp>
+#include <monotonic/heterogenous/abstract_cloneable.hpp>
 
 namespace boost
 {
@@ -29,6 +28,8 @@ namespace boost
 
         public:
             cloneable() { self_ptr = static_cast<Derived *>(this); }
+            cloneable(cloneable const &other) : abstract_base_type(other) { self_ptr = static_cast<Derived *>(this); }
+            cloneable &operator=(cloneable const &other) { abstract_base_type::operator=(other); return *this; }
 
             virtual this_type *allocate(abstract_allocator &alloc) const 
             {
@@ -61,17 +62,32 @@ namespace boost
                 new (ptr->this_type::self_ptr) Derived(static_cast<const Derived &>(*this));
                 return ptr;
             }
+
+            virtual size_t size_of() const
+            {
+                return sizeof(derived_type);
+            }
+
+            virtual size_t align_of() const
+            {
+                return alignment;
+            }
+
+            virtual this_type *copy_construct_at(void *place) const
+            {
+                return new (place) Derived(static_cast<const Derived &>(*this));
+            }
         };
 
         /// ensure correct alignment when allocating derived instances
         template <class Derived, class Base/*, class AbstractBase*/>
-        const size_t cloneable<Derived, Base/*, AbstractBase*/>::alignment = aligned_storage<sizeof(Derived)>::alignment;
+        const size_t cloneable<Derived, Base/*, AbstractBase*/>::alignment = alignof(Derived);
 
     } // namespace heterogenous
 
 } // namespace boost
 
-#include <boost/heterogenous/detail/suffix.hpp>
+#include <monotonic/heterogenous/detail/suffix.hpp>
 
 #endif // BOOST_HETEROGENOUS_BASE_HPP
 
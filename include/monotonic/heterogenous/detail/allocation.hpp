@@ -6,9 +6,9 @@
 #ifndef BOOST_HETEROGENOUS_DETAIL_ALLOCATION_HPP
 #define BOOST_HETEROGENOUS_DETAIL_ALLOCATION_HPP
 
-#include <boost/heterogenous/detail/prefix.hpp>
-#include <boost/heterogenous/cloneable.hpp>
-#include <boost/heterogenous/detail/pointer.hpp>
+#include <monotonic/heterogenous/detail/prefix.hpp>
+#include <monotonic/heterogenous/cloneable.hpp>
+#include <monotonic/heterogenous/detail/pointer.hpp>
 
 namespace boost
 {
@@ -17,7 +17,7 @@ namespace boost
         namespace detail
         {
             template <class U, class Alloc>
-            U *allocate(Alloc &al)
+            U *allocate(Alloc const &al)
             {
                 typename Alloc::template rebind<U>::other alloc(al);
                 return alloc.allocate(1);
@@ -26,7 +26,7 @@ namespace boost
             // TODO: use variadic template arguments, or BOOST_PP
 
             template <class U, class Base, class Alloc>
-            pointer<U,Base> construct(Alloc &al)
+            pointer<U,Base> construct(Alloc const &al)
             {
                 typename Alloc::template rebind<U>::other alloc(al);
                 U *ptr = alloc.allocate(1);
@@ -35,7 +35,7 @@ namespace boost
             }
 
             template <class U, class Base, class Alloc, class A0>
-            pointer<U,Base> construct(Alloc &al, A0 a0)
+            pointer<U,Base> construct(Alloc const &al, A0 a0)
             {
                 U *ptr = allocate<U>(al);
                 new (ptr) U(a0);
@@ -43,7 +43,7 @@ namespace boost
             }
 
             template <class U, class Base, class Alloc, class A0, class A1>
-            pointer<U,Base> construct(Alloc &al, A0 a0, A1 a1)
+            pointer<U,Base> construct(Alloc const &al, A0 a0, A1 a1)
             {
                 U *ptr = allocate<U>(al);
                 new (ptr) U(a0, a1);
@@ -51,7 +51,7 @@ namespace boost
             }
 
             template <class U, class Base, class Alloc, class A0, class A1, class A2>
-            pointer<U,Base> construct(Alloc &al, A0 a0, A1 a1, A2 a2)
+            pointer<U,Base> construct(Alloc const &al, A0 a0, A1 a1, A2 a2)
             {
                 U *ptr = allocate<U>(al);
                 new (ptr) U(a0, a1, a2);
@@ -66,7 +66,7 @@ namespace boost
 
 } // namespace boost
 
-#include <boost/heterogenous/detail/suffix.hpp>
+#include <monotonic/heterogenous/detail/suffix.hpp>
 
 #endif // BOOST_HETEROGENOUS_DETAIL_ALLOCATION_HPP
 
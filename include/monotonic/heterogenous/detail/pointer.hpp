@@ -6,8 +6,8 @@
 #ifndef BOOST_HETEROGENOUS_DETAIL_POINTER_HPP
 #define BOOST_HETEROGENOUS_DETAIL_POINTER_HPP
 
-#include <boost/heterogenous/detail/prefix.hpp>
-#include <boost/heterogenous/cloneable.hpp>
+#include <monotonic/heterogenous/detail/prefix.hpp>
+#include <monotonic/heterogenous/cloneable.hpp>
 
 namespace boost
 {
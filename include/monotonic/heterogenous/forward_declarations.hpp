@@ -9,8 +9,8 @@
 #include <functional>
 // including monotonic/allocator.hpp is temporary; not needed after make_clone_allocator works properly
 #define BOOST_HETEROGENOUS
-#include <boost/monotonic/allocator.hpp>
-#include <boost/heterogenous/detail/prefix.hpp>
+#include <monotonic/allocator.hpp>
+#include <monotonic/heterogenous/detail/prefix.hpp>
 
 namespace boost
 {
@@ -53,7 +53,15 @@ namespace boost
             >//, class AbstractBase = abstract_cloneable<Base> >
         struct vector;
 
-        /// a mapping of heterogenous objects to heterogenous objects
+        /// a heterogenous vector that stores objects of each derived type contiguously
+        template <
+            class Base = default_base_type
+            , class Alloc = monotonic::allocator<int>
+            >
+        struct segregated_vector;
+
+        /// a hashed mapping of heterogenous objects to heterogenous objects.
+        /// Pred orders keys; keys are equal when neither is ordered before the other
         template <
             class Base = default_base_type
             , class Pred = std::less<Base>
@@ -65,7 +73,7 @@ namespace boost
 
 } // namespace boost
 
-#include <boost/heterogenous/detail/suffix.hpp>
+#include <monotonic/heterogenous/detail/suffix.hpp>
 
 #endif // BOOST_HETEROGENOUS_FORWARD_DECLARATIONS_HPP
 
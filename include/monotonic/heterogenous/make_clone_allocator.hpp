@@ -6,9 +6,12 @@
 #ifndef BOOST_HETEROGENOUS_MAKE_CLONEABLE_ALLOCATOR_HPP
 #define BOOST_HETEROGENOUS_MAKE_CLONEABLE_ALLOCATOR_HPP
 
+#include <memory>
+#include <new>
+#include <type_traits>
 #include <boost/type_traits/is_convertible.hpp>
-#include <boost/heterogenous/detail/prefix.hpp>
-#include <boost/heterogenous/allocator.hpp>
+#include <monotonic/heterogenous/detail/prefix.hpp>
+#include <monotonic/heterogenous/allocator.hpp>
 
 namespace boost
 {
@@ -16,12 +19,42 @@ namespace boost
     {
         namespace impl
         {
-            /// adapts a given Alloc type, modelling the v1 std::allocator concept, to provide
-            /// services required by abstract_allocator
+            /// true if Alloc draws from monotonic storage. such allocators can be given an
+            /// alignment directly, and do not need to be told the size of a deallocation
             template <class Alloc>
+            struct is_monotonic_allocator
+            {
+                template <class T, class Derived>
+                static std::true_type test(monotonic::allocator_base<T, Derived> const *);
+                template <class T, class Storage>
+                static std::true_type test(monotonic::arena_allocator<T, Storage> const *);
+                static std::false_type test(...);
+
+                BOOST_STATIC_CONSTANT(bool, value = decltype(test(static_cast<Alloc *>(0)))::value);
+            };
+
+            template <class T, class Derived>
+            abstract_allocator::pointer allocate_aligned(monotonic::allocator_base<T, Derived> const &alloc, size_t num_bytes, size_t alignment)
+            {
+                return reinterpret_cast<abstract_allocator::pointer>(alloc.get_storage()->allocate(num_bytes, alignment));
+            }
+
+            template <class T, class Storage>
+            abstract_allocator::pointer allocate_aligned(monotonic::arena_allocator<T, Storage> const &alloc, size_t num_bytes, size_t alignment)
+            {
+                return reinterpret_cast<abstract_allocator::pointer>(alloc.get_storage().allocate(num_bytes, alignment));
+            }
+
+            /// adapts a given Alloc type, modelling the v1 std::allocator concept, to provide
+            /// services required by abstract_allocator.
+            ///
+            /// each allocation is prefixed with a header that records the originally
+            /// allocated pointer and size, so that correctly aligned memory can be
+            /// returned to Alloc.
+            template <class Alloc, bool = is_monotonic_allocator<Alloc>::value>
             struct clone_allocator : Alloc, abstract_allocator
             {
-                typedef typename Alloc::template rebind<char>::other CharAlloc;
+                typedef typename std::allocator_traits<Alloc>::template rebind_alloc<char> CharAlloc;
 
                 clone_allocator() { }
                 clone_allocator(Alloc &a) : Alloc(a) { }
@@ -32,36 +65,51 @@ namespace boost
                     size_t num_bytes;
                 };
 
-                abstract_allocator::pointer allocate_bytes(size_t num_bytes, size_t /*alignment*/)
+                abstract_allocator::pointer allocate_bytes(size_t num_bytes, size_t alignment)
                 {
+                    if (alignment < alignof(header))
+                        alignment = alignof(header);
                     CharAlloc alloc(*this);
-                    return alloc.allocate(num_bytes);
-                    
-                    // TODO: do correct alignment, store padding information so dealloc 
-                    // can retrieve the originally allocated pointer
-
-                    //CharAlloc alloc(*this);
-                    //header head;
-                    //head.num_bytes = sizeof(header) + num_bytes + alignment;    // don't need this much, but will do for now
-                    //abstract_allocator::pointer char_ptr = alloc.allocate(head.num_bytes);
-                    //head.allocated_ptr = (header *)char_ptr;
-                    //*head.allocated_ptr = head;
-                    //abstract_allocator::pointer base = char_ptr + sizeof(header);
-                    //base += calc_padding(base, alignment);
-                    //return base;
+                    size_t total = sizeof(header) + num_bytes + alignment - 1;
+                    abstract_allocator::pointer char_ptr = alloc.allocate(total);
+                    abstract_allocator::pointer base = char_ptr + sizeof(header);
+                    base += calc_padding(base, alignment);
+                    header *head = reinterpret_cast<header *>(base - sizeof(header));
+                    head->allocated_ptr = char_ptr;
+                    head->num_bytes = total;
+                    return base;
                 }
 
                 void deallocate_bytes(abstract_allocator::pointer ptr, size_t /*alignment*/)
                 {
+                    if (ptr == 0)
+                        return;
                     CharAlloc alloc(*this);
-                    alloc.deallocate(ptr);
-                    
-                    // TODO: retreive the originally allocated pointer
+                    header *head = reinterpret_cast<header *>(ptr - sizeof(header));
+                    alloc.deallocate(head->allocated_ptr, head->num_bytes);
+                }
+            };
+
+            /// a clone allocator for monotonic allocators. memory is aligned by the
+            /// storage itself, so there is no per-object header
+            template <class Alloc>
+            struct clone_allocator<Alloc, true> : Alloc, abstract_allocator
+            {
+                clone_allocator() { }
+                clone_allocator(Alloc &a) : Alloc(a) { }
 
-                    //header *head = reinterpret_cast<header *>(ptr - sizeof(head));
-                    //alloc.deallocate(head->allocated_ptr, head->num_bytes);
+                abstract_allocator::pointer allocate_bytes(size_t num_bytes, size_t alignment)
+                {
+                    abstract_allocator::pointer ptr = allocate_aligned(static_cast<Alloc const &>(*this), num_bytes, alignment);
+                    if (ptr == 0)
+                        throw std::bad_alloc();
+                    return ptr;
                 }
 
+                void deallocate_bytes(abstract_allocator::pointer, size_t /*alignment*/)
+                {
+                    // do nothing
+                }
             };
 
             template <class Alloc, bool>
@@ -89,7 +137,7 @@ namespace boost
 
 } // namespace boost
 
-#include <boost/heterogenous/detail/suffix.hpp>
+#include <monotonic/heterogenous/detail/suffix.hpp>
 
 #endif // BOOST_HETEROGENOUS_MAKE_CLONEABLE_ALLOCATOR_HPP
 
@@ -1,50 +1,150 @@
 // Copyright (C) 2009-2020 Christian@Schladetsch.com
 //
-//  Distributed under the Boost Software License, Version 1.0. (See accompanying 
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
 //  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 
 #ifndef BOOST_HETEROGENOUS_MAP_HPP
 #define BOOST_HETEROGENOUS_MAP_HPP
 
-#include <boost/ptr_container/ptr_map.hpp>
-#include <boost/foreach.hpp>
+#include <memory>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <type_traits>
 
-#include <boost/cloneable/detail/make_clone_allocator.hpp>
+#include <monotonic/heterogenous/make_clone_allocator.hpp>
 
-namespace boost 
+namespace boost
 {
     namespace heterogenous
     {
-        /// a vector of heterogenous objects
+        /// a mapping of heterogenous objects to heterogenous objects.
+        ///
+        /// this is an open-addressing hash table. each slot caches the hash of its key
+        /// next to the key and value pointers, so probing and growing the table do not
+        /// touch the key objects; a key is only compared, using Pred, when the cached
+        /// hashes match. Pred orders keys, as it did for the std::map this replaced, and
+        /// two keys are equal when neither orders before the other.
+        ///
+        /// keys are hashed with hash_value, which key types must override so that equal
+        /// keys hash alike; key<U>() and find() check this where the type is known. a
+        /// key that does not override it hashes to 0, which is correct but slow.
+        ///
+        /// the slots, keys and values are all made by the same allocator, so with a
+        /// monotonic allocator they share one storage. use reserve to avoid abandoning
+        /// smaller tables as the map grows.
         template <class Base, class Pred, class Alloc>//, class AbstractBase>
         struct map
         {
             typedef typename make_clone_allocator<Alloc>::type allocator_type;
             typedef Base base_type;
-            //typedef ptr_map<Base, Base, Pred, allocator, allocator_type> implementation;
             typedef abstract_cloneable<Base> abstract_base_type;
+            typedef abstract_base_type *key_type;
+            typedef abstract_base_type *mapped_type;
+            typedef std::pair<key_type, mapped_type> value_type;
+            typedef value_type &reference;
+            typedef const value_type &const_reference;
+            typedef map<Base, Pred, Alloc/*, AbstractBase*/> this_type;
 
-            typedef std::map<Base *, Base *, Pred, allocator_type> implementation;
+            /// true if U overrides hash_value, rather than inheriting the default
+            template <class U>
+            struct has_hash_value : std::integral_constant<bool
+                , std::is_same<U, abstract_base_type>::value
+                    || !std::is_same<decltype(&U::hash_value), size_t (abstract_base_type::*)() const>::value>
+            {
+            };
 
-            typedef typename implementation::value_type value_type;
-            typedef typename implementation::reference reference;
-            typedef typename implementation::const_reference const_reference;
-            typedef typename implementation::iterator iterator;
-            typedef typename implementation::const_iterator const_iterator;
-            typedef typename implementation::key_type key_type;
-            typedef typename implementation::mapped_type mapped_type;
-            typedef map<Base, Pred, Alloc/*, AbstractBase*/> this_type;
+        private:
+            struct slot
+            {
+                size_t hash;
+                value_type value;        ///< value.first is null if the slot is empty
+            };
+
+            typedef typename std::allocator_traits<allocator_type>::template rebind_alloc<slot> slot_allocator;
+
+            template <class Slot, class Value>
+            struct slot_iterator
+            {
+                typedef std::forward_iterator_tag iterator_category;
+                typedef typename this_type::value_type value_type;
+                typedef ptrdiff_t difference_type;
+                typedef Value *pointer;
+                typedef Value &reference;
+
+                Slot *current, *last;
+
+                slot_iterator(Slot *C = 0, Slot *L = 0) : current(C), last(L)
+                {
+                    skip_empty();
+                }
+                template <class S, class V>
+                slot_iterator(slot_iterator<S, V> const &other) : current(other.current), last(other.last) { }
+
+                reference operator*() const
+                {
+                    return current->value;
+                }
+                pointer operator->() const
+                {
+                    return &current->value;
+                }
+                slot_iterator &operator++()
+                {
+                    ++current;
+                    skip_empty();
+                    return *this;
+                }
+                slot_iterator operator++(int)
+                {
+                    slot_iterator tmp = *this;
+                    ++*this;
+                    return tmp;
+                }
+                friend bool operator==(slot_iterator const &A, slot_iterator const &B)
+                {
+                    return A.current == B.current;
+                }
+                friend bool operator!=(slot_iterator const &A, slot_iterator const &B)
+                {
+                    return A.current != B.current;
+                }
+
+            private:
+                void skip_empty()
+                {
+                    while (current != last && current->value.first == 0)
+                        ++current;
+                }
+            };
+
+        public:
+            typedef slot_iterator<slot, value_type> iterator;
+            typedef slot_iterator<const slot, const value_type> const_iterator;
 
         private:
-            implementation impl;
+            allocator_type alloc;
+            Pred pred;
+            slot *slots;
+            size_t capacity;            ///< always zero or a power of two
+            size_t count;
 
         public:
-            map()
+            map() : slots(0), capacity(0), count(0)
+            {
+            }
+            map(allocator_type a)
+                : alloc(a), slots(0), capacity(0), count(0)
             {
             }
-            map(allocator_type a) 
-                : impl(a)
+
+            map(map const &) = delete;
+            map &operator=(map const &) = delete;
+
+            ~map()
             {
+                clear();
+                release_slots(slots, capacity);
             }
 
             /* purposefully elided
@@ -56,33 +156,40 @@ namespace boost
             struct value_adder
             {
                 this_type *parent;
-                base_type *key_instance;
+                abstract_base_type *key_instance;
 
-                value_adder(this_type &P, base_type &K) 
+                value_adder(this_type &P, abstract_base_type &K)
                     : parent(&P), key_instance(&K) { }
 
+                this_type &add(abstract_base_type *val)
+                {
+                    if (!parent->insert(std::make_pair(key_instance, val)).second)
+                    {
+                        allocator::deallocate_clone(key_instance);
+                        allocator::deallocate_clone(val);
+                    }
+                    return *parent;
+                }
+
                 template <class U>
                 this_type &value()
                 {
-                    base_type *val = detail::construct<U,base_type>(parent->get_allocator()).to_base();
-                    parent->insert(std::make_pair(key_instance, val));
-                    return *parent;
+                    abstract_base_type *val = detail::construct<U,base_type>(parent->get_allocator()).to_abstract();
+                    return add(val);
                 }
 
                 // TODO: use variadic arguments or BOOST_PP to pass ctor args
                 template <class U, class A0>
                 this_type &value(A0 a0)
                 {
-                    base_type *val = detail::construct<U,base_type>(parent->get_allocator(), a0).to_base();
-                    parent->insert(std::make_pair(key_instance, val));
-                    return *parent;
+                    abstract_base_type *val = detail::construct<U,base_type>(parent->get_allocator(), a0).to_abstract();
+                    return add(val);
                 }
                 template <class U, class A0, class A1>
                 this_type &value(A0 a0, A1 a1)
                 {
-                    base_type *val = detail::construct<U,base_type>(parent->get_allocator(), a0, a1).to_base();
-                    parent->insert(std::make_pair(key_instance, val));
-                    return *parent;
+                    abstract_base_type *val = detail::construct<U,base_type>(parent->get_allocator(), a0, a1).to_abstract();
+                    return add(val);
                 }
             };
 
@@ -90,7 +197,8 @@ namespace boost
             template <class U>
             value_adder key()
             {
-                base_type *key_instance = detail::construct<U,base_type>(get_allocator()).to_base();
+                static_assert(has_hash_value<U>::value, "heterogenous::map keys must override hash_value");
+                abstract_base_type *key_instance = detail::construct<U,base_type>(get_allocator()).to_abstract();
                 return value_adder(*this, *key_instance);
             }
 
@@ -98,35 +206,80 @@ namespace boost
             template <class U, class A0>
             value_adder key(A0 a0)
             {
-                base_type *key_instance = detail::construct<U,base_type>(get_allocator(), a0).to_base();
+                static_assert(has_hash_value<U>::value, "heterogenous::map keys must override hash_value");
+                abstract_base_type *key_instance = detail::construct<U,base_type>(get_allocator(), a0).to_abstract();
                 return value_adder(*this, *key_instance);
             }
             template <class U, class A0, class A1>
             value_adder key(A0 a0, A1 a1)
             {
-                base_type *key_instance = detail::construct<U,base_type>(get_allocator(), a0, a1).to_base();
+                static_assert(has_hash_value<U>::value, "heterogenous::map keys must override hash_value");
+                abstract_base_type *key_instance = detail::construct<U,base_type>(get_allocator(), a0, a1).to_abstract();
                 return value_adder(*this, *key_instance);
             }
             template <class U, class A0, class A1, class A2>
             value_adder key(A0 a0, A1 a1, A2 a2)
             {
-                base_type *key_instance = detail::construct<U,base_type>(get_allocator(), a0, a1, a2).to_base();
+                static_assert(has_hash_value<U>::value, "heterogenous::map keys must override hash_value");
+                abstract_base_type *key_instance = detail::construct<U,base_type>(get_allocator(), a0, a1, a2).to_abstract();
                 return value_adder(*this, *key_instance);
             }
 
-            // TODO: make this private
-            void insert(value_type x)
+            /// add a key/value pair, taking ownership of both. if an equal key is already
+            /// present, the map is unchanged, the result is false, and the caller keeps
+            /// ownership of x
+            std::pair<iterator, bool> insert(value_type x)
             {
-                impl.insert(x);
+                size_t hash = x.first->hash_value();
+                size_t index = capacity == 0 ? 0 : probe(*x.first, hash);
+                if (capacity != 0 && slots[index].value.first != 0)
+                    return std::make_pair(make_iterator(index), false);
+                // only a new key grows the table, after which its slot is found again
+                if (2*(count + 1) > capacity)
+                {
+                    rehash((std::max)(size_t(8), 2*capacity));
+                    index = probe(*x.first, hash);
+                }
+                slot &found = slots[index];
+                found.hash = hash;
+                found.value = x;
+                ++count;
+                return std::make_pair(make_iterator(index), true);
+            }
+
+            /// make room for at least num entries without growing the table
+            void reserve(size_t num)
+            {
+                size_t required = 8;
+                while (required < 2*num)
+                    required *= 2;
+                if (required > capacity)
+                    rehash(required);
+            }
+
+            /// destroy all keys and values
+            void clear()
+            {
+                for (size_t n = 0; n < capacity; ++n)
+                {
+                    value_type &value = slots[n].value;
+                    if (value.first == 0)
+                        continue;
+                    allocator::deallocate_clone(value.first);
+                    allocator::deallocate_clone(value.second);
+                    value.first = value.second = 0;
+                }
+                count = 0;
             }
 
             template <class Fun>
             Fun for_each(Fun fun)
             {
-                BOOST_FOREACH(value_type &value, *this)
+                for (iterator iter = begin(); iter != end(); ++iter)
                 {
-                    fun(value);
+                    fun(*iter);
                 }
+                return fun;
             }
 
             template <class Ty, class Fun>
@@ -157,33 +310,46 @@ namespace boost
 
             size_t size() const
             {
-                return impl.size();
+                return count;
             }
             bool empty() const
             {
-                return impl.empty();
+                return count == 0;
             }
 
             iterator begin()
             {
-                return impl.begin();
+                return iterator(slots, slots + capacity);
             }
             iterator end()
             {
-                return impl.end();
+                return iterator(slots + capacity, slots + capacity);
             }
             const_iterator begin() const
             {
-                return impl.begin();
+                return const_iterator(slots, slots + capacity);
             }
             const_iterator end() const
             {
-                return impl.end();
+                return const_iterator(slots + capacity, slots + capacity);
             }
 
-            iterator find(key_type const &key)
+            template <class K>
+            iterator find(K const &key)
+            {
+                static_assert(has_hash_value<K>::value, "heterogenous::map keys must override hash_value");
+                abstract_base_type const &base = key;
+                if (count == 0)
+                    return end();
+                size_t index = probe(base, base.hash_value());
+                if (slots[index].value.first == 0)
+                    return end();
+                return make_iterator(index);
+            }
+            template <class K>
+            const_iterator find(K const &key) const
             {
-                return impl.find(key);
+                return const_cast<this_type &>(*this).find(key);
             }
 
             //reference operator[](key_type const &key)
@@ -195,17 +361,81 @@ namespace boost
             //    return impl[n];
             //}
 
-            typename implementation::allocator_type get_allocator()
+            allocator_type get_allocator() const
+            {
+                return alloc;
+            }
+
+        private:
+            iterator make_iterator(size_t index)
             {
-                return impl.get_allocator();
+                return iterator(slots + index, slots + capacity);
+            }
+
+            static size_t mix(size_t hash)
+            {
+                // spread the bits of poor hashes, such as small integers, over the low bits
+                hash ^= hash >> 17;
+                hash *= size_t(0x9E3779B97F4A7C15ull);
+                return hash ^ (hash >> 29);
+            }
+
+            /// the index of the slot holding key, or of the empty slot where it would go
+            size_t probe(abstract_base_type const &key, size_t hash) const
+            {
+                size_t mask = capacity - 1;
+                for (size_t index = mix(hash) & mask; ; index = (index + 1) & mask)
+                {
+                    slot const &S = slots[index];
+                    if (S.value.first == 0)
+                        return index;
+                    if (S.hash == hash && equal(*S.value.first, key))
+                        return index;
+                }
+            }
+
+            bool equal(abstract_base_type const &A, abstract_base_type const &B) const
+            {
+                base_type const &a = static_cast<base_type const &>(A);
+                base_type const &b = static_cast<base_type const &>(B);
+                return !pred(a, b) && !pred(b, a);
+            }
+
+            void rehash(size_t new_capacity)
+            {
+                slot_allocator al(alloc);
+                slot *new_slots = al.allocate(new_capacity);
+                std::fill_n(new_slots, new_capacity, slot());
+                size_t mask = new_capacity - 1;
+                for (size_t n = 0; n < capacity; ++n)
+                {
+                    slot const &S = slots[n];
+                    if (S.value.first == 0)
+                        continue;
+                    size_t index = mix(S.hash) & mask;
+                    while (new_slots[index].value.first != 0)
+                        index = (index + 1) & mask;
+                    new_slots[index] = S;
+                }
+                release_slots(slots, capacity);
+                slots = new_slots;
+                capacity = new_capacity;
+            }
+
+            void release_slots(slot *ptr, size_t num)
+            {
+                if (ptr == 0)
+                    return;
+                slot_allocator al(alloc);
+                al.deallocate(ptr, num);
             }
         };
-    
+
     } // namespace heterogenous
 
 } // namespace boost
 
-#include <boost/heterogenous/detail/suffix.hpp>
+#include <monotonic/heterogenous/detail/suffix.hpp>
 
 #endif // BOOST_HETEROGENOUS_MAP_HPP
 
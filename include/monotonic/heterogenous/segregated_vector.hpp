@@ -0,0 +1,369 @@
+// Copyright (C) 2009-2020 Christian@Schladetsch.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_HETEROGENOUS_SEGREGATED_VECTOR_HPP
+#define BOOST_HETEROGENOUS_SEGREGATED_VECTOR_HPP
+
+#include <algorithm>
+#include <vector>
+#include <memory>
+#include <iterator>
+#include <typeinfo>
+#include <stdexcept>
+#include <type_traits>
+#include <monotonic/heterogenous/detail/prefix.hpp>
+#include <monotonic/heterogenous/forward_declarations.hpp>
+
+namespace boost
+{
+    namespace heterogenous
+    {
+        namespace detail
+        {
+            /// identifies a type without using RTTI: the address of a static
+            /// that is unique to each type
+            typedef const char *type_id;
+
+            template <class T>
+            struct type_number
+            {
+                static const char tag;
+            };
+
+            template <class T>
+            const char type_number<T>::tag = 0;
+
+            template <class T>
+            type_id get_type_id()
+            {
+                return &type_number<T>::tag;
+            }
+
+        } // namespace detail
+
+        /// a vector of heterogenous objects that stores each derived type in its
+        /// own contiguous bucket, allocated from Alloc.
+        ///
+        /// for_each<Ty> is a linear scan over a Ty[], with no casts and no pointer
+        /// chasing. note that it visits objects of exactly type Ty, and not types
+        /// derived from Ty. the order of insertion is also kept, so the objects can
+        /// still be visited as a sequence of Base.
+        ///
+        /// buckets grow like std::vector; when using monotonic storage, use
+        /// reserve<Ty> to avoid abandoning the smaller buffers as a bucket grows.
+        template <class Base, class Alloc>
+        struct segregated_vector
+        {
+            typedef Base base_type;
+            typedef Alloc allocator_type;
+            typedef Base value_type;
+            typedef Base &reference;
+            typedef const Base &const_reference;
+            typedef segregated_vector<Base, Alloc> this_type;
+
+        private:
+            template <class T>
+            struct rebind
+            {
+                typedef typename std::allocator_traits<Alloc>::template rebind_alloc<T> type;
+            };
+
+            struct bucket_base
+            {
+                detail::type_id type;
+
+                bucket_base(detail::type_id T) : type(T) { }
+
+                virtual base_type &at(size_t n) = 0;
+                virtual void clear() = 0;
+                virtual void destroy(Alloc &alloc) = 0;
+            };
+
+            template <class Ty>
+            struct bucket : bucket_base
+            {
+                typedef std::vector<Ty, typename rebind<Ty>::type> values_type;
+                values_type values;
+
+                bucket(Alloc const &alloc)
+                    : bucket_base(detail::get_type_id<Ty>()), values(typename rebind<Ty>::type(alloc)) { }
+
+                base_type &at(size_t n)
+                {
+                    return values[n];
+                }
+                void clear()
+                {
+                    values.clear();
+                }
+                void destroy(Alloc &alloc)
+                {
+                    typename rebind<bucket>::type al(alloc);
+                    this->~bucket();
+                    al.deallocate(this, 1);
+                }
+            };
+
+            /// position of an object, in order of insertion
+            struct element
+            {
+                size_t bucket_index;
+                size_t offset;
+            };
+
+            typedef std::vector<bucket_base *, typename rebind<bucket_base *>::type> buckets_type;
+            typedef std::vector<element, typename rebind<element>::type> order_type;
+
+            template <class Parent, class Value>
+            struct ordered_iterator
+            {
+                typedef std::forward_iterator_tag iterator_category;
+                typedef Base value_type;
+                typedef ptrdiff_t difference_type;
+                typedef Value *pointer;
+                typedef Value &reference;
+
+                Parent *parent;
+                size_t index;
+
+                ordered_iterator(Parent *P = 0, size_t N = 0) : parent(P), index(N) { }
+
+                reference operator*() const
+                {
+                    return (*parent)[index];
+                }
+                pointer operator->() const
+                {
+                    return &(*parent)[index];
+                }
+                ordered_iterator &operator++()
+                {
+                    ++index;
+                    return *this;
+                }
+                ordered_iterator operator++(int)
+                {
+                    ordered_iterator tmp = *this;
+                    ++index;
+                    return tmp;
+                }
+                friend bool operator==(ordered_iterator const &A, ordered_iterator const &B)
+                {
+                    return A.index == B.index && A.parent == B.parent;
+                }
+                friend bool operator!=(ordered_iterator const &A, ordered_iterator const &B)
+                {
+                    return !(A == B);
+                }
+            };
+
+        public:
+            typedef ordered_iterator<this_type, Base> iterator;
+            typedef ordered_iterator<const this_type, const Base> const_iterator;
+
+        private:
+            Alloc alloc;
+            buckets_type buckets;
+            order_type order;
+
+        public:
+            segregated_vector()
+                : buckets(typename rebind<bucket_base *>::type(alloc)), order(typename rebind<element>::type(alloc))
+            {
+            }
+
+            segregated_vector(allocator_type const &a)
+                : alloc(a), buckets(typename rebind<bucket_base *>::type(a)), order(typename rebind<element>::type(a))
+            {
+            }
+
+            segregated_vector(segregated_vector const &) = delete;
+            segregated_vector &operator=(segregated_vector const &) = delete;
+
+            ~segregated_vector()
+            {
+                for (typename buckets_type::reverse_iterator B = buckets.rbegin(); B != buckets.rend(); ++B)
+                    (*B)->destroy(alloc);
+            }
+
+            /// make a new object of type Ty at the end of the sequence
+            template <class Ty, class... Args>
+            Ty &emplace_back(Args&&... args)
+            {
+                static_assert(std::is_base_of<Base, Ty>::value, "type must derive from base_type");
+                size_t index = 0;
+                typename bucket<Ty>::values_type &values = get_bucket<Ty>(index).values;
+                values.emplace_back(std::forward<Args>(args)...);
+                element elem = { index, values.size() - 1 };
+                order.push_back(elem);
+                return values.back();
+            }
+
+            /// reserve space for at least num objects of type Ty
+            template <class Ty>
+            void reserve(size_t num)
+            {
+                size_t index = 0;
+                get_bucket<Ty>(index).values.reserve(num);
+            }
+
+            /// call fun for each object of type Ty, in order of insertion
+            template <class Ty, class Fun>
+            Fun for_each(Fun fun)
+            {
+                if (bucket<Ty> *B = find_bucket<Ty>())
+                {
+                    Ty *ptr = B->values.data();
+                    for (Ty *end = ptr + B->values.size(); ptr != end; ++ptr)
+                        fun(*ptr);
+                }
+                return fun;
+            }
+
+            template <class Ty, class Fun>
+            Fun for_each(Fun fun) const
+            {
+                if (bucket<Ty> const *B = find_bucket<Ty>())
+                {
+                    Ty const *ptr = B->values.data();
+                    for (Ty const *end = ptr + B->values.size(); ptr != end; ++ptr)
+                        fun(*ptr);
+                }
+                return fun;
+            }
+
+            /// the number of objects of exactly type Ty
+            template <class Ty>
+            size_t count() const
+            {
+                bucket<Ty> const *B = find_bucket<Ty>();
+                return B ? B->values.size() : 0;
+            }
+
+            size_t size() const
+            {
+                return order.size();
+            }
+            bool empty() const
+            {
+                return order.empty();
+            }
+
+            /// remove all objects. the buckets are kept for re-use
+            void clear()
+            {
+                for (typename buckets_type::iterator B = buckets.begin(); B != buckets.end(); ++B)
+                    (*B)->clear();
+                order.clear();
+            }
+
+            iterator begin()
+            {
+                return iterator(this, 0);
+            }
+            iterator end()
+            {
+                return iterator(this, size());
+            }
+            const_iterator begin() const
+            {
+                return const_iterator(this, 0);
+            }
+            const_iterator end() const
+            {
+                return const_iterator(this, size());
+            }
+
+            reference operator[](size_t n)
+            {
+                element const &elem = order[n];
+                return buckets[elem.bucket_index]->at(elem.offset);
+            }
+            const_reference operator[](size_t n) const
+            {
+                element const &elem = order[n];
+                return buckets[elem.bucket_index]->at(elem.offset);
+            }
+            reference at(size_t n)
+            {
+                if (n >= size())
+                    throw std::out_of_range("segregated_vector");
+                return (*this)[n];
+            }
+            const_reference at(size_t n) const
+            {
+                if (n >= size())
+                    throw std::out_of_range("segregated_vector");
+                return (*this)[n];
+            }
+
+            template <class Other>
+            bool is_type_at(size_t n) const
+            {
+                return buckets[order.at(n).bucket_index]->type == detail::get_type_id<Other>();
+            }
+
+            template <class Other>
+            Other &ref_at(size_t n)
+            {
+                if (!is_type_at<Other>(n))
+                    throw std::bad_cast();
+                element const &elem = order[n];
+                return static_cast<bucket<Other> *>(buckets[elem.bucket_index])->values[elem.offset];
+            }
+            template <class Other>
+            const Other &ref_at(size_t n) const
+            {
+                return const_cast<this_type &>(*this).template ref_at<Other>(n);
+            }
+
+            allocator_type get_allocator() const
+            {
+                return alloc;
+            }
+
+        private:
+            template <class Ty>
+            bucket<Ty> *find_bucket() const
+            {
+                detail::type_id type = detail::get_type_id<Ty>();
+                for (typename buckets_type::const_iterator B = buckets.begin(); B != buckets.end(); ++B)
+                {
+                    if ((*B)->type == type)
+                        return static_cast<bucket<Ty> *>(*B);
+                }
+                return 0;
+            }
+
+            template <class Ty>
+            bucket<Ty> &get_bucket(size_t &index)
+            {
+                detail::type_id type = detail::get_type_id<Ty>();
+                for (index = 0; index < buckets.size(); ++index)
+                {
+                    if (buckets[index]->type == type)
+                        return *static_cast<bucket<Ty> *>(buckets[index]);
+                }
+                // make room first, so push_back cannot throw once the bucket is made.
+                // grow geometrically, as each old array is abandoned in monotonic storage
+                if (buckets.size() == buckets.capacity())
+                    buckets.reserve((std::max)(size_t(4), 2*buckets.capacity()));
+                typename rebind<bucket<Ty> >::type al(alloc);
+                bucket<Ty> *B = al.allocate(1);
+                new (B) bucket<Ty>(alloc);
+                buckets.push_back(B);
+                return *B;
+            }
+        };
+
+    } // namespace heterogenous
+
+} // namespace boost
+
+#include <monotonic/heterogenous/detail/suffix.hpp>
+
+#endif // BOOST_HETEROGENOUS_SEGREGATED_VECTOR_HPP
+
+//EOF
@@ -7,19 +7,18 @@
 #define BOOST_HETEROGENOUS_VECTOR_HPP
 
 #include <boost/ptr_container/ptr_vector.hpp>
-#include <boost/monotonic/allocator.hpp>
+#include <monotonic/allocator.hpp>
 #include <boost/foreach.hpp>
+#include <algorithm>
 
-#include <boost/cloneable/cloneable.hpp>
-#include <boost/cloneable/detail/make_clone_allocator.hpp>
-#include <boost/cloneable/detail/allocation.hpp>
+#include <monotonic/heterogenous/cloneable.hpp>
+#include <monotonic/heterogenous/make_clone_allocator.hpp>
+#include <monotonic/heterogenous/detail/allocation.hpp>
 
 namespace boost 
 {
     namespace heterogenous
     {
-        using namespace cloneable;
-
         /// a vector of heterogenous objects
         template <class Base, class Alloc>//, class AbstractBase>
         struct vector
@@ -28,7 +27,7 @@ namespace boost
             //typedef AbstractBase abstract_base_type;
             typedef abstract_cloneable<Base> abstract_base_type;
             typedef typename make_clone_allocator<Alloc>::type allocator_type;
-            typedef ptr_vector<abstract_base_type, allocator, allocator_type> implementation;
+            typedef ptr_vector<abstract_base_type, allocator, typename allocator_type::template rebind<void *>::other> implementation;
             //typedef ptr_vector<Base, allocator, allocator_type> implementation;
             typedef typename implementation::value_type value_type;
             typedef typename implementation::reference reference;
@@ -81,6 +80,36 @@ namespace boost
                 return fun;
             }
 
+            /// copy every object into one contiguous block allocated from the given
+            /// storage, and append the copies to dest.
+            ///
+            /// this makes one allocation rather than one per object. copies are made
+            /// with the copy-constructor of each derived type, not make_copy.
+            void clone_into(vector &dest, monotonic::storage_base &storage) const
+            {
+                if (impl.empty())
+                    return;
+                size_t num_bytes = 0;
+                size_t max_alignment = 1;
+                BOOST_FOREACH(const abstract_base_type &base, impl)
+                {
+                    size_t alignment = base.align_of();
+                    num_bytes = align_up(num_bytes, alignment) + base.size_of();
+                    max_alignment = (std::max)(max_alignment, alignment);
+                }
+                char *block = reinterpret_cast<char *>(storage.allocate(num_bytes, max_alignment));
+                if (block == 0)
+                    throw std::bad_alloc();
+                dest.impl.reserve(dest.impl.size() + impl.size());
+                size_t offset = 0;
+                BOOST_FOREACH(const abstract_base_type &base, impl)
+                {
+                    offset = align_up(offset, base.align_of());
+                    dest.impl.push_back(base.copy_construct_at(block + offset));
+                    offset += base.size_of();
+                }
+            }
+
             size_t size() const
             {
                 return impl.size();
@@ -201,13 +230,19 @@ namespace boost
             {
                 return impl.get_allocator();
             }
+
+        private:
+            static size_t align_up(size_t offset, size_t alignment)
+            {
+                return (offset + alignment - 1) & ~(alignment - 1);
+            }
         };
     
     } // namespace heterogenous
 
 } // namespace boost
 
-#include <boost/heterogenous/detail/suffix.hpp>
+#include <monotonic/heterogenous/detail/suffix.hpp>
 
 #endif // BOOST_HETEROGENOUS_VECTOR_HPP
 
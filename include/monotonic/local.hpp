@@ -42,10 +42,11 @@ namespace boost
                 reset();
             }
 
+            /// an allocator bound directly to the storage of this region
             template <class T>
             static monotonic::allocator<T,Region,Access> make_allocator()
             {
-                return monotonic::allocator<T,Region,Access>();
+                return monotonic::allocator<T,Region,Access>(get_storage());
             }
 
             static typename StaticStorage::StorageType &get_storage()
@@ -9,14 +9,23 @@
 
 #ifdef BOOST_MONOTONIC_THREADS
 #    include <monotonic/shared_allocator.hpp>
+#    include <monotonic/thread_local_storage.hpp>
 //TODO #    include <monotonic/thread_local_allocator.hpp>
 #endif
 
+#include <monotonic/arena_allocator.hpp>
 #include <monotonic/containers/string.hpp>
 #include <monotonic/containers/vector.hpp>
+#include <monotonic/containers/small_vector.hpp>
+#include <monotonic/containers/dynamic_bitset.hpp>
 #include <monotonic/containers/list.hpp>
+#include <monotonic/containers/slist.hpp>
+#include <monotonic/containers/ilist.hpp>
+#include <monotonic/containers/unrolled_list.hpp>
 #include <monotonic/containers/set.hpp>
 #include <monotonic/containers/map.hpp>
+#include <monotonic/containers/btree_map.hpp>
+#include <monotonic/containers/btree_set.hpp>
 #include <monotonic/containers/deque.hpp>
 #include <monotonic/containers/chain.hpp>
 
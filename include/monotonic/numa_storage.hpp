@@ -0,0 +1,240 @@
+// Copyright (C) 2009-2020 Christian@Schladetsch.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MONOTONIC_NUMA_STORAGE_HPP
+#define BOOST_MONOTONIC_NUMA_STORAGE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+#include <monotonic/detail/prefix.hpp>
+#include <monotonic/forward_declarations.hpp>
+#include <monotonic/storage_base.hpp>
+#include <monotonic/detail/link.hpp>
+#include <monotonic/detail/numa.hpp>
+
+namespace boost
+{
+    namespace monotonic
+    {
+        /// thread-safe storage that keeps a chain of links for each NUMA node, and gives
+        /// each thread memory from the links of the node it runs on, so that the memory
+        /// is local to it. the links of a node are bound to it with mbind.
+        ///
+        /// an arena used by threads on one node can be pinned to it, so that allocations
+        /// come from that node whichever thread makes them. where there is one node, or
+        /// the machine is not linux, there is one chain and nothing is bound.
+        template <size_t MinHeapIncrement>
+        struct numa_storage : storage_base
+        {
+            typedef detail::Link<detail::numa_node_allocator> Link;
+
+        private:
+            /// the links of one node. each is locked on its own, so that threads on
+            /// different nodes do not contend. as in storage<>, the links are kept as a
+            /// heap on their remaining space, so a request that does not fit the link at
+            /// the front does not leave the room in the others unused
+            struct alignas(DefaultSizes::CacheLineSize) node_chain
+            {
+                mutable std::mutex guard;
+                std::vector<Link> links;
+            };
+
+            std::vector<std::unique_ptr<node_chain> > nodes;
+            std::atomic<int> pinned;
+
+        public:
+            numa_storage() : pinned(-1)
+            {
+                for (int node = 0; node < detail::numa_nodes(); ++node)
+                    nodes.push_back(std::unique_ptr<node_chain>(new node_chain()));
+            }
+
+            ~numa_storage()
+            {
+                release();
+            }
+
+            numa_storage(numa_storage const &) = delete;
+            numa_storage &operator=(numa_storage const &) = delete;
+
+            /// the number of nodes, which is 1 where it cannot be known
+            static int num_nodes()
+            {
+                return detail::numa_nodes();
+            }
+
+            /// the node the calling thread runs on
+            static int current_node()
+            {
+                return detail::numa_current_node();
+            }
+
+            /// the node that holds the memory at ptr, or -1 if it cannot be known
+            static int node_of(const void *ptr)
+            {
+                return detail::numa_node_of(ptr);
+            }
+
+            /// make all allocations from the given node, whichever thread asks
+            void pin(int node)
+            {
+                if (node < 0 || node >= int(nodes.size()))
+                    throw std::out_of_range("numa_storage::pin");
+                pinned = node;
+            }
+
+            /// go back to allocating from the node of the calling thread
+            void unpin()
+            {
+                pinned = -1;
+            }
+
+            /// the node allocations are pinned to, or -1
+            int get_pinned() const
+            {
+                return pinned;
+            }
+
+            /// the node that allocations by the calling thread come from
+            int home_node() const
+            {
+                int node = pinned;
+                if (node >= 0)
+                    return node;
+                if (nodes.size() == 1)
+                    return 0;
+                return (std::min)(calling_node(), int(nodes.size()) - 1);
+            }
+
+            void reset()
+            {
+                for (auto &chain : nodes)
+                {
+                    std::lock_guard<std::mutex> lock(chain->guard);
+                    for (Link &link : chain->links)
+                        link.reset();
+                }
+            }
+
+            void release()
+            {
+                for (auto &chain : nodes)
+                {
+                    std::lock_guard<std::mutex> lock(chain->guard);
+                    for (Link &link : chain->links)
+                        link.release();
+                    chain->links.clear();
+                }
+            }
+
+            using storage_base::allocate;
+
+            void *allocate(size_t num_bytes, size_t alignment)
+            {
+                int node = home_node();
+                node_chain &chain = *nodes[node];
+                std::lock_guard<std::mutex> lock(chain.guard);
+                if (!chain.links.empty())
+                {
+                    if (void *ptr = chain.links.front().allocate(num_bytes, alignment))
+                        return ptr;
+                    std::make_heap(chain.links.begin(), chain.links.end());
+                    if (void *ptr = chain.links.front().allocate(num_bytes, alignment))
+                        return ptr;
+                }
+                // room for this and another like it, with their padding and red zones
+                size_t size = (std::max)(size_t(MinHeapIncrement), (num_bytes + alignment + detail::red_zone)*2);
+                chain.links.push_back(Link(detail::numa_node_allocator(node), size));
+                std::make_heap(chain.links.begin(), chain.links.end());
+                void *ptr = chain.links.front().allocate(num_bytes, alignment);
+                if (ptr == 0)
+                    throw std::bad_alloc();
+                return ptr;
+            }
+
+            void deallocate(void *)
+            {
+            }
+
+            /// only the most recent allocation on the node of the calling thread can grow
+            bool extend(void *ptr, size_t num_bytes, size_t new_num_bytes)
+            {
+                node_chain &chain = *nodes[home_node()];
+                std::lock_guard<std::mutex> lock(chain.guard);
+                return !chain.links.empty() && chain.links.front().extend(ptr, num_bytes, new_num_bytes);
+            }
+
+            size_t max_size() const
+            {
+                return (std::numeric_limits<size_t>::max)();
+            }
+
+            size_t remaining() const
+            {
+                return max_size();
+            }
+
+            size_t used() const
+            {
+                size_t total = 0;
+                for (int node = 0; node < int(nodes.size()); ++node)
+                    total += used(node);
+                return total;
+            }
+
+            /// the bytes used on one node
+            size_t used(int node) const
+            {
+                node_chain const &chain = *nodes[node];
+                std::lock_guard<std::mutex> lock(chain.guard);
+                size_t total = 0;
+                for (Link const &link : chain.links)
+                    total += link.used();
+                return total;
+            }
+
+            /// the bytes held in links on one node
+            size_t reserved(int node) const
+            {
+                node_chain const &chain = *nodes[node];
+                std::lock_guard<std::mutex> lock(chain.guard);
+                size_t total = 0;
+                for (Link const &link : chain.links)
+                    total += link.max_size();
+                return total;
+            }
+
+        private:
+            /// asking the kernel costs a system call, so a thread asks again only every
+            /// so often, in case it has been moved to another node
+            static int calling_node()
+            {
+                thread_local int node = 0;
+                thread_local unsigned countdown = 0;
+                if (countdown-- == 0)
+                {
+                    node = detail::numa_current_node();
+                    countdown = 255;
+                }
+                return node;
+            }
+        };
+
+    } // namespace monotonic
+
+} // namespace boost
+
+#include <monotonic/detail/postfix.hpp>
+
+#endif // BOOST_MONOTONIC_NUMA_STORAGE_HPP
+
+//EOF
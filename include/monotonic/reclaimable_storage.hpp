@@ -6,11 +6,17 @@
 #pragma once
 
 #include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <type_traits>
 
 #include <unordered_set>
+#include <boost/assert.hpp>
 
 #include <monotonic/detail/prefix.hpp>
 #include <monotonic/forward_declarations.hpp>
+#include <monotonic/storage_base.hpp>
 
 namespace boost
 {
@@ -39,7 +45,7 @@ namespace boost
         {
             typedef reclaimable_storage<InlineSize, MinHeapIncrement, Al> This;
             typedef Al Allocator;
-            typedef typename Allocator::template rebind<char>::other CharAllocator;
+            typedef typename std::allocator_traits<Allocator>::template rebind_alloc<char> CharAllocator;
 
             /* this has to go to an allocator
             struct AllocationBase
@@ -100,8 +106,19 @@ namespace boost
         private:
             CharAllocator alloc;
 
+            /// kept just before each allocation, so that deallocate can give back what was
+            /// allocated for it without a table, which would need a lock and a search
+            struct block_header
+            {
+                char *raw;
+                size_t num_bytes;
+            };
+
+            /// the header, padded so that the allocation after it is aligned to max_align_t
+            static constexpr size_t header_size = (sizeof(block_header) + alignof(std::max_align_t) - 1)/alignof(std::max_align_t)*alignof(std::max_align_t);
+
         public:
-            reclaimable_storage()
+            BOOST_MONOTONIC_CONSTEXPR_STORAGE reclaimable_storage()
             {
             }
             reclaimable_storage(Allocator const &A)
@@ -121,14 +138,29 @@ namespace boost
             {
             }
 
-            void *allocate(size_t num_bytes, size_t /*alignment*/ = 1)
+            using storage_base::allocate;
+
+            /// the allocator aligns no further than max_align_t, so larger alignments are
+            /// padded for and made here
+            void *allocate(size_t num_bytes, size_t alignment = 1)
             {
-                return alloc.allocate(num_bytes);
+                size_t extra = alignment > alignof(std::max_align_t) ? alignment - alignof(std::max_align_t) : 0;
+                block_header header;
+                header.num_bytes = header_size + num_bytes + extra;
+                header.raw = alloc.allocate(header.num_bytes);
+                char *ptr = header.raw + header_size;
+                if (extra)
+                    ptr += (alignment - reinterpret_cast<size_t>(ptr) % alignment) % alignment;
+                new (ptr - header_size) block_header(header);
+                return ptr;
             }
 
             void deallocate(void *ptr)
             {
-                alloc.deallocate((char *)ptr, 1);
+                if (ptr == 0)
+                    return;
+                block_header header = *reinterpret_cast<block_header *>(static_cast<char *>(ptr) - header_size);
+                alloc.deallocate(header.raw, header.num_bytes);
             }
 
             size_t max_size() const
@@ -159,18 +191,18 @@ namespace boost
             Ty &create()
             {
                 Ty *ptr = uninitialised_create<Ty>();
-                construct(ptr, boost::is_pod<Ty>());
+                construct(ptr, std::is_pod<Ty>());
                 return *ptr;
             }
 
             template <class Ty>
-            void construct(Ty *ptr, const boost::true_type& /*is_pod*/)
+            void construct(Ty *ptr, const std::true_type& /*is_pod*/)
             {
                 // do nothing
             }
 
             template <class Ty>
-            void construct(Ty *ptr, const boost::false_type&)
+            void construct(Ty *ptr, const std::false_type&)
             {
                 new (ptr) Ty();
             }
@@ -199,7 +231,7 @@ namespace boost
             template <size_t N>
             char *allocate_bytes()
             {
-                return allocate_bytes(N, boost::aligned_storage<N>::alignment);
+                return allocate_bytes(N, alignof(typename std::aligned_storage<N>::type));
             }
 
             char *allocate_bytes(size_t num_bytes, size_t alignment = 1)
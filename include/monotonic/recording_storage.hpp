@@ -0,0 +1,276 @@
+// Copyright (C) 2009-2020 Christian@Schladetsch.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MONOTONIC_RECORDING_STORAGE_HPP
+#define BOOST_MONOTONIC_RECORDING_STORAGE_HPP
+
+#include <cstdint>
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <mutex>
+#include <thread>
+#include <monotonic/detail/prefix.hpp>
+#include <monotonic/storage_base.hpp>
+
+namespace boost
+{
+    namespace monotonic
+    {
+        /// what happened in one event of an allocation trace
+        enum trace_op
+        {
+            trace_allocate,         ///< `size` bytes aligned to `alignment` were allocated as `id`
+            trace_deallocate,       ///< `id` was deallocated
+            trace_extend,           ///< `id` was extended in place to `size` bytes
+            trace_reset,            ///< the storage was reset, ending all allocations
+            trace_release,          ///< the storage was released, ending all allocations
+        };
+
+        /// one event of an allocation trace. allocations are numbered from zero in the
+        /// order they were made, and threads in the order they were first seen
+        struct trace_event
+        {
+            trace_op op;
+            std::uint32_t thread;
+            std::uint64_t id;
+            std::uint64_t size;
+            std::uint32_t alignment;
+        };
+
+        namespace detail
+        {
+            /// a trace starts with these bytes, the last of which is the version
+            static const char trace_magic[8] = { 'M', 'O', 'N', 'O', 'T', 'R', 'C', 1 };
+
+            /// unsigned values are written in 7-bit groups, least significant first, with
+            /// the top bit of each byte set if more follow
+            inline void write_varint(std::ostream &out, std::uint64_t value)
+            {
+                char bytes[10];
+                size_t len = 0;
+                do
+                {
+                    bytes[len] = char(value & 0x7f);
+                    value >>= 7;
+                    if (value)
+                        bytes[len] |= char(0x80);
+                    ++len;
+                }
+                while (value);
+                out.write(bytes, len);
+            }
+
+            /// returns false at the end of the stream
+            inline bool read_varint(std::istream &in, std::uint64_t &value)
+            {
+                value = 0;
+                for (int shift = 0; shift < 64; shift += 7)
+                {
+                    int ch = in.get();
+                    if (ch == std::char_traits<char>::eof())
+                        return false;
+                    value |= std::uint64_t(ch & 0x7f) << shift;
+                    if ((ch & 0x80) == 0)
+                        return true;
+                }
+                throw std::runtime_error("trace: bad number");
+            }
+
+            inline std::uint32_t log2(size_t alignment)
+            {
+                std::uint32_t bits = 0;
+                while (alignment > 1)
+                {
+                    alignment >>= 1;
+                    ++bits;
+                }
+                return bits;
+            }
+        }
+
+        /// storage that passes every request to another storage, and writes what was
+        /// done to a stream as a compact binary trace. read_trace() reads it back.
+        ///
+        /// each event is a byte for the operation, then the thread, the allocation and
+        /// the size as variable-length numbers, and the alignment as a power of two,
+        /// as each operation needs them: an allocation is typically five to eight bytes.
+        ///
+        /// requests are serialised, so recording is safe for any storage that is safe
+        /// to use from several threads. deallocations of memory that was not allocated
+        /// through this storage, and extend() calls that fail, are not recorded.
+        struct recording_storage : storage_base
+        {
+        private:
+            storage_base &store;
+            std::ostream &out;
+            std::uint64_t next_id;
+            std::unordered_map<void *, std::uint64_t> live;
+            std::map<std::thread::id, std::uint32_t> threads;
+            mutable std::mutex guard;
+
+            void write_event(trace_op op)
+            {
+                out.put(char(op));
+                std::thread::id thread = std::this_thread::get_id();
+                std::map<std::thread::id, std::uint32_t>::iterator found = threads.find(thread);
+                if (found == threads.end())
+                    found = threads.insert(std::make_pair(thread, std::uint32_t(threads.size()))).first;
+                detail::write_varint(out, found->second);
+            }
+
+        public:
+            recording_storage(storage_base &inner, std::ostream &trace)
+                : store(inner), out(trace), next_id(0)
+            {
+                out.write(detail::trace_magic, sizeof(detail::trace_magic));
+            }
+
+            ~recording_storage()
+            {
+                out.flush();
+            }
+
+            /// the number of allocations recorded
+            std::uint64_t num_allocations() const
+            {
+                std::lock_guard<std::mutex> lock(guard);
+                return next_id;
+            }
+
+            using storage_base::allocate;
+
+            void *allocate(size_t num_bytes, size_t alignment)
+            {
+                std::lock_guard<std::mutex> lock(guard);
+                void *ptr = store.allocate(num_bytes, alignment);
+                if (ptr == 0)
+                    return 0;
+                std::uint64_t id = next_id++;
+                live[ptr] = id;
+                write_event(trace_allocate);
+                detail::write_varint(out, id);
+                detail::write_varint(out, num_bytes);
+                out.put(char(detail::log2(alignment)));
+                return ptr;
+            }
+
+            void deallocate(void *ptr)
+            {
+                std::lock_guard<std::mutex> lock(guard);
+                store.deallocate(ptr);
+                std::unordered_map<void *, std::uint64_t>::iterator found = live.find(ptr);
+                if (found == live.end())
+                    return;
+                write_event(trace_deallocate);
+                detail::write_varint(out, found->second);
+                live.erase(found);
+            }
+
+            bool extend(void *ptr, size_t num_bytes, size_t new_num_bytes)
+            {
+                std::lock_guard<std::mutex> lock(guard);
+                if (!store.extend(ptr, num_bytes, new_num_bytes))
+                    return false;
+                std::unordered_map<void *, std::uint64_t>::iterator found = live.find(ptr);
+                if (found != live.end())
+                {
+                    write_event(trace_extend);
+                    detail::write_varint(out, found->second);
+                    detail::write_varint(out, new_num_bytes);
+                }
+                return true;
+            }
+
+            void reset()
+            {
+                std::lock_guard<std::mutex> lock(guard);
+                store.reset();
+                live.clear();
+                write_event(trace_reset);
+            }
+
+            void release()
+            {
+                std::lock_guard<std::mutex> lock(guard);
+                store.release();
+                live.clear();
+                write_event(trace_release);
+            }
+
+            size_t max_size() const
+            {
+                return store.max_size();
+            }
+
+            size_t used() const
+            {
+                return store.used();
+            }
+
+            size_t remaining() const
+            {
+                return store.remaining();
+            }
+        };
+
+        /// read a trace written by recording_storage, appending its events. throws
+        /// std::runtime_error if the stream does not hold a trace
+        inline void read_trace(std::istream &in, std::vector<trace_event> &events)
+        {
+            char magic[sizeof(detail::trace_magic)];
+            if (!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), detail::trace_magic))
+                throw std::runtime_error("trace: not a trace, or of another version");
+            for (;;)
+            {
+                int op = in.get();
+                if (op == std::char_traits<char>::eof())
+                    return;
+                if (op > trace_release)
+                    throw std::runtime_error("trace: bad event");
+                trace_event event = trace_event();
+                event.op = trace_op(op);
+                std::uint64_t thread = 0;
+                bool complete = detail::read_varint(in, thread);
+                event.thread = std::uint32_t(thread);
+                switch (event.op)
+                {
+                case trace_allocate:
+                    complete = complete && detail::read_varint(in, event.id) && detail::read_varint(in, event.size);
+                    if (complete)
+                    {
+                        int bits = in.get();
+                        complete = bits != std::char_traits<char>::eof() && bits < 32;
+                        event.alignment = std::uint32_t(1) << (bits & 31);
+                    }
+                    break;
+                case trace_deallocate:
+                    complete = complete && detail::read_varint(in, event.id);
+                    break;
+                case trace_extend:
+                    complete = complete && detail::read_varint(in, event.id) && detail::read_varint(in, event.size);
+                    break;
+                default:
+                    break;
+                }
+                if (!complete)
+                    throw std::runtime_error("trace: truncated event");
+                events.push_back(event);
+            }
+        }
+
+    } // namespace monotonic
+
+} // namespace boost
+
+#include <monotonic/detail/postfix.hpp>
+
+#endif // BOOST_MONOTONIC_RECORDING_STORAGE_HPP
+
+//EOF
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <monotonic/detail/prefix.hpp>
+#include <monotonic/allocator.hpp>
 #include <monotonic/shared_storage.hpp>
 
 namespace boost
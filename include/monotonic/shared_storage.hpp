@@ -22,7 +22,7 @@ namespace boost
                 template <size_t N, size_t M, class Al>
                 struct storage
                 {
-                    typedef shared_storage<storage<N,M,Al> > type;
+                    typedef shared_storage<monotonic::storage<N,M,Al> > type;
                 };
             };
         }
@@ -36,7 +36,7 @@ namespace boost
             mutable std::mutex guard;
 
         public:
-            shared_storage()
+            BOOST_MONOTONIC_CONSTEXPR_STORAGE shared_storage()
             {
             }
             template <class Allocator>
@@ -46,42 +46,49 @@ namespace boost
             }
             size_t used() const
             {
-                mutex::scoped_lock lock(guard);
+                std::lock_guard<std::mutex> lock(guard);
                 return store.used();
             }
             void reset()
             {
-                mutex::scoped_lock lock(guard);
+                std::lock_guard<std::mutex> lock(guard);
                 store.reset();
             }
             void release()
             {
-                mutex::scoped_lock lock(guard);
+                std::lock_guard<std::mutex> lock(guard);
                 store.release();
             }
+            using storage_base::allocate;
+
             void *allocate(size_t num_bytes, size_t alignment)
             {
-                mutex::scoped_lock lock(guard);
+                std::lock_guard<std::mutex> lock(guard);
                 return store.allocate(num_bytes, alignment);
             }
             void deallocate(void *ptr)
             {
-                mutex::scoped_lock lock(guard);
+                std::lock_guard<std::mutex> lock(guard);
                 store.deallocate(ptr);
             }
+            bool extend(void *ptr, size_t num_bytes, size_t new_num_bytes)
+            {
+                std::lock_guard<std::mutex> lock(guard);
+                return store.extend(ptr, num_bytes, new_num_bytes);
+            }
             size_t remaining() const
             {
-                mutex::scoped_lock lock(guard);
+                std::lock_guard<std::mutex> lock(guard);
                 return store.remaining();
             }
             size_t fixed_remaining() const
             {
-                mutex::scoped_lock lock(guard);
+                std::lock_guard<std::mutex> lock(guard);
                 return store.fixed_remaining();
             }
             size_t max_size() const
             {
-                mutex::scoped_lock lock(guard);
+                std::lock_guard<std::mutex> lock(guard);
                 return store.max_size();
             }
 
@@ -0,0 +1,224 @@
+// Copyright (C) 2009-2020 Christian@Schladetsch.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MONOTONIC_SIZING_ADVISOR_HPP
+#define BOOST_MONOTONIC_SIZING_ADVISOR_HPP
+
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <monotonic/detail/prefix.hpp>
+#include <monotonic/storage.hpp>
+
+namespace boost
+{
+    namespace monotonic
+    {
+        /// watches storage<>s, grouped into named sites, and recommends an InlineSize and
+        /// MinHeapIncrement for each site from the most memory it used in one cycle.
+        ///
+        ///     monotonic::storage<> storage;
+        ///     storage.set_observer(&monotonic::sizing_advisor::global().get_site("parser"));
+        ///
+        /// an alarm may be set to be told each time a storage first spills from its inline
+        /// buffer to the heap in a cycle. an advisor is thread-safe, and must outlive the
+        /// storage it watches; global() is never destroyed, so it outlives all of them.
+        struct sizing_advisor
+        {
+            /// the largest InlineSize that will be recommended; beyond this, storage is
+            /// better kept on the heap
+            static constexpr size_t MaxInlineSize = 1024*1024;
+
+            /// the smallest MinHeapIncrement that will be recommended
+            static constexpr size_t MinHeapIncrement = 64*1024;
+
+            /// what is known of the storage used at one site
+            struct site : storage_observer
+            {
+                std::string name;
+                size_t inline_size;             ///< of the storage last seen here
+                size_t min_heap_increment;      ///< of the storage last seen here
+                size_t cycles;                  ///< in which anything was allocated
+                size_t spills;                  ///< cycles that spilled to the heap
+                size_t fixed_peak;              ///< most inline bytes used in a cycle
+                size_t heap_peak;               ///< most heap bytes used in a cycle
+                size_t peak;                    ///< most bytes used in a cycle
+                size_t heap_reserved_peak;      ///< most bytes in heap links at the end of a cycle
+
+                site(sizing_advisor *adv = 0, std::string const &site_name = std::string())
+                    : name(site_name), inline_size(0), min_heap_increment(0), cycles(0), spills(0)
+                    , fixed_peak(0), heap_peak(0), peak(0), heap_reserved_peak(0), advisor(adv)
+                {
+                }
+
+                /// enough to hold the peak with an eighth to spare, as a power of two, up
+                /// to MaxInlineSize
+                size_t recommended_inline_size() const
+                {
+                    if (cycles == 0)
+                        return inline_size;
+                    return (std::min)(round_up(peak + peak/8), size_t(MaxInlineSize));
+                }
+
+                /// enough to hold in one link what the recommended inline buffer cannot.
+                /// the current increment if nothing should spill
+                size_t recommended_min_heap_increment() const
+                {
+                    size_t inline_advised = recommended_inline_size();
+                    if (cycles == 0 || peak <= inline_advised)
+                        return min_heap_increment;
+                    size_t needed = peak - inline_advised;
+                    return (std::max)(round_up(needed + needed/8), size_t(MinHeapIncrement));
+                }
+
+                void spilled(storage_base &, size_t num_bytes, size_t alignment)
+                {
+                    std::function<void(site const &, size_t, size_t)> alarm;
+                    {
+                        std::lock_guard<std::mutex> lock(advisor->guard);
+                        alarm = advisor->alarm;
+                    }
+                    if (alarm)
+                        alarm(*this, num_bytes, alignment);
+                }
+
+                void cycle_ended(storage_base &, storage_usage const &usage)
+                {
+                    std::lock_guard<std::mutex> lock(advisor->guard);
+                    inline_size = usage.inline_size;
+                    min_heap_increment = usage.min_heap_increment;
+                    ++cycles;
+                    spills += usage.spilled;
+                    fixed_peak = (std::max)(fixed_peak, usage.fixed_used);
+                    heap_peak = (std::max)(heap_peak, usage.heap_used);
+                    peak = (std::max)(peak, usage.fixed_used + usage.heap_used);
+                    heap_reserved_peak = (std::max)(heap_reserved_peak, usage.heap_reserved);
+                }
+
+            private:
+                sizing_advisor *advisor;
+
+                static size_t round_up(size_t num_bytes)
+                {
+                    size_t size = 1024;
+                    while (size < num_bytes)
+                        size *= 2;
+                    return size;
+                }
+            };
+
+            typedef std::function<void(site const &, size_t /*num_bytes*/, size_t /*alignment*/)> Alarm;
+
+        private:
+            std::map<std::string, std::unique_ptr<site> > site_map;
+            Alarm alarm;
+            std::ostream *exit_stream;
+            bool dump_registered;
+            mutable std::mutex guard;
+
+            static void dump_global()
+            {
+                sizing_advisor &advisor = global();
+                if (advisor.exit_stream)
+                    advisor.dump(*advisor.exit_stream);
+            }
+
+        public:
+            sizing_advisor() : exit_stream(0), dump_registered(false)
+            {
+            }
+
+            ~sizing_advisor()
+            {
+                if (exit_stream)
+                    dump(*exit_stream);
+            }
+
+            /// an advisor for the whole program, which is never destroyed
+            static sizing_advisor &global()
+            {
+                static sizing_advisor *advisor = new sizing_advisor();
+                return *advisor;
+            }
+
+            /// the site of the given name, which is made if it is new. its address is
+            /// fixed for the life of the advisor
+            site &get_site(std::string const &name)
+            {
+                std::lock_guard<std::mutex> lock(guard);
+                std::unique_ptr<site> &found = site_map[name];
+                if (!found)
+                    found.reset(new site(this, name));
+                return *found;
+            }
+
+            /// call alarm each time a storage watched by this first spills to the heap
+            /// in a cycle. it is given the site and the request that spilled. the alarm
+            /// is called from the allocating thread; an empty Alarm to stop
+            void set_alarm(Alarm const &fun)
+            {
+                std::lock_guard<std::mutex> lock(guard);
+                alarm = fun;
+            }
+
+            /// a copy of each site, in order of name
+            std::vector<site> get_sites() const
+            {
+                std::lock_guard<std::mutex> lock(guard);
+                std::vector<site> result;
+                for (auto const &entry : site_map)
+                    result.push_back(*entry.second);
+                return result;
+            }
+
+            /// write a table of the sites and what is recommended for each
+            void dump(std::ostream &out) const
+            {
+                std::vector<site> sites = get_sites();
+                size_t w = 12;
+                out << "monotonic storage sizing, in bytes" << std::endl;
+                out << std::left << std::setw(20) << "site" << std::right << std::setw(w) << "inline" << std::setw(w) << "increment"
+                    << std::setw(8) << "cycles" << std::setw(8) << "spills" << std::setw(w) << "fixed-peak" << std::setw(w) << "heap-peak"
+                    << std::setw(w) << "peak" << std::setw(w) << "advise-inl" << std::setw(w) << "advise-inc" << std::endl;
+                for (site const &entry : sites)
+                {
+                    out << std::left << std::setw(20) << entry.name << std::right << std::setw(w) << entry.inline_size
+                        << std::setw(w) << entry.min_heap_increment << std::setw(8) << entry.cycles << std::setw(8) << entry.spills
+                        << std::setw(w) << entry.fixed_peak << std::setw(w) << entry.heap_peak << std::setw(w) << entry.peak
+                        << std::setw(w) << entry.recommended_inline_size() << std::setw(w) << entry.recommended_min_heap_increment() << std::endl;
+                }
+            }
+
+            /// dump() to out when the advisor is destroyed, or for global(), when the
+            /// program exits
+            void dump_at_exit(std::ostream &out = std::cerr)
+            {
+                bool is_global = this == &global();
+                std::lock_guard<std::mutex> lock(guard);
+                exit_stream = &out;
+                if (is_global && !dump_registered)
+                {
+                    dump_registered = true;
+                    std::atexit(&sizing_advisor::dump_global);
+                }
+            }
+        };
+
+    } // namespace monotonic
+
+} // namespace boost
+
+#include <monotonic/detail/postfix.hpp>
+
+#endif // BOOST_MONOTONIC_SIZING_ADVISOR_HPP
+
+//EOF
@@ -5,16 +5,21 @@
 
 #pragma once
 
+#include <array>
 #include <typeinfo>
-#include <boost/iterator/iterator_categories.hpp>
-#include <monotonic/utility/iter_range.hpp>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <boost/assert.hpp>
 
 #include <monotonic/detail/prefix.hpp>
 #include <monotonic/storage.hpp>
-#include <monotonic/containers/vector.hpp>
+#include <monotonic/fixed_storage.hpp>
 
+#ifdef _MSC_VER
 // warning C4345: behavior change: an object of POD type constructed with an initializer of the form () will be default-initialized
-#pragma warning(disable:4345)
+#    pragma warning(disable:4345)
+#endif
 
 namespace boost
 {
@@ -51,15 +56,15 @@ namespace boost
                 T &get()
                 {
                     if (get_type() != typeid(T))
-                        throw std::bad_get();
-                    return *static_get<element<T> &>(*this).get_pointer();
+                        throw std::bad_cast();
+                    return *static_cast<element<T> &>(*this).get_pointer();
                 }
                 template <class T>
                 const T &get() const
                 {
                     if (get_type() != typeid(T))
-                        throw std::bad_get();
-                    return *static_get<const element<T> &>(*this).get_pointer();
+                        throw std::bad_cast();
+                    return *static_cast<const element<T> &>(*this).get_pointer();
                 }
 
                 virtual void destroy() {}
@@ -76,7 +81,7 @@ namespace boost
 
                 private:
                     pointer ptr;
-                    char value[sizeof(T)];
+                    alignas(T) char value[sizeof(T)];
                 
                 public:
                     element()
@@ -93,14 +98,14 @@ namespace boost
                     }
                     void destroy()
                     {
-                        destroy(ptr, boost::has_trivial_destructor<type>());
+                        destroy(ptr, std::is_trivially_destructible<type>());
                     }
-                    void destroy(pointer ptr, const boost::false_type& )
+                    void destroy(pointer ptr, const std::false_type& )
                     {
                         (*ptr).~type();
                     }
 
-                    void destroy(pointer, const boost::true_type& )
+                    void destroy(pointer, const std::true_type& )
                     { 
                     }
                 };
@@ -126,12 +131,12 @@ namespace boost
                 };
             };
 
-            ///// an element of a given type on the stack
-            //template <class T>
-            //struct element 
-            //    : impl::element<T, boost::is_pod<T>>::value
-            //{
-            //};
+            /// an element of a given type on the stack
+            template <class T>
+            struct element
+                : impl::template element<T, std::is_pod<T>::value>
+            {
+            };
 
             element_base *previous;
 
@@ -141,9 +146,13 @@ namespace boost
             typedef element_base const &const_reference;
             typedef size_t size_type;
 
-            struct const_iterator : boost::iterator<forward_traversal_tag, element_base>
+            struct const_iterator
             {
+                typedef std::forward_iterator_tag iterator_category;
                 typedef element_base value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef element_base *pointer;
+                typedef element_base &reference;
                 element_base *current;
 
                 const_iterator(element_base *elem = 0) 
@@ -183,23 +192,23 @@ namespace boost
                 iterator(element_base *elem = 0) 
                     : const_iterator(elem) { }
 
-                value_type &operator*()
+                element_base &operator*()
                 {
-                    return *current;
+                    return *this->current;
                 }
-                value_type *operator->()
+                element_base *operator->()
                 {
-                    return current;
+                    return this->current;
                 }
                 iterator &operator++()
                 {
-                    const_iterator::operator++(0);
+                    const_iterator::operator++();
                     return *this;
                 }
                 iterator operator++(int)
                 {
                     iterator tmp = *this;
-                    const_iterator::operator++(0);
+                    const_iterator::operator++();
                     return tmp;
                 }
             };
@@ -239,15 +248,14 @@ namespace boost
                 return iterator(0);
             }
 
-            // CJS TODO
-            //template <class T>
-            //T &push()
-            //{
-            //    element<T> &elem = push_element<T>();
-            //    if (!is_pod<T>::value)
-            //        new (elem.get_pointer()) T();
-            //    return *elem.get_pointer();
-            //}
+            template <class T>
+            T &push()
+            {
+                element<T> &elem = push_element<T>();
+                if (!std::is_pod<T>::value)
+                    new (elem.get_pointer()) T();
+                return *elem.get_pointer();
+            }
 
             template <class T, class A0>
             T &push(A0 a0)
@@ -301,7 +309,10 @@ namespace boost
             element<T> &push_element()
             {
                 size_t cursor = store.get_cursor();
-                element<T> &elem = store.create<element<T> >();
+                void *ptr = store.allocate(sizeof(element<T>), alignof(element<T>));
+                if (ptr == 0)
+                    throw std::bad_alloc();
+                element<T> &elem = *new (ptr) element<T>();
                 elem.previous = previous;
                 elem.cursor = cursor;
                 previous = &elem;
@@ -316,7 +327,7 @@ namespace boost
             fixed_stack<Size> fixed;
 
         private:
-            storage<Size, Inc, Al> storage;
+            storage<Size, Inc, Al> store;
 
         public:
             stack()
@@ -341,9 +352,9 @@ namespace boost
             }
 
             template <class T>
-            T &push(T &&value)
+            typename std::decay<T>::type &push(T &&value)
             {
-                return fixed.push<T>(value);
+                return fixed.template push<typename std::decay<T>::type>(std::forward<T>(value));
             }
         };
     
@@ -26,6 +26,12 @@ namespace boost
             };
         }
 
+        /// a globally available storage for the given region and access.
+        ///
+        /// `global` has no guard on the access path: get_storage() is a direct reference
+        /// to the symbol. where the storage types are constexpr-constructible (C++20) it
+        /// is also constant-initialised, so there is no static constructor to run and it
+        /// is safe to allocate from it during the dynamic initialisation of other globals.
         template <class Region
             , class Access
             , size_t InlineSize
@@ -44,7 +50,7 @@ namespace boost
             static_storage()
             {
             }
-            static StorageType &get_storage()
+            static StorageType &get_storage() noexcept
             {
                 return global;
             }
@@ -60,6 +66,10 @@ namespace boost
             {
                 return global.allocate(num_bytes, alignment);
             }
+            static void *allocate(size_t num_bytes, size_t alignment, hint::type use)
+            {
+                return global.allocate(num_bytes, alignment, use);
+            }
             static size_t max_size()
             {
                 return global.max_size();
@@ -80,9 +90,62 @@ namespace boost
             , size_t InlineSize
             , size_t MinHeapIncrement
             , class Al>
-        typename static_storage<Region, Access, InlineSize, MinHeapIncrement, Al>::StorageType 
+        BOOST_MONOTONIC_STATIC_STORAGE_CONSTINIT typename static_storage<Region, Access, InlineSize, MinHeapIncrement, Al>::StorageType 
             static_storage<Region, Access, InlineSize, MinHeapIncrement, Al>::global;
 
+        /// a globally available fixed-size buffer for the given region.
+        ///
+        /// fixed_storage has a constexpr constructor, so the buffer and cursor are
+        /// constant-initialised into .bss: there is no static constructor to run at
+        /// startup and no initialisation-order problem when used from other statics.
+        /// the price is that it never grows; allocate() returns 0 once it is full.
+        template <class Region, size_t InlineSize>
+        struct static_fixed_storage
+        {
+            typedef fixed_storage<InlineSize> StorageType;
+
+        private:
+            static StorageType global;
+
+        public:
+            static StorageType &get_storage() noexcept
+            {
+                return global;
+            }
+            static void reset()
+            {
+                global.reset();
+            }
+            static void release()
+            {
+                global.release();
+            }
+            static void *allocate(size_t num_bytes, size_t alignment)
+            {
+                return global.allocate(num_bytes, alignment);
+            }
+            static void *allocate(size_t num_bytes, size_t alignment, hint::type use)
+            {
+                return global.allocate(num_bytes, alignment, use);
+            }
+            static size_t max_size()
+            {
+                return global.max_size();
+            }
+            static size_t used()
+            {
+                return global.used();
+            }
+            static size_t remaining()
+            {
+                return global.remaining();
+            }
+        };
+
+        template <class Region, size_t InlineSize>
+        BOOST_MONOTONIC_CONSTINIT typename static_fixed_storage<Region, InlineSize>::StorageType
+            static_fixed_storage<Region, InlineSize>::global;
+
         //template <class Region
         //    , class Access = default_access_tag
         //    , size_t N = DefaultSizes::InlineSize
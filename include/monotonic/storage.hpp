@@ -6,6 +6,7 @@
 #ifndef BOOST_MONOTONIC_STORAGE_HPP
 #define BOOST_MONOTONIC_STORAGE_HPP
 
+#include <cstddef>
 #include <algorithm>
 #include <array>
 #include <type_traits>
@@ -18,6 +19,50 @@ namespace boost
 {
     namespace monotonic
     {
+#ifdef BOOST_MONOTONIC_STATISTICS
+        /// what a storage<> has done with the memory asked of it since it was made, or
+        /// since reset_statistics(). the unused bytes of pools and links are of the storage
+        /// as it is when get_statistics() is called
+        struct storage_statistics
+        {
+            size_t allocations;         ///< calls to allocate()
+            size_t requested;           ///< bytes asked for by allocate() and extend()
+            size_t padding;             ///< bytes skipped to align allocations
+            size_t pool_rounding;       ///< bytes that pooled allocations were rounded up by
+            size_t links;               ///< heap links made
+            size_t heap_reserved;       ///< bytes in the heap links made
+            size_t pool_unused;         ///< bytes in pools not yet handed out
+            size_t link_unused;         ///< bytes after the cursor of each link
+        };
+#endif
+
+        /// the memory a storage<> used in one cycle: from when it was made or last reset,
+        /// to its next reset() or release()
+        struct storage_usage
+        {
+            size_t inline_size;         ///< the InlineSize of the storage
+            size_t min_heap_increment;  ///< and its MinHeapIncrement
+            size_t fixed_used;          ///< bytes used in the inline buffer
+            size_t heap_used;           ///< bytes used in heap links
+            size_t heap_reserved;       ///< bytes in the heap links
+            bool spilled;               ///< if anything was allocated from the heap
+        };
+
+        /// told what a storage<> is doing, by storage<>::set_observer(). it is only called
+        /// from the slow paths of a storage
+        struct storage_observer
+        {
+            virtual ~storage_observer() { }
+
+            /// the first allocation of a cycle that did not fit in the inline buffer, and
+            /// so was made from the heap. for a pooled allocation, num_bytes is of the
+            /// block made for the pool
+            virtual void spilled(storage_base &, size_t /*num_bytes*/, size_t /*alignment*/) { }
+
+            /// a cycle in which anything was allocated has ended
+            virtual void cycle_ended(storage_base &, storage_usage const &) { }
+        };
+
         /// storage that spans the stack/heap boundary.
         ///
         /// allocation requests first use inline fixed_storage of InlineSize bytes.
@@ -33,9 +78,9 @@ namespace boost
 
             typedef storage<InlineSize, MinHeapIncrement, Alloc> This;
             typedef Alloc Allocator;
-            typedef typename Allocator::template rebind<char>::other CharAllocator;
+            typedef typename std::allocator_traits<Allocator>::template rebind_alloc<char> CharAllocator;
             typedef detail::Link<CharAllocator> Link;
-            typedef typename Allocator::template rebind<Link>::other LinkAllocator;
+            typedef typename std::allocator_traits<Allocator>::template rebind_alloc<Link> LinkAllocator;
             typedef detail::Pool Pool;
             // allocations are always made from the stack, or from a pool the first link in the chain
             // typedef std::vector<Link, Alloc> Chain;                    
@@ -49,8 +94,18 @@ namespace boost
             Chain chain;                        // heap-based storage
             Allocator alloc;                    // allocator for heap-based storage
             Pools pools;                        // pools of same-sized chunks
-
-            void create_pools()
+            bool compact_on_reset;              // coalesce the chain into one link on reset()
+            size_t heap_peak;                   // largest heap_used() seen at a reset()
+            size_t heap_alignment;              // largest alignment asked of the heap since the last reset()
+            size_t fixed_peak;                  // largest fixed_used() seen at a reset()
+            bool spilled;                       // allocated from the heap since the last reset()
+            size_t spills;                      // cycles that allocated from the heap
+            storage_observer *observer;
+#ifdef BOOST_MONOTONIC_STATISTICS
+            storage_statistics stats;
+#endif
+
+            BOOST_MONOTONIC_CONSTEXPR_STORAGE void create_pools()
             {
                 for (size_t n = 0; n < NumPools; ++n)
                 {
@@ -61,12 +116,19 @@ namespace boost
             template <size_t,size_t,class> friend struct stack;
 
         public:
-            storage()
+            BOOST_MONOTONIC_CONSTEXPR_STORAGE storage()
+                : compact_on_reset(false), heap_peak(0), heap_alignment(0), fixed_peak(0), spilled(false), spills(0), observer(0)
+#ifdef BOOST_MONOTONIC_STATISTICS
+                , stats()
+#endif
             {
                 create_pools();
             }
             storage(Allocator const &A)
-                : alloc(A)
+                : alloc(A), compact_on_reset(false), heap_peak(0), heap_alignment(0), fixed_peak(0), spilled(false), spills(0), observer(0)
+#ifdef BOOST_MONOTONIC_STATISTICS
+                , stats()
+#endif
             {
                 create_pools();
             }
@@ -77,11 +139,24 @@ namespace boost
 
             void reset()
             {
+                size_t peak = heap_used();
+                heap_peak = (std::max)(heap_peak, peak);
+                fixed_peak = (std::max)(fixed_peak, fixed.used());
+                if (observer && (peak > 0 || fixed.used() > 0 || spilled))
+                    EndCycle(peak);
+                spilled = false;
                 fixed.reset();
                 for (Pool &pool : pools)
                 {
                     pool.reset();
                 }
+                size_t alignment = heap_alignment;
+                heap_alignment = 0;
+                if (compact_on_reset && chain.size() > 1)
+                {
+                    Coalesce(peak, alignment);
+                    return;
+                }
                 for (Link &link : chain)
                 {
                     link.reset();
@@ -91,17 +166,84 @@ namespace boost
             void release()
             {
                 reset();
-                for (Link &link : chain)
-                {
-                    link.release();
-                }
-                chain.clear();
+                ReleaseChain();
+            }
+
+            /// if set, each reset() that finds more than one link replaces the chain
+            /// with a single link large enough to hold everything that was allocated
+            /// from the heap during the previous cycle. a steady-state workload then
+            /// runs in one contiguous buffer after the first reset.
+            void set_compact_on_reset(bool compact)
+            {
+                compact_on_reset = compact;
+            }
+
+            bool get_compact_on_reset() const
+            {
+                return compact_on_reset;
+            }
+
+            /// the largest number of heap bytes in use at any reset(), or now
+            size_t get_heap_peak() const
+            {
+                return (std::max)(heap_peak, heap_used());
+            }
+
+            /// the largest number of inline bytes in use at any reset(), or now
+            size_t get_fixed_peak() const
+            {
+                return (std::max)(fixed_peak, fixed.used());
+            }
+
+            /// the number of cycles, each ended by reset(), in which the inline buffer
+            /// overflowed and allocations were made from the heap. this includes the
+            /// current cycle
+            size_t num_spills() const
+            {
+                return spills;
+            }
+
+            /// tell observer, which must outlive this storage or be replaced, when the
+            /// storage first spills to the heap in a cycle, and when each cycle ends.
+            /// null to stop
+            void set_observer(storage_observer *obs)
+            {
+                observer = obs;
             }
+
+            storage_observer *get_observer() const
+            {
+                return observer;
+            }
+
+#ifdef BOOST_MONOTONIC_STATISTICS
+            storage_statistics get_statistics() const
+            {
+                storage_statistics result = stats;
+                for (Pool const &pool : pools)
+                    result.pool_unused += pool.last - pool.next;
+                for (Link const &link : chain)
+                    result.link_unused += link.remaining();
+                return result;
+            }
+
+            void reset_statistics()
+            {
+                stats = storage_statistics();
+            }
+#endif
         public:
+            using storage_base::allocate;
+
             void *allocate(size_t num_bytes, size_t alignment = 1)
             {
+#ifdef BOOST_MONOTONIC_STATISTICS
+                ++stats.allocations;
+                stats.requested += num_bytes;
+#endif
                 size_t pool = (ChunkSize + num_bytes) >> ChunkShift;
-                if (pool < NumPools)
+                // pooled chunks are only aligned to ChunkSize
+                if (pool < NumPools && alignment <= ChunkSize)
                 {
                     if (void *ptr = from_pool(pool, num_bytes, alignment))
                         return ptr;
@@ -116,32 +258,43 @@ namespace boost
 
             void *from_pool(size_t bucket, size_t num_bytes, size_t alignment)
             {
-                return pools[bucket].allocate(*this);
+                void *ptr = pools[bucket].allocate(*this);
+                if (ptr)
+                    detail::unpoison(ptr, num_bytes);
+#ifdef BOOST_MONOTONIC_STATISTICS
+                if (ptr)
+                    stats.pool_rounding += pools[bucket].bucket_size - num_bytes;
+#endif
+                return ptr;
             }
             
             void *from_fixed(size_t num_bytes, size_t alignment)
             {
-                return fixed.allocate(num_bytes, alignment);
+                return AllocateFrom(fixed, num_bytes, alignment);
             }
             
             void *from_heap(size_t num_bytes, size_t alignment)
             {
                 if (MinHeapIncrement == 0)
                     return 0;
+                if (!spilled)
+                    Spill(num_bytes, alignment);
+                heap_alignment = (std::max)(heap_alignment, alignment);
                 if (!chain.empty())
                 {
-                    if (void *ptr = chain.front().allocate(num_bytes, alignment))
+                    if (void *ptr = AllocateFrom(chain.front(), num_bytes, alignment))
                     {
                         return ptr;
                     }
                     std::make_heap(chain.begin(), chain.end());
-                    if (void *ptr = chain.front().allocate(num_bytes, alignment))
+                    if (void *ptr = AllocateFrom(chain.front(), num_bytes, alignment))
                     {
                         return ptr;
                     }
                 }
-                AddLink((std::max)(MinHeapIncrement, num_bytes*2));
-                void *ptr = chain.front().allocate(num_bytes, alignment);
+                // room for this and another like it, with their padding and red zones
+                AddLink((std::max)(MinHeapIncrement, (num_bytes + alignment + detail::red_zone)*2));
+                void *ptr = AllocateFrom(chain.front(), num_bytes, alignment);
                 if (ptr == 0)
                     throw std::bad_alloc();
                 return ptr;
@@ -153,6 +306,19 @@ namespace boost
                 // do nothing
             }
 
+            /// grow the most recent allocation from the inline buffer or the current
+            /// heap link in place. pooled chunks are never extended
+            bool extend(void *ptr, size_t num_bytes, size_t new_num_bytes)
+            {
+                bool extended = fixed.extend(ptr, num_bytes, new_num_bytes)
+                    || (!chain.empty() && chain.front().extend(ptr, num_bytes, new_num_bytes));
+#ifdef BOOST_MONOTONIC_STATISTICS
+                if (extended)
+                    stats.requested += new_num_bytes - num_bytes;
+#endif
+                return extended;
+            }
+
             size_t max_size() const
             {
                 return (std::numeric_limits<size_t>::max)();
@@ -250,7 +416,7 @@ namespace boost
             template <size_t N>
             char *allocate_bytes()
             {
-                return allocate_bytes(N, 64);// std::aligned_storage<N>::);
+                return allocate_bytes(N, alignof(std::max_align_t));
             }
 
             char *allocate_bytes(size_t num_bytes, size_t alignment = 1)
@@ -268,11 +434,73 @@ namespace boost
             }
 
         private:
+            void Spill(size_t num_bytes, size_t alignment)
+            {
+                spilled = true;
+                ++spills;
+                if (observer)
+                    observer->spilled(*this, num_bytes, alignment);
+            }
+
+            void EndCycle(size_t heap_used)
+            {
+                storage_usage usage;
+                usage.inline_size = InlineSize;
+                usage.min_heap_increment = MinHeapIncrement;
+                usage.fixed_used = fixed.used();
+                usage.heap_used = heap_used;
+                usage.heap_reserved = 0;
+                for (Link const &link : chain)
+                    usage.heap_reserved += link.max_size();
+                usage.spilled = spilled;
+                observer->cycle_ended(*this, usage);
+            }
+
+            /// allocate from the inline buffer or a link
+            template <class Buffer>
+            void *AllocateFrom(Buffer &buffer, size_t num_bytes, size_t alignment)
+            {
+#ifdef BOOST_MONOTONIC_STATISTICS
+                size_t before = buffer.used();
+                void *ptr = buffer.allocate(num_bytes, alignment);
+                if (ptr)
+                    stats.padding += buffer.used() - before - num_bytes;
+                return ptr;
+#else
+                return buffer.allocate(num_bytes, alignment);
+#endif
+            }
+
             void AddLink(size_t size)
             {
                 chain.push_back(Link(alloc, size));
+#ifdef BOOST_MONOTONIC_STATISTICS
+                ++stats.links;
+                stats.heap_reserved += chain.back().max_size();
+#endif
                 std::make_heap(chain.begin(), chain.end());
             }
+
+            void ReleaseChain()
+            {
+                for (Link &link : chain)
+                {
+                    link.release();
+                }
+                chain.clear();
+            }
+
+            /// replace the chain with one link of at least `peak` bytes. the allocations
+            /// of each old link keep their padding in the new one only if they start at
+            /// the same address modulo the largest alignment used, so allow that much for
+            /// each old link, with a red zone, and at least a cache-line.
+            void Coalesce(size_t peak, size_t alignment)
+            {
+                size_t slack = (std::max)(size_t(DefaultSizes::CacheLineSize), alignment) + detail::red_zone;
+                size_t required = peak + chain.size()*slack;
+                ReleaseChain();
+                AddLink((std::max)(MinHeapIncrement, required));
+            }
         };
 
     } // namespace monotonic
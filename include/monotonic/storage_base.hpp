@@ -6,12 +6,47 @@
 #ifndef BOOST_MONOTONIC_STORAGE_BASE_HPP
 #define BOOST_MONOTONIC_STORAGE_BASE_HPP
 
+#include <algorithm>
+
 #include <monotonic/detail/prefix.hpp>
 
+#if !defined(BOOST_MONOTONIC_INTERFERENCE_SIZE) && defined(__cpp_lib_hardware_interference_size)
+#    include <new>
+#endif
+
 namespace boost
 {
     namespace monotonic
     {
+        namespace hint
+        {
+            /// what an allocation is for, which a storage may use to decide where to put it
+            enum type
+            {
+                none,
+                /// written by one thread while other threads use the memory around it.
+                /// it is given cache lines of its own, so that the threads do not contend
+                /// for a line that none of them share data in
+                exclusive_line,
+            };
+
+            /// the span of memory over which writes from different threads contend
+#if defined(BOOST_MONOTONIC_INTERFERENCE_SIZE)
+            constexpr size_t line_size = BOOST_MONOTONIC_INTERFERENCE_SIZE;
+#elif defined(__cpp_lib_hardware_interference_size)
+#    if defined(__GNUC__) && !defined(__clang__)
+#        pragma GCC diagnostic push
+#        pragma GCC diagnostic ignored "-Winterference-size"
+#    endif
+            constexpr size_t line_size = std::hardware_destructive_interference_size;
+#    if defined(__GNUC__) && !defined(__clang__)
+#        pragma GCC diagnostic pop
+#    endif
+#else
+            constexpr size_t line_size = DefaultSizes::CacheLineSize;
+#endif
+        } // namespace hint
+
         /// base structure for different storage types
         struct storage_base
         {
@@ -24,7 +59,31 @@ namespace boost
             // the number of bytes to allocate, and the alignment to use
             virtual void *allocate(size_t num_bytes, size_t alignment) = 0;
 
+            /// allocate as the hint asks
+            void *allocate(size_t num_bytes, size_t alignment, hint::type use)
+            {
+                if (use == hint::exclusive_line)
+                    return allocate_exclusive(num_bytes, alignment);
+                return allocate(num_bytes, alignment);
+            }
+
+            /// allocate num_bytes that share no cache line with any other allocation, by
+            /// aligning to hint::line_size and padding to a whole number of lines
+            virtual void *allocate_exclusive(size_t num_bytes, size_t alignment)
+            {
+                size_t lines = (std::max)(num_bytes, size_t(1)) + hint::line_size - 1;
+                return allocate(lines - lines % hint::line_size, (std::max)(alignment, hint::line_size));
+            }
+
             virtual void deallocate(void * ptr) = 0;
+
+            /// grow the allocation of num_bytes at ptr to new_num_bytes without moving it.
+            /// this is only possible for the most recent allocation, when there is room
+            /// after it; returns false otherwise, leaving the allocation unchanged
+            virtual bool extend(void * /*ptr*/, size_t /*num_bytes*/, size_t /*new_num_bytes*/)
+            {
+                return false;
+            }
             
             virtual size_t max_size() const = 0;
             
@@ -3,15 +3,12 @@
 //  Distributed under the Boost Software License, Version 1.0. (See accompanying
 //  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 
-#if 0
 #ifndef BOOST_MONOTONIC_THREAD_LOCAL_STORAGE_HPP
 #define BOOST_MONOTONIC_THREAD_LOCAL_STORAGE_HPP
 
-#include <boost/thread/thread.hpp>
-
-#include <boost/monotonic/detail/prefix.hpp>
-#include <boost/monotonic/storage.hpp>
-#include <boost/monotonic/static_storage.hpp>
+#include <monotonic/detail/prefix.hpp>
+#include <monotonic/storage.hpp>
+#include <monotonic/static_storage.hpp>
 
 namespace boost
 {
@@ -25,57 +22,72 @@ namespace boost
                 template <size_t N, size_t M, class Al>
                 struct storage
                 {
-                    typedef thread_local_storage<N,M,Al> type;
+                    typedef thread_local_storage<N,M,Al,Region> type;
                 };
             };
         }
 
-        /// thread-local storage
-        template <size_t InlineSize, size_t MinHeapSize, class Al>
+        /// storage that gives each thread its own storage<>, so that threads allocate
+        /// without contention.
+        ///
+        /// the storage of a thread is made the first time that thread uses it, and is
+        /// released when the thread exits. reset() and release() only affect the storage
+        /// of the calling thread. all thread_local_storage of the same type share the
+        /// storage of each thread, so the type includes the Region it is made for:
+        /// static_storage of each region has storage of its own on each thread.
+        template <size_t InlineSize, size_t MinHeapIncrement, class Al, class Region>
         struct thread_local_storage : storage_base
         {
-            typedef storage<InlineSize, MinHeapSize, Al> Storage;
-            typedef boost::thread_specific_ptr<Storage> TLS_Storage;
-            typedef thread_local_storage<InlineSize, MinHeapSize, Al> This;
+            typedef storage<InlineSize, MinHeapIncrement, Al> Storage;
+            typedef thread_local_storage<InlineSize, MinHeapIncrement, Al, Region> This;
 
-        private:
-            Storage store;
-            TLS_Storage tls_store;
-            static void no_delete(Storage *) { }
+            constexpr thread_local_storage()
+            {
+            }
 
-        public:
-            thread_local_storage() 
-                : tls_store(&This::no_delete)
+            /// the storage of the calling thread
+            static Storage &get_local()
             {
-                tls_store.reset(&store);
+                thread_local Storage store;
+                return store;
             }
             size_t used() const
             {
-                return tls_store->used();
+                return get_local().used();
             }
             void reset()
             {
-                tls_store->reset();
+                get_local().reset();
             }
             void release()
             {
-                tls_store->release();
+                get_local().release();
             }
+            using storage_base::allocate;
+
             void *allocate(size_t num_bytes, size_t alignment)
             {
-                return tls_store->allocate(num_bytes, alignment);
+                return get_local().allocate(num_bytes, alignment);
+            }
+            void deallocate(void *ptr)
+            {
+                get_local().deallocate(ptr);
+            }
+            bool extend(void *ptr, size_t num_bytes, size_t new_num_bytes)
+            {
+                return get_local().extend(ptr, num_bytes, new_num_bytes);
             }
             size_t remaining() const
             {
-                return tls_store->remaining();
+                return get_local().remaining();
             }
             size_t fixed_remaining() const
             {
-                return tls_store->fixed_remaining();
+                return get_local().fixed_remaining();
             }
             size_t max_size() const
             {
-                return tls_store->max_size();
+                return get_local().max_size();
             }
         };
 
@@ -83,11 +95,8 @@ namespace boost
 
 } // namespace boost
 
-#include <boost/monotonic/detail/postfix.hpp>
+#include <monotonic/detail/postfix.hpp>
 
 #endif // BOOST_MONOTONIC_THREAD_LOCAL_STORAGE_HPP
 
 //EOF
-
-#endif //0
-
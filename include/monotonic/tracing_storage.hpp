@@ -0,0 +1,421 @@
+// Copyright (C) 2009-2020 Christian@Schladetsch.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MONOTONIC_TRACING_STORAGE_HPP
+#define BOOST_MONOTONIC_TRACING_STORAGE_HPP
+
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <algorithm>
+
+#if defined(_MSC_VER)
+#    include <intrin.h>
+#    pragma intrinsic(_ReturnAddress)
+#elif defined(__x86_64__) || defined(__i386__)
+#    include <x86intrin.h>
+#endif
+
+#include <monotonic/detail/prefix.hpp>
+#include <monotonic/forward_declarations.hpp>
+#include <monotonic/storage_base.hpp>
+#include <monotonic/recording_storage.hpp>
+
+// the address that the current function will return to, or 0 where that is not known
+#if defined(__GNUC__) || defined(__clang__)
+#    define BOOST_MONOTONIC_RETURN_ADDRESS() __builtin_return_address(0)
+#elif defined(_MSC_VER)
+#    define BOOST_MONOTONIC_RETURN_ADDRESS() _ReturnAddress()
+#else
+#    define BOOST_MONOTONIC_RETURN_ADDRESS() ((void *)0)
+#endif
+
+namespace boost
+{
+    namespace monotonic
+    {
+        /// one event as written by tracing_storage. records are written in the byte order
+        /// of the machine that wrote them
+        struct trace_record
+        {
+            std::uint64_t time;         ///< nanoseconds since the storage was made
+            std::uint64_t address;      ///< of the allocation; 0 for reset and release
+            std::uint64_t size;         ///< for allocate and extend
+            std::uint64_t caller;       ///< the return address of the call, if callers are traced
+            std::uint32_t thread;       ///< numbered in the order threads were first seen
+            std::uint8_t op;            ///< a trace_op
+            std::uint8_t alignment;     ///< log2 of the alignment of an allocation
+            std::uint16_t reserved;
+        };
+
+        namespace detail
+        {
+            /// a file of trace_records starts with these bytes, the last of which is the version
+            static const char tracing_magic[8] = { 'M', 'O', 'N', 'O', 'T', 'R', 'T', 1 };
+
+            /// the events of one thread, written by that thread and read by the flusher
+            /// without locking. when it is full, events are counted and dropped
+            template <size_t Size>
+            struct trace_ring
+            {
+                static_assert(Size > 0 && (Size & (Size - 1)) == 0, "the ring size must be a power of two");
+
+                alignas(DefaultSizes::CacheLineSize) std::atomic<size_t> head;      // written by the thread
+                std::atomic<size_t> dropped;
+                alignas(DefaultSizes::CacheLineSize) std::atomic<size_t> tail;      // written by the flusher
+                std::uint32_t thread;
+                trace_record records[Size];
+
+                trace_ring(std::uint32_t index) : head(0), dropped(0), tail(0), thread(index) { }
+
+                /// the record to fill for the next event, or 0 if the ring is full
+                trace_record *next()
+                {
+                    size_t at = head.load(std::memory_order_relaxed);
+                    if (at - tail.load(std::memory_order_acquire) == Size)
+                    {
+                        dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                        return 0;
+                    }
+                    return &records[at & (Size - 1)];
+                }
+
+                /// publish the record returned by next()
+                void push()
+                {
+                    head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+                }
+
+                /// write the events pushed so far to the stream, and free their space. the
+                /// time of each is converted from ticks to nanoseconds since start_ticks
+                void drain(std::ostream &out, std::uint64_t start_ticks, double ns_per_tick)
+                {
+                    size_t from = tail.load(std::memory_order_relaxed);
+                    size_t to = head.load(std::memory_order_acquire);
+                    while (from != to)
+                    {
+                        size_t start = from & (Size - 1);
+                        size_t count = (std::min)(to - from, Size - start);
+                        for (size_t n = start; n < start + count; ++n)
+                        {
+                            std::uint64_t ticks = records[n].time;
+                            records[n].time = ticks > start_ticks ? std::uint64_t((ticks - start_ticks)*ns_per_tick) : 0;
+                        }
+                        out.write(reinterpret_cast<const char *>(&records[start]), count*sizeof(trace_record));
+                        from += count;
+                    }
+                    tail.store(from, std::memory_order_release);
+                }
+            };
+
+            /// a clock that is cheap to read. on x86 this is the time-stamp counter, which
+            /// takes a few nanoseconds where reading std::chrono::steady_clock takes tens;
+            /// tracing_storage converts its ticks to nanoseconds as it writes them
+            inline std::uint64_t trace_ticks()
+            {
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+                return __rdtsc();
+#else
+                return std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+            }
+
+            inline std::atomic<std::uint64_t> &next_tracing_serial()
+            {
+                static std::atomic<std::uint64_t> serial(0);
+                return serial;
+            }
+        }
+
+        /// storage that passes every request to a Storage, and records each one with the
+        /// time, the thread, and optionally the return address of the caller.
+        ///
+        /// each thread records into a ring of RingSize events of its own without locking,
+        /// so recording costs little more than reading detail::trace_ticks(). a background
+        /// thread writes the rings to a file every `interval`, and once more when the
+        /// storage is destroyed. if a thread makes more than RingSize requests in that
+        /// time, the ones that do not fit are dropped and counted by dropped().
+        ///
+        /// the file is the bytes of tracing_magic followed by trace_records, in order for
+        /// each thread but not between threads; read_trace_records() reads and sorts them
+        /// by time. this storage is only as thread-safe as Storage is. a thread that uses
+        /// several tracing_storage in turn takes a lock to find its ring at each change.
+        template <class Storage, size_t RingSize>
+        struct tracing_storage : storage_base
+        {
+            typedef detail::trace_ring<RingSize> Ring;
+            typedef std::chrono::steady_clock Clock;
+
+        private:
+            Storage store;
+            bool trace_callers;
+            std::chrono::milliseconds interval;
+            std::uint64_t start_ticks;
+            Clock::time_point start_time;
+            std::uint64_t serial;
+            std::unique_ptr<std::ofstream> file;
+            std::ostream *out;
+
+            std::vector<std::unique_ptr<Ring> > rings;
+            std::map<std::thread::id, Ring *> thread_rings;
+            mutable std::mutex guard;                   // for the rings and the stream
+
+            bool stopping;
+            std::mutex stop_guard;
+            std::condition_variable wake;
+            std::thread flusher;
+
+            /// the ring of the calling thread, which is made the first time it is used
+            Ring &local_ring()
+            {
+                thread_local std::uint64_t owner = 0;
+                thread_local Ring *ring = 0;
+                if (owner != serial)
+                {
+                    std::lock_guard<std::mutex> lock(guard);
+                    Ring *&found = thread_rings[std::this_thread::get_id()];
+                    if (found == 0)
+                    {
+                        rings.push_back(std::unique_ptr<Ring>(new Ring(std::uint32_t(rings.size()))));
+                        found = rings.back().get();
+                    }
+                    ring = found;
+                    owner = serial;
+                }
+                return *ring;
+            }
+
+            void trace(trace_op op, void *ptr, size_t size, size_t alignment, void *caller)
+            {
+                Ring &ring = local_ring();
+                trace_record *rec = ring.next();
+                if (rec == 0)
+                    return;
+                rec->time = detail::trace_ticks();
+                rec->address = std::uint64_t(reinterpret_cast<std::uintptr_t>(ptr));
+                rec->size = size;
+                rec->caller = std::uint64_t(reinterpret_cast<std::uintptr_t>(caller));
+                rec->thread = ring.thread;
+                rec->op = std::uint8_t(op);
+                rec->alignment = std::uint8_t(detail::log2(alignment));
+                rec->reserved = 0;
+                ring.push();
+            }
+
+            void open()
+            {
+                serial = ++detail::next_tracing_serial();
+                start_time = Clock::now();
+                start_ticks = detail::trace_ticks();
+                stopping = false;
+                out->write(detail::tracing_magic, sizeof(detail::tracing_magic));
+                flusher = std::thread(&tracing_storage::run, this);
+            }
+
+            void run()
+            {
+                std::unique_lock<std::mutex> lock(stop_guard);
+                while (!stopping)
+                {
+                    wake.wait_for(lock, interval);
+                    lock.unlock();
+                    flush();
+                    lock.lock();
+                }
+            }
+
+        public:
+            /// trace to a new file at path. throws std::runtime_error if it cannot be made
+            explicit tracing_storage(const char *path, bool callers = false
+                , std::chrono::milliseconds flush_interval = std::chrono::milliseconds(100))
+                : trace_callers(callers), interval(flush_interval)
+                , file(new std::ofstream(path, std::ios::binary | std::ios::trunc)), out(file.get())
+            {
+                if (!*file)
+                    throw std::runtime_error(std::string("tracing_storage: cannot write ") + path);
+                open();
+            }
+
+            /// trace to a stream, which must outlive the storage
+            explicit tracing_storage(std::ostream &trace, bool callers = false
+                , std::chrono::milliseconds flush_interval = std::chrono::milliseconds(100))
+                : trace_callers(callers), interval(flush_interval), out(&trace)
+            {
+                open();
+            }
+
+            ~tracing_storage()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(stop_guard);
+                    stopping = true;
+                }
+                wake.notify_one();
+                flusher.join();
+                flush();
+            }
+
+            /// write everything recorded so far to the file now
+            void flush()
+            {
+                std::lock_guard<std::mutex> lock(guard);
+                // measure the rate of the ticks over the life of the storage so far
+                std::uint64_t ticks = detail::trace_ticks();
+                double ns = std::chrono::duration<double, std::nano>(Clock::now() - start_time).count();
+                double ns_per_tick = ticks > start_ticks ? ns/(ticks - start_ticks) : 1;
+                for (size_t n = 0; n < rings.size(); ++n)
+                    rings[n]->drain(*out, start_ticks, ns_per_tick);
+                out->flush();
+            }
+
+            /// the number of events that were dropped because a ring was full
+            size_t dropped() const
+            {
+                std::lock_guard<std::mutex> lock(guard);
+                size_t total = 0;
+                for (size_t n = 0; n < rings.size(); ++n)
+                    total += rings[n]->dropped.load(std::memory_order_relaxed);
+                return total;
+            }
+
+            Storage &get_storage()
+            {
+                return store;
+            }
+
+            using storage_base::allocate;
+
+            void *allocate(size_t num_bytes, size_t alignment)
+            {
+                void *ptr = store.allocate(num_bytes, alignment);
+                trace(trace_allocate, ptr, num_bytes, alignment, trace_callers ? BOOST_MONOTONIC_RETURN_ADDRESS() : 0);
+                return ptr;
+            }
+
+            void deallocate(void *ptr)
+            {
+                store.deallocate(ptr);
+                trace(trace_deallocate, ptr, 0, 1, trace_callers ? BOOST_MONOTONIC_RETURN_ADDRESS() : 0);
+            }
+
+            bool extend(void *ptr, size_t num_bytes, size_t new_num_bytes)
+            {
+                if (!store.extend(ptr, num_bytes, new_num_bytes))
+                    return false;
+                trace(trace_extend, ptr, new_num_bytes, 1, trace_callers ? BOOST_MONOTONIC_RETURN_ADDRESS() : 0);
+                return true;
+            }
+
+            void reset()
+            {
+                store.reset();
+                trace(trace_reset, 0, 0, 1, trace_callers ? BOOST_MONOTONIC_RETURN_ADDRESS() : 0);
+            }
+
+            void release()
+            {
+                store.release();
+                trace(trace_release, 0, 0, 1, trace_callers ? BOOST_MONOTONIC_RETURN_ADDRESS() : 0);
+            }
+
+            size_t max_size() const
+            {
+                return store.max_size();
+            }
+
+            size_t used() const
+            {
+                return store.used();
+            }
+
+            size_t remaining() const
+            {
+                return store.remaining();
+            }
+        };
+
+        /// read a file written by tracing_storage, appending its records sorted by time.
+        /// throws std::runtime_error if the stream does not hold one
+        inline void read_trace_records(std::istream &in, std::vector<trace_record> &records)
+        {
+            char magic[sizeof(detail::tracing_magic)];
+            if (!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), detail::tracing_magic))
+                throw std::runtime_error("trace: not a tracing_storage file, or of another version");
+            size_t first = records.size();
+            trace_record rec;
+            while (in.read(reinterpret_cast<char *>(&rec), sizeof(rec)))
+            {
+                if (rec.op > trace_release)
+                    throw std::runtime_error("trace: bad event");
+                records.push_back(rec);
+            }
+            if (in.gcount() != 0)
+                throw std::runtime_error("trace: truncated event");
+            std::stable_sort(records.begin() + first, records.end(),
+                [](trace_record const &a, trace_record const &b) { return a.time < b.time; });
+        }
+
+        /// convert records to the events of read_trace(), numbering the allocations by
+        /// the order they were made. allocations that failed, and deallocations and extends
+        /// of memory that was not allocated since the last reset, are left out
+        inline void to_trace_events(std::vector<trace_record> const &records, std::vector<trace_event> &events)
+        {
+            std::unordered_map<std::uint64_t, std::uint64_t> live;
+            std::uint64_t next_id = 0;
+            for (size_t n = 0; n < records.size(); ++n)
+            {
+                trace_record const &rec = records[n];
+                trace_event event = trace_event();
+                event.op = trace_op(rec.op);
+                event.thread = rec.thread;
+                event.size = rec.size;
+                event.alignment = std::uint32_t(1) << (rec.alignment & 31);
+                switch (event.op)
+                {
+                case trace_allocate:
+                    if (rec.address == 0)
+                        continue;
+                    event.id = live[rec.address] = next_id++;
+                    break;
+                case trace_deallocate:
+                case trace_extend:
+                {
+                    std::unordered_map<std::uint64_t, std::uint64_t>::iterator found = live.find(rec.address);
+                    if (found == live.end())
+                        continue;
+                    event.id = found->second;
+                    if (event.op == trace_deallocate)
+                        live.erase(found);
+                    break;
+                }
+                default:
+                    live.clear();
+                    break;
+                }
+                events.push_back(event);
+            }
+        }
+
+    } // namespace monotonic
+
+} // namespace boost
+
+#include <monotonic/detail/postfix.hpp>
+
+#endif // BOOST_MONOTONIC_TRACING_STORAGE_HPP
+
+//EOF
@@ -0,0 +1,84 @@
+// Copyright (C) 2009-2020 Christian@Schladetsch.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// the memory used by the process, for the comparison programs
+
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <cstdlib>
+
+#if defined(_WIN32)
+#    include <windows.h>
+#    include <psapi.h>
+#    pragma comment(lib, "psapi.lib")
+#elif !defined(__linux__)
+#    include <sys/resource.h>
+#endif
+
+#if defined(__linux__)
+/// the value in bytes of a field of /proc/self/status, or 0 if it is not there
+inline size_t proc_status_bytes(const char *field)
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    size_t len = std::string(field).size();
+    while (std::getline(status, line))
+    {
+        if (line.compare(0, len, field) == 0)
+            return size_t(atol(line.c_str() + len))*1024;
+    }
+    return 0;
+}
+#endif
+
+/// the resident set size of the process in bytes, or 0 if it is not known
+inline size_t current_rss()
+{
+#if defined(__linux__)
+    return proc_status_bytes("VmRSS:");
+#elif defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+    return counters.WorkingSetSize;
+#else
+    return 0;
+#endif
+}
+
+/// the peak resident set size of the process in bytes, or 0 if it is not known
+inline size_t peak_rss()
+{
+#if defined(__linux__)
+    return proc_status_bytes("VmHWM:");
+#elif defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#    if defined(__APPLE__)
+    return size_t(usage.ru_maxrss);
+#    else
+    return size_t(usage.ru_maxrss)*1024;
+#    endif
+#endif
+}
+
+/// start a new peak for peak_rss(). this is only possible on linux; elsewhere the peak
+/// is that of the whole process so far
+inline void reset_peak_rss()
+{
+#if defined(__linux__)
+    std::ofstream("/proc/self/clear_refs") << "5";
+#endif
+}
+
+//EOF
@@ -10,9 +10,8 @@
 
 struct PoolResult 
 {
-    typedef boost::timer::nanosecond_type nanoseconds;
-    nanoseconds pool_elapsed;
-    nanoseconds fast_pool_elapsed;
+    // not integral, so that results divided by another keep their fraction
+    typedef double nanoseconds;
     nanoseconds mono_elapsed;
     nanoseconds local_mono_elapsed;
     nanoseconds std_elapsed;
@@ -20,13 +19,11 @@ struct PoolResult
 
     PoolResult(nanoseconds d = 0)
     {
-        tbb_elapsed = pool_elapsed = fast_pool_elapsed = mono_elapsed = local_mono_elapsed = std_elapsed = d;
+        tbb_elapsed = mono_elapsed = local_mono_elapsed = std_elapsed = d;
     }
 
     PoolResult& operator+=(PoolResult const &A)
     {
-        pool_elapsed += A.pool_elapsed;
-        fast_pool_elapsed += A.fast_pool_elapsed;
         mono_elapsed += A.mono_elapsed;
         local_mono_elapsed += A.local_mono_elapsed;
         std_elapsed += A.std_elapsed;
@@ -36,8 +33,6 @@ struct PoolResult
 
     PoolResult& operator-=(PoolResult const &A)
     {
-        pool_elapsed -= A.pool_elapsed;
-        fast_pool_elapsed -= A.fast_pool_elapsed;
         mono_elapsed -= A.mono_elapsed;
         local_mono_elapsed -= A.local_mono_elapsed;
         std_elapsed -= A.std_elapsed;
@@ -47,8 +42,6 @@ struct PoolResult
 
     PoolResult& operator*=(PoolResult const &A)
     {
-        pool_elapsed *= A.pool_elapsed;
-        fast_pool_elapsed *= A.fast_pool_elapsed;
         mono_elapsed *= A.mono_elapsed;
         local_mono_elapsed *= A.local_mono_elapsed;
         std_elapsed *= A.std_elapsed;
@@ -58,13 +51,11 @@ struct PoolResult
 
     nanoseconds mul(nanoseconds ns, double x)
     {
-        return (nanoseconds)(ns * x);
+        return ns * x;
     }
 
     PoolResult& operator*=(double A)
     {
-        pool_elapsed = mul(pool_elapsed, A);
-        fast_pool_elapsed = mul(fast_pool_elapsed, A);
         mono_elapsed = mul(mono_elapsed, A);
         local_mono_elapsed = mul(local_mono_elapsed, A);
         std_elapsed = mul(std_elapsed, A);
@@ -75,10 +66,8 @@ struct PoolResult
     void update_min(PoolResult const &other)
     {
         // reject very small mins as we sometimes have 0-element tests
-        if (other.fast_pool_elapsed > 0.01)
-            fast_pool_elapsed = std::min(fast_pool_elapsed, other.fast_pool_elapsed);
-        if (other.pool_elapsed > 0.01)
-            pool_elapsed = std::min(pool_elapsed, other.pool_elapsed);
+        if (other.mono_elapsed > 0.01)
+            mono_elapsed = std::min(mono_elapsed, other.mono_elapsed);
         if (other.tbb_elapsed > 0.01)
             tbb_elapsed = std::min(tbb_elapsed, other.tbb_elapsed);
         if (other.std_elapsed > 0.01)
@@ -86,8 +75,7 @@ struct PoolResult
     }
     void update_max(PoolResult const &other)
     {
-        fast_pool_elapsed = std::max(fast_pool_elapsed, other.fast_pool_elapsed);
-        pool_elapsed = std::max(pool_elapsed, other.pool_elapsed);
+        mono_elapsed = std::max(mono_elapsed, other.mono_elapsed);
         tbb_elapsed = std::max(tbb_elapsed, other.tbb_elapsed);
         std_elapsed = std::max(std_elapsed, other.std_elapsed);
     }
@@ -96,11 +84,10 @@ struct PoolResult
 inline PoolResult sqrt(PoolResult const &A)
 {
     PoolResult R(A);
-    R.fast_pool_elapsed = (PoolResult::nanoseconds)sqrt((double)R.fast_pool_elapsed); 
-    R.mono_elapsed = (PoolResult::nanoseconds)sqrt((double)R.mono_elapsed); 
-    R.local_mono_elapsed = (PoolResult::nanoseconds)sqrt((double)R.local_mono_elapsed); 
-    R.std_elapsed = (PoolResult::nanoseconds)sqrt((double)R.std_elapsed); 
-    R.tbb_elapsed = (PoolResult::nanoseconds)sqrt((double)R.tbb_elapsed); 
+    R.mono_elapsed = sqrt(R.mono_elapsed);
+    R.local_mono_elapsed = sqrt(R.local_mono_elapsed);
+    R.std_elapsed = sqrt(R.std_elapsed);
+    R.tbb_elapsed = sqrt(R.tbb_elapsed);
     return R;
 }
 
@@ -0,0 +1,223 @@
+// Copyright (C) 2009-2020 Christian@Schladetsch.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// the results of compare_memory_pool as csv or json, as written by the harness and read
+// by compare_results.
+//
+// each record is one timed run of one test at one length with one allocator. a csv file
+// has a header line and then one line per record:
+//
+//      section,test,allocator,length,count,run,elapsed_ns
+//      SMALL,list_create<int>,std,10,5000,0,1234567
+//
+// a json file is an array of objects with the same fields. names of sections, tests and
+// allocators never hold commas or quotes.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <cctype>
+
+struct ResultRecord
+{
+    std::string section;
+    std::string test;
+    std::string allocator;
+    size_t length;
+    size_t count;
+    size_t run;
+    double elapsed_ns;
+
+    ResultRecord() : length(0), count(0), run(0), elapsed_ns(0) { }
+
+    /// the test, length and allocator that runs of this record are compared by
+    std::string key() const
+    {
+        std::ostringstream str;
+        str << section << '/' << test << '/' << length << '/' << allocator;
+        return str.str();
+    }
+};
+
+typedef std::vector<ResultRecord> ResultRecords;
+
+/// writes records to a csv and/or a json stream, either of which may be null
+class ResultWriter
+{
+    std::ostream *csv;
+    std::ostream *json;
+    bool first;
+
+    // times are whole nanoseconds, but too large to print as a double without an exponent
+    static long long integral(double ns)
+    {
+        return (long long)(ns + 0.5);
+    }
+
+public:
+    ResultWriter(std::ostream *csv_out = 0, std::ostream *json_out = 0)
+        : csv(csv_out), json(json_out), first(true)
+    {
+        if (csv)
+            *csv << "section,test,allocator,length,count,run,elapsed_ns" << std::endl;
+        if (json)
+            *json << "[";
+    }
+
+    ~ResultWriter()
+    {
+        if (json)
+            *json << (first ? "]" : "\n]") << std::endl;
+    }
+
+    void write(ResultRecord const &rec)
+    {
+        if (csv)
+            *csv << rec.section << ',' << rec.test << ',' << rec.allocator << ',' << rec.length
+                << ',' << rec.count << ',' << rec.run << ',' << integral(rec.elapsed_ns) << std::endl;
+        if (json)
+        {
+            *json << (first ? "\n" : ",\n") << "  {\"section\": \"" << rec.section
+                << "\", \"test\": \"" << rec.test << "\", \"allocator\": \"" << rec.allocator
+                << "\", \"length\": " << rec.length << ", \"count\": " << rec.count
+                << ", \"run\": " << rec.run << ", \"elapsed_ns\": " << integral(rec.elapsed_ns) << "}";
+            json->flush();
+        }
+        first = false;
+    }
+};
+
+namespace result_file_detail
+{
+    inline void set_field(ResultRecord &rec, std::string const &name, std::string const &value)
+    {
+        if (name == "section")
+            rec.section = value;
+        else if (name == "test")
+            rec.test = value;
+        else if (name == "allocator")
+            rec.allocator = value;
+        else if (name == "length")
+            rec.length = std::stoul(value);
+        else if (name == "count")
+            rec.count = std::stoul(value);
+        else if (name == "run")
+            rec.run = std::stoul(value);
+        else if (name == "elapsed_ns")
+            rec.elapsed_ns = std::stod(value);
+    }
+
+    inline ResultRecords read_csv(std::istream &in)
+    {
+        ResultRecords records;
+        std::string line;
+        std::vector<std::string> names;
+        while (std::getline(in, line))
+        {
+            if (!line.empty() && line[line.size() - 1] == '\r')
+                line.erase(line.size() - 1);
+            if (line.empty())
+                continue;
+            std::vector<std::string> fields;
+            std::istringstream str(line);
+            std::string field;
+            while (std::getline(str, field, ','))
+                fields.push_back(field);
+            // the header names the columns. files that were concatenated repeat it
+            if (fields.size() > 0 && fields[0] == "section")
+            {
+                names = fields;
+                continue;
+            }
+            if (names.empty() || fields.size() != names.size())
+                throw std::runtime_error("bad csv line: " + line);
+            ResultRecord rec;
+            for (size_t n = 0; n < names.size(); ++n)
+                set_field(rec, names[n], fields[n]);
+            records.push_back(rec);
+        }
+        return records;
+    }
+
+    inline void skip_space(std::istream &in)
+    {
+        while (in && std::isspace(in.peek()))
+            in.get();
+    }
+
+    inline void expect(std::istream &in, char ch)
+    {
+        skip_space(in);
+        if (in.get() != ch)
+            throw std::runtime_error(std::string("bad json: expected '") + ch + "'");
+    }
+
+    /// reads a string or a number
+    inline std::string read_value(std::istream &in)
+    {
+        skip_space(in);
+        std::string value;
+        if (in.peek() == '"')
+        {
+            in.get();
+            char ch;
+            while (in.get(ch) && ch != '"')
+                value += ch;
+            return value;
+        }
+        while (in && in.peek() != ',' && in.peek() != '}' && !std::isspace(in.peek()))
+            value += char(in.get());
+        return value;
+    }
+
+    /// reads an array of flat objects, as written by ResultWriter
+    inline ResultRecords read_json(std::istream &in)
+    {
+        ResultRecords records;
+        expect(in, '[');
+        skip_space(in);
+        if (in.peek() == ']')
+            return records;
+        for (;;)
+        {
+            expect(in, '{');
+            ResultRecord rec;
+            for (;;)
+            {
+                std::string name = read_value(in);
+                expect(in, ':');
+                set_field(rec, name, read_value(in));
+                skip_space(in);
+                char ch = char(in.get());
+                if (ch == '}')
+                    break;
+                if (ch != ',')
+                    throw std::runtime_error("bad json: expected ',' or '}'");
+            }
+            records.push_back(rec);
+            skip_space(in);
+            char ch = char(in.get());
+            if (ch == ']')
+                return records;
+            if (ch != ',')
+                throw std::runtime_error("bad json: expected ',' or ']'");
+        }
+    }
+}
+
+/// read records written as csv or json, telling which from the first character
+inline ResultRecords read_results(std::istream &in)
+{
+    result_file_detail::skip_space(in);
+    if (in.peek() == '[')
+        return result_file_detail::read_json(in);
+    return result_file_detail::read_csv(in);
+}
+
+//EOF
@@ -21,6 +21,20 @@ struct test_vector_create
     }
 };
 
+// as test_vector_create, but the vector is given the allocator it is to use rather
+// than default-constructing one. for monotonic allocators, this measures the cost of
+// resolving the static storage for each container.
+struct test_vector_create_given
+{
+    template <class Alloc>
+    int test(Alloc alloc, size_t length) const
+    {
+        typedef typename Rebind<Alloc, int>::type Allocator;
+        std::vector<int, Allocator> vector(length*rand()/RAND_MAX, 0, Allocator(alloc));
+        return vector.size();
+    }
+};
+
 struct test_vector_dupe
 {
     template <class Alloc>
@@ -97,6 +111,47 @@ struct test_list_dupe
     }
 };
 
+// as test_list_create, but with monotonic allocators the list is a monotonic::ilist,
+// whose nodes are made directly in the storage
+template <class Ty>
+struct test_ilist_create
+{
+    template <class Alloc>
+    int test(Alloc alloc, size_t length) const
+    {
+        return test_list_create<Ty>().test(alloc, length);
+    }
+
+    template <class T, class Region, class Access>
+    int test(boost::monotonic::allocator<T, Region, Access> alloc, size_t length) const
+    {
+        boost::monotonic::ilist<Ty, Region, Access> list(alloc);
+        std::fill_n(std::back_inserter(list), length, 42);
+        return 0;
+    }
+};
+
+// as test_list_dupe, but with monotonic allocators the list is a monotonic::ilist,
+// which copies all nodes with one allocation
+struct test_ilist_dupe
+{
+    template <class Alloc>
+    int test(Alloc alloc, size_t length) const
+    {
+        return test_list_dupe().test(alloc, length);
+    }
+
+    template <class T, class Region, class Access>
+    int test(boost::monotonic::allocator<T, Region, Access> alloc, size_t length) const
+    {
+        typedef boost::monotonic::ilist<int, Region, Access> List;
+        List list(alloc);
+        std::fill_n(std::back_inserter(list), length, 42);
+        List dupe = list;
+        return dupe.size();
+    }
+};
+
 template <class Ty>
 struct test_list_sort
 {
@@ -111,6 +166,28 @@ struct test_list_sort
     }
 };
 
+// as test_list_sort, but with monotonic allocators the list is a monotonic::unrolled_list
+template <class Ty>
+struct test_unrolled_list_sort
+{
+    template <class Alloc>
+    int test(Alloc alloc, size_t length) const
+    {
+        return test_list_sort<Ty>().test(alloc, length);
+    }
+
+    template <class T, class Region, class Access>
+    int test(boost::monotonic::allocator<T, Region, Access> alloc, size_t length) const
+    {
+        typedef boost::monotonic::unrolled_list<Ty, boost::monotonic::detail::unrolled_capacity<Ty>::value, Region, Access> List;
+        List list(alloc);
+        for (size_t n = 0; n < length; ++n)
+            list.push_back(length - n);
+        list.sort();
+        return 0;
+    }
+};
+
 struct test_set_vector
 {
     template <class Alloc>
@@ -156,7 +233,99 @@ struct test_map_vector
         return test_map_vector_impl<std::map<int
             , std::vector<Ty, typename Rebind<Alloc, Ty>::type>
             , std::less<int>
-            , typename Rebind<Alloc, int>::type> >(length);
+            , typename Rebind<Alloc, std::pair<const int, std::vector<Ty, typename Rebind<Alloc, Ty>::type> > >::type> >(length);
+    }
+};
+
+// as test_map_vector, but with monotonic allocators the vectors are small_vectors
+// that hold their first eight elements inline
+template <class Ty>
+struct test_map_small_vector
+{
+    template <class Alloc>
+    int test(Alloc alloc, size_t length) const
+    {
+        return test_map_vector<Ty>().test(alloc, length);
+    }
+
+    template <class T, class Region, class Access>
+    int test(boost::monotonic::allocator<T, Region, Access> alloc, size_t length) const
+    {
+        return test_map_vector_impl<boost::monotonic::map<int
+            , boost::monotonic::small_vector<Ty, 8, Region, Access>
+            , Region
+            , std::less<int>
+            , Access> >(length);
+    }
+};
+
+template <class Map>
+int test_map_lookup_impl(Map &map, size_t length)
+{
+    for (size_t n = 0; n < length; ++n)
+        map.insert(std::make_pair(random_numbers[n], int(n)));
+    int found = 0;
+    for (size_t n = 0; n < length; ++n)
+        found += map.find(random_numbers[n] + int(n & 1)) != map.end();
+    for (typename Map::const_iterator iter = map.begin(); iter != map.end(); ++iter)
+        found += (*iter).second & 1;
+    return found;
+}
+
+// insert random keys, look them up, then scan the map in order. monotonic
+// allocators use a btree_map
+struct test_map_lookup
+{
+    template <class Alloc>
+    int test(Alloc alloc, size_t length) const
+    {
+        std::map<int, int, std::less<int>, typename Rebind<Alloc, std::pair<const int, int> >::type> map;
+        return test_map_lookup_impl(map, length);
+    }
+
+    template <class T, class Region, class Access>
+    int test(boost::monotonic::allocator<T, Region, Access> alloc, size_t length) const
+    {
+        boost::monotonic::btree_map<int, int, Region, std::less<int>, Access> map(alloc);
+        return test_map_lookup_impl(map, length);
+    }
+};
+
+// build two filters of length bits, combine them and count the result. monotonic
+// allocators use a dynamic_bitset, others a std::vector of the same 64-bit blocks,
+// combined and counted the same way, so that only the allocation differs
+struct test_bitset_filter
+{
+    template <class Alloc>
+    int test(Alloc alloc, size_t length) const
+    {
+        using namespace boost::monotonic::detail;
+        typedef std::vector<bitset_block, typename Rebind<Alloc, bitset_block>::type> Bits;
+        Bits a((length + 63)/64), b((length + 63)/64);
+        for (size_t n = 0; n < length; ++n)
+        {
+            bitset_block mask = bitset_block(1) << n % 64;
+            if (random_numbers[n] & 1)
+                a[n/64] |= mask;
+            if (random_numbers[n] & 2)
+                b[n/64] |= mask;
+        }
+        bitset_combine<bitset_and>(a.data(), b.data(), a.size());
+        return int(bitset_count(a.data(), a.size()));
+    }
+
+    template <class T, class Region, class Access>
+    int test(boost::monotonic::allocator<T, Region, Access> alloc, size_t length) const
+    {
+        typedef boost::monotonic::dynamic_bitset<Region, Access> Bits;
+        Bits a(length, alloc), b(length, alloc);
+        for (size_t n = 0; n < length; ++n)
+        {
+            a[n] = random_numbers[n] & 1;
+            b[n] = random_numbers[n] & 2;
+        }
+        a &= b;
+        return int(a.count());
     }
 };
 
@@ -168,7 +337,7 @@ struct test_map_list_unaligned
         std::map<int
             , std::list<Unaligned, typename Rebind<Alloc, Unaligned>::type>
             , std::less<int>
-            , typename Rebind<Alloc, int>::type
+            , typename Rebind<Alloc, std::pair<const int, std::list<Unaligned, typename Rebind<Alloc, Unaligned>::type> > >::type
         > map;
         size_t mod = length/10;
         for (size_t n = 0; n < length; ++n)
@@ -220,7 +389,7 @@ struct test_map_erase
     template <class Alloc>
     int test(Alloc alloc, size_t length) const
     {
-        typedef std::map<int, int, std::less<int>, typename Rebind<Alloc, int>::type> Map;
+        typedef std::map<int, int, std::less<int>, typename Rebind<Alloc, std::pair<const int, int> >::type> Map;
 
         Map map;
         std::copy(random_pairs.begin(), random_pairs.begin() + length, inserter(map, map.begin()));
@@ -0,0 +1,245 @@
+// Copyright (C) 2009-2020 Christian@Schladetsch.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// microbenchmarks of the allocation fast paths, using google benchmark.
+//
+// usage: bench_allocate [google benchmark options], for example
+//     bench_allocate --benchmark_filter=storage --benchmark_repetitions=5
+//     bench_allocate --benchmark_out=after.json --benchmark_out_format=json
+//
+// each benchmark is given the size and alignment of an allocation, and makes allocations
+// of that size until Batch have been made, then resets its storage and starts again, so
+// that it measures the path it is named for rather than running out of room or growing
+// the heap. the cost of the reset is included, but is shared by the whole batch.
+// storage<> is measured on each of its paths: sizes and alignments that fit a pool, those
+// that do not and so come from the inline buffer, and from the heap when there is none.
+//
+// two runs may be compared with the compare.py tool that comes with google benchmark.
+
+#include <cstddef>
+#include <chrono>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <monotonic/fixed_storage.hpp>
+#include <monotonic/storage.hpp>
+#include <monotonic/allocator.hpp>
+#include <monotonic/stack.hpp>
+#include <monotonic/tracing_storage.hpp>
+
+using namespace boost;
+
+enum { Batch = 1024 };
+
+const std::vector<int64_t> any_sizes = { 8, 24, 64, 256, 1024 };
+const std::vector<int64_t> any_alignments = { 1, 8, 16, 64 };
+
+void set_labels(benchmark::State &state)
+{
+    state.SetItemsProcessed(state.iterations());
+    state.counters["size"] = double(state.range(0));
+    state.counters["align"] = double(state.range(1));
+}
+
+/// allocate from buffer until a batch is made, then reset it
+template <class Buffer>
+void allocate_batches(benchmark::State &state, Buffer &buffer)
+{
+    size_t size = size_t(state.range(0));
+    size_t alignment = size_t(state.range(1));
+    size_t count = 0;
+    for (auto _ : state)
+    {
+        void *ptr = buffer.allocate(size, alignment);
+        benchmark::DoNotOptimize(ptr);
+        if (++count == Batch)
+        {
+            count = 0;
+            buffer.reset();
+        }
+    }
+    set_labels(state);
+}
+
+void fixed_storage_allocate(benchmark::State &state)
+{
+    // enough for a batch of the largest size with the most padding
+    std::unique_ptr<monotonic::fixed_storage<Batch*(1024 + 64)> > fixed(new monotonic::fixed_storage<Batch*(1024 + 64)>());
+    allocate_batches(state, *fixed);
+}
+BENCHMARK(fixed_storage_allocate)->ArgsProduct({ any_sizes, any_alignments });
+
+void link_allocate(benchmark::State &state)
+{
+    monotonic::detail::Link<std::allocator<char> > link(std::allocator<char>(), Batch*(1024 + 64));
+    allocate_batches(state, link);
+    link.release();
+}
+BENCHMARK(link_allocate)->ArgsProduct({ any_sizes, any_alignments });
+
+/// what a Pool takes its chunks from: a buffer that is reset with the pool
+struct PoolSource
+{
+    monotonic::fixed_storage<1024*1024> fixed;
+
+    void *from_fixed(size_t num_bytes, size_t alignment)
+    {
+        return fixed.allocate(num_bytes, alignment);
+    }
+    void *from_heap(size_t, size_t)
+    {
+        return 0;
+    }
+};
+
+void pool_allocate(benchmark::State &state)
+{
+    std::unique_ptr<PoolSource> source(new PoolSource());
+    monotonic::detail::Pool pool(size_t(state.range(0)));
+    size_t count = 0;
+    for (auto _ : state)
+    {
+        void *ptr = pool.allocate(*source);
+        benchmark::DoNotOptimize(ptr);
+        if (++count == Batch)
+        {
+            count = 0;
+            pool.reset();
+            source->fixed.reset();
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["size"] = double(state.range(0));
+}
+// the bucket sizes of storage<>
+BENCHMARK(pool_allocate)->Arg(16)->Arg(32)->Arg(64)->Arg(112);
+
+// storage<> takes sizes up to 111 bytes with alignment up to 16 from a pool
+void storage_allocate_pool(benchmark::State &state)
+{
+    std::unique_ptr<monotonic::storage<> > store(new monotonic::storage<>());
+    allocate_batches(state, *store);
+}
+BENCHMARK(storage_allocate_pool)->ArgsProduct({ { 8, 24, 64, 96 }, { 1, 8, 16 } });
+
+// larger or more aligned requests come from the inline buffer
+void storage_allocate_fixed(benchmark::State &state)
+{
+    std::unique_ptr<monotonic::storage<Batch*(1024 + 64)> > store(new monotonic::storage<Batch*(1024 + 64)>());
+    allocate_batches(state, *store);
+}
+BENCHMARK(storage_allocate_fixed)->ArgsProduct({ { 128, 256, 1024 }, { 8, 64 } })->Args({ 8, 64 });
+
+// and from a heap link when there is no inline buffer, or it is full
+void storage_allocate_heap(benchmark::State &state)
+{
+    monotonic::storage<0, 4*1024*1024> store;
+    allocate_batches(state, store);
+}
+BENCHMARK(storage_allocate_heap)->ArgsProduct({ { 128, 256, 1024 }, { 8, 64 } })->Args({ 8, 64 });
+
+// tracing_storage adds the cost of recording each request to the storage<> it wraps.
+// most of that is reading the clock, which trace_ticks measures alone
+void trace_ticks(benchmark::State &state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(monotonic::detail::trace_ticks());
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(trace_ticks);
+
+// each iteration is a batch of allocations, timed by hand so that draining the rings
+// between batches, as the flusher would on another core, is not counted. the trace
+// is discarded. "per_allocation" is the time of one traced allocation
+void tracing_storage_allocate(benchmark::State &state)
+{
+    typedef std::chrono::steady_clock Clock;
+    std::ostream discard(0);
+    std::unique_ptr<monotonic::tracing_storage<monotonic::storage<> > > store(
+        new monotonic::tracing_storage<monotonic::storage<> >(discard, false, std::chrono::hours(1)));
+    size_t size = size_t(state.range(0));
+    size_t alignment = size_t(state.range(1));
+    for (auto _ : state)
+    {
+        Clock::time_point start = Clock::now();
+        for (size_t n = 0; n < Batch; ++n)
+        {
+            void *ptr = store->allocate(size, alignment);
+            benchmark::DoNotOptimize(ptr);
+        }
+        store->reset();
+        state.SetIterationTime(std::chrono::duration<double>(Clock::now() - start).count());
+        store->flush();
+    }
+    set_labels(state);
+    state.SetItemsProcessed(state.iterations()*Batch);
+    state.counters["per_allocation"] = benchmark::Counter(double(state.iterations()*Batch)
+        , benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+    state.counters["dropped"] = double(store->dropped());
+}
+BENCHMARK(tracing_storage_allocate)->ArgsProduct({ { 8, 64 }, { 8 } })->UseManualTime();
+
+/// an object of the given size and alignment
+template <size_t Size, size_t Align>
+struct alignas(Align) Payload
+{
+    char bytes[Size];
+};
+
+// allocator_base::allocate calls storage_base::allocate through a pointer, so it pays
+// for a virtual call that storage<>::allocate above does not
+template <class T>
+void allocator_allocate(benchmark::State &state)
+{
+    std::unique_ptr<monotonic::storage<> > store(new monotonic::storage<>());
+    monotonic::allocator<T> alloc(*store);
+    size_t count = 0;
+    for (auto _ : state)
+    {
+        T *ptr = alloc.allocate(1);
+        benchmark::DoNotOptimize(ptr);
+        if (++count == Batch)
+        {
+            count = 0;
+            store->reset();
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["size"] = double(sizeof(T));
+    state.counters["align"] = double(alignof(T));
+}
+BENCHMARK_TEMPLATE(allocator_allocate, Payload<8, 8>);
+BENCHMARK_TEMPLATE(allocator_allocate, Payload<64, 16>);
+BENCHMARK_TEMPLATE(allocator_allocate, Payload<64, 64>);
+BENCHMARK_TEMPLATE(allocator_allocate, Payload<256, 8>);
+BENCHMARK_TEMPLATE(allocator_allocate, Payload<1024, 64>);
+
+// the elements of a fixed_stack are pushed and popped in pairs, so the stack stays small
+template <class T>
+void fixed_stack_push_pop(benchmark::State &state)
+{
+    std::unique_ptr<monotonic::fixed_stack<> > stack(new monotonic::fixed_stack<>());
+    for (auto _ : state)
+    {
+        T &top = stack->template push<T>();
+        benchmark::DoNotOptimize(&top);
+        stack->pop();
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["size"] = double(sizeof(T));
+    state.counters["align"] = double(alignof(T));
+}
+BENCHMARK_TEMPLATE(fixed_stack_push_pop, Payload<8, 8>);
+BENCHMARK_TEMPLATE(fixed_stack_push_pop, Payload<64, 16>);
+BENCHMARK_TEMPLATE(fixed_stack_push_pop, Payload<64, 64>);
+BENCHMARK_TEMPLATE(fixed_stack_push_pop, Payload<256, 8>);
+BENCHMARK_TEMPLATE(fixed_stack_push_pop, Payload<1024, 64>);
+
+BENCHMARK_MAIN();
+
+//EOF
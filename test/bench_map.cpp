@@ -0,0 +1,149 @@
+// Copyright (C) 2009-2020 Christian@Schladetsch.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// microbenchmarks of lookups in heterogenous::map, using google benchmark.
+//
+// usage: bench_map [google benchmark options]
+//
+// each benchmark fills a map with the given number of polymorphic keys, then looks up
+// keys that are equal to, but distinct from, those in the map, in a shuffled order.
+// hashed_map_find measures heterogenous::map. ordered_map_find measures the std::map of
+// key and value pointers, ordered by the keys, that heterogenous::map used to be, with
+// its nodes in the same monotonic storage.
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <monotonic/storage.hpp>
+#include <monotonic/allocator.hpp>
+#include <monotonic/heterogenous/map.hpp>
+
+using namespace boost;
+
+struct key_base
+{
+    virtual ~key_base() { }
+    virtual int id() const = 0;
+    friend bool operator<(key_base const &A, key_base const &B)
+    {
+        return A.id() < B.id();
+    }
+};
+
+/// two key types, so that lookups go through virtual calls as they would in use
+struct even_key : heterogenous::cloneable<even_key, key_base>
+{
+    int n;
+    even_key(int N = 0) : n(N) { }
+    int id() const { return n; }
+    size_t hash_value() const { return size_t(n) + 1; }
+};
+
+struct odd_key : heterogenous::cloneable<odd_key, key_base>
+{
+    int n;
+    odd_key(int N = 0) : n(N) { }
+    int id() const { return n; }
+    size_t hash_value() const { return size_t(n) + 1; }
+};
+
+struct value : heterogenous::cloneable<value, key_base>
+{
+    int n;
+    value(int N = 0) : n(N) { }
+    int id() const { return -1; }
+};
+
+typedef heterogenous::abstract_cloneable<key_base> abstract_key;
+
+/// distinct key objects equal to those in the map, in a shuffled order
+std::vector<std::unique_ptr<abstract_key> > make_probes(int count)
+{
+    std::vector<std::unique_ptr<abstract_key> > probes;
+    for (int n = 0; n < count; ++n)
+    {
+        if (n % 2)
+            probes.push_back(std::unique_ptr<abstract_key>(new odd_key(n)));
+        else
+            probes.push_back(std::unique_ptr<abstract_key>(new even_key(n)));
+    }
+    std::shuffle(probes.begin(), probes.end(), std::mt19937(42));
+    return probes;
+}
+
+void hashed_map_find(benchmark::State &state)
+{
+    int count = int(state.range(0));
+    monotonic::storage<> storage;
+    monotonic::allocator<int> alloc(storage);
+    typedef heterogenous::map<key_base, std::less<key_base>, monotonic::allocator<int> > Map;
+    Map map(alloc);
+    map.reserve(count);
+    for (int n = 0; n < count; ++n)
+    {
+        if (n % 2)
+            map.key<odd_key>(n).value<value>(n);
+        else
+            map.key<even_key>(n).value<value>(n);
+    }
+    std::vector<std::unique_ptr<abstract_key> > probes = make_probes(count);
+    size_t next = 0;
+    for (auto _ : state)
+    {
+        Map::iterator found = map.find(*probes[next]);
+        benchmark::DoNotOptimize(found);
+        if (++next == probes.size())
+            next = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(hashed_map_find)->Arg(64)->Arg(1024)->Arg(16*1024)->Arg(256*1024);
+
+/// orders key pointers by the keys they point to
+struct key_less
+{
+    bool operator()(abstract_key const *A, abstract_key const *B) const
+    {
+        return static_cast<key_base const &>(*A) < static_cast<key_base const &>(*B);
+    }
+};
+
+void ordered_map_find(benchmark::State &state)
+{
+    int count = int(state.range(0));
+    monotonic::storage<> storage;
+    typedef std::pair<abstract_key *const, abstract_key *> Entry;
+    typedef std::map<abstract_key *, abstract_key *, key_less, monotonic::allocator<Entry> > Map;
+    Map map{ key_less(), monotonic::allocator<Entry>(storage) };
+    monotonic::allocator<char> chars(storage);
+    heterogenous::make_clone_allocator<monotonic::allocator<char> >::type clones(chars);
+    for (int n = 0; n < count; ++n)
+    {
+        abstract_key *key = n % 2
+            ? static_cast<abstract_key *>(odd_key(n).clone(clones))
+            : static_cast<abstract_key *>(even_key(n).clone(clones));
+        map[key] = value(n).clone(clones);
+    }
+    std::vector<std::unique_ptr<abstract_key> > probes = make_probes(count);
+    size_t next = 0;
+    for (auto _ : state)
+    {
+        Map::iterator found = map.find(probes[next].get());
+        benchmark::DoNotOptimize(found);
+        if (++next == probes.size())
+            next = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(ordered_map_find)->Arg(64)->Arg(1024)->Arg(16*1024)->Arg(256*1024);
+
+BENCHMARK_MAIN();
+
+//EOF
@@ -0,0 +1,201 @@
+// Copyright (C) 2009-2020 Christian@Schladetsch.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// runs the workloads of Tests.h once each, and reports the memory each allocator used
+// for them rather than the time taken.
+//
+// for std::allocator this counts the bytes allocated and freed, and the most that were
+// live at once. for monotonic storage, which never frees, it reports the statistics of
+// the storage: the bytes asked for, the bytes used, and how many of those were lost to
+// alignment padding and to rounding and unused chunks in pools; the unused bytes at the
+// end of heap links, and how many links were made. used/live is how many times more
+// memory the storage used than the most that std::allocator had live for the same
+// workload, which shows the cost of never reusing the buffers a growing container
+// leaves behind. rss is how much the peak resident set size grew during the workload,
+// which is only known on linux.
+
+#define BOOST_MONOTONIC_STATISTICS
+
+#include <iostream>
+#include <iomanip>
+#include <numeric>
+#include <algorithm>
+#include <vector>
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <cstdlib>
+
+#include <boost/foreach.hpp>
+
+#include <monotonic/containers/string.hpp>
+#include <monotonic/containers/ilist.hpp>
+#include <monotonic/containers/unrolled_list.hpp>
+#include <monotonic/containers/btree_map.hpp>
+#include <monotonic/containers/map.hpp>
+#include <monotonic/containers/small_vector.hpp>
+#include <monotonic/containers/dynamic_bitset.hpp>
+
+#include "./AllocatorTypes.h"
+#include "./Tests.h"
+#include "./MemoryUsage.h"
+
+using namespace std;
+
+vector<int> random_numbers;
+vector<pair<int, int> > random_pairs;
+
+/// what a counting_allocator has done since the last reset()
+struct Counts
+{
+    size_t allocations, requested, freed, live, peak_live;
+
+    void reset()
+    {
+        allocations = requested = freed = live = peak_live = 0;
+    }
+};
+
+Counts counts;
+
+/// a std::allocator that counts into `counts`
+template <class T>
+struct counting_allocator : std::allocator<T>
+{
+    template <class U>
+    struct rebind
+    {
+        typedef counting_allocator<U> other;
+    };
+
+    counting_allocator() { }
+    template <class U>
+    counting_allocator(counting_allocator<U> const &) { }
+
+    T *allocate(size_t num, const void * = 0)
+    {
+        size_t bytes = num*sizeof(T);
+        ++counts.allocations;
+        counts.requested += bytes;
+        counts.live += bytes;
+        counts.peak_live = (max)(counts.peak_live, counts.live);
+        return std::allocator<T>::allocate(num);
+    }
+
+    void deallocate(T *ptr, size_t num)
+    {
+        counts.freed += num*sizeof(T);
+        counts.live -= num*sizeof(T);
+        std::allocator<T>::deallocate(ptr, num);
+    }
+};
+
+// the storage used by monotonic::allocator<int>
+typedef boost::monotonic::static_storage<boost::monotonic::default_region_tag, boost::monotonic::default_access_tag> MonoStorage;
+
+void print_heading()
+{
+    size_t w = 11;
+    cout << setw(8) << "len" << setw(7) << "alloc" << setw(9) << "allocs" << setw(w) << "requested" << setw(w) << "used"
+        << setw(w) << "padding" << setw(w) << "pool" << setw(w) << "link-slack" << setw(6) << "links"
+        << setw(w) << "freed" << setw(w) << "peak-live" << setw(10) << "used/live" << setw(w) << "rss" << endl;
+    cout << string(127, '-') << endl;
+}
+
+template <class Fun>
+void run_memory(size_t length, Fun fun)
+{
+    size_t w = 11;
+    const char *none = "-";
+
+    srand(42);
+    counts.reset();
+    size_t rss_before = current_rss();
+    reset_peak_rss();
+    fun.test(counting_allocator<int>(), length);
+    size_t std_rss = peak_rss() - (min)(rss_before, peak_rss());
+    Counts std_counts = counts;
+
+    cout << setw(8) << length << setw(7) << "std" << setw(9) << std_counts.allocations << setw(w) << std_counts.requested
+        << setw(w) << none << setw(w) << none << setw(w) << none << setw(w) << none << setw(6) << none
+        << setw(w) << std_counts.freed << setw(w) << std_counts.peak_live << setw(10) << none << setw(w) << std_rss << endl;
+
+    // start from no heap links, so that the links made and the rss are those of this workload
+    srand(42);
+    MonoStorage::release();
+    MonoStorage::get_storage().reset_statistics();
+    rss_before = current_rss();
+    reset_peak_rss();
+    fun.test(boost::monotonic::allocator<int>(), length);
+    size_t mono_rss = peak_rss() - (min)(rss_before, peak_rss());
+    boost::monotonic::storage_statistics stats = MonoStorage::get_storage().get_statistics();
+    size_t used = MonoStorage::used();
+    MonoStorage::release();
+
+    cout << setw(8) << length << setw(7) << "mono" << setw(9) << stats.allocations << setw(w) << stats.requested
+        << setw(w) << used << setw(w) << stats.padding << setw(w) << stats.pool_rounding + stats.pool_unused
+        << setw(w) << stats.link_unused << setw(6) << stats.links << setw(w) << none << setw(w) << none << setw(10);
+    if (std_counts.peak_live > 0)
+        cout << fixed << setprecision(2) << double(used)/std_counts.peak_live;
+    else
+        cout << none;
+    cout << setw(w) << mono_rss << endl;
+    cout.unsetf(ios::fixed);
+}
+
+template <class Fun>
+void run_tests(const char *title, Fun fun, size_t small, size_t medium, size_t large)
+{
+    cout << title << endl;
+    print_heading();
+    run_memory(small, fun);
+    run_memory(medium, fun);
+    run_memory(large, fun);
+    cout << endl;
+}
+
+pair<int, int> random_pair()
+{
+    return make_pair(rand(), rand());
+}
+
+int main()
+{
+    try
+    {
+        srand(42);
+        generate_n(back_inserter(random_numbers), 1000000, rand);
+        generate_n(back_inserter(random_pairs), 1000000, random_pair);
+
+        cout << "memory used by each allocator, in bytes" << endl << endl;
+        run_tests("string_cat", test_string_cat(), 100, 1000, 10000);
+        run_tests("list_string", test_list_string(), 100, 1000, 10000);
+        run_tests("list_create<int>", test_list_create<int>(), 100, 5000, 25000);
+        run_tests("ilist_create<int>", test_ilist_create<int>(), 100, 5000, 25000);
+        run_tests("list_sort<int>", test_list_sort<int>(), 100, 5000, 100000);
+        run_tests("unrolled_list_sort<int>", test_unrolled_list_sort<int>(), 100, 5000, 100000);
+        run_tests("vector_create<int>", test_vector_create(), 100, 5000, 100000);
+        run_tests("vector_sort<int>", test_vector_sort<int>(), 100, 5000, 50000);
+        run_tests("vector_dupe", test_vector_dupe(), 100, 5000, 1000000);
+        run_tests("list_dupe", test_list_dupe(), 100, 5000, 10000);
+        run_tests("ilist_dupe", test_ilist_dupe(), 100, 5000, 10000);
+        run_tests("vector_accumulate_unaligned", test_vector_accumulate_unaligned(), 100, 5000, 100000);
+        run_tests("map_vector<int>", test_map_vector<int>(), 100, 1000, 20000);
+        run_tests("map_small_vector<int>", test_map_small_vector<int>(), 100, 1000, 20000);
+        run_tests("map_list_unaligned", test_map_list_unaligned(), 100, 1000, 20000);
+        run_tests("map_lookup", test_map_lookup(), 100, 5000, 100000);
+        run_tests("bitset_filter", test_bitset_filter(), 1000, 100000, 1000000);
+    }
+    catch (exception &e)
+    {
+        cout << "exception: " << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+//EOF
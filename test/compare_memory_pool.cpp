@@ -8,6 +8,9 @@
 
 #include <iostream> 
 #include <iomanip> 
+#include <fstream>
+#include <cstdlib>
+#include <cstring>
 #include <numeric>
 #include <algorithm>
 #include <vector>
@@ -19,11 +22,19 @@
 #include <math.h>
 
 #include <monotonic/containers/string.hpp>
+#include <monotonic/containers/ilist.hpp>
+#include <monotonic/containers/unrolled_list.hpp>
+#include <monotonic/containers/btree_map.hpp>
+#include <monotonic/containers/map.hpp>
+#include <monotonic/containers/small_vector.hpp>
+#include <monotonic/containers/dynamic_bitset.hpp>
 #include <iterator>
+#include <boost/foreach.hpp>
 #include <boost/timer/timer.hpp>
 
 #include "./AllocatorTypes.h"
 #include "./PoolResult.h"
+#include "./ResultFile.h"
 #include "./Tests.h"
 
 #include <monotonic/storage.hpp>
@@ -47,17 +58,42 @@ vector<int> random_numbers;
 vector<pair<int, int> > random_pairs;
 bool first_result = true;
 
+// the section of the current tests, how many times each test is run at each length,
+// and where the runs are written if anywhere
+string section;
+size_t num_runs = 1;
+ResultWriter *writer = 0;
+
 // ensure tests for different allocators get the same random number sequences
 void SeedRand()
 {
     srand(42);
 }
 
+// user and system times are only counted in scheduler ticks, which is too coarse for
+// the shorter runs, so results use the wall time
+nanosecond_type elapsed_ns(cpu_timer const &timer)
+{
+    return timer.elapsed().wall;
+}
+
+double elapsed_ms(cpu_timer const &timer)
+{
+    return elapsed_ns(timer) / 1e6;
+}
+
+double elapsed_s(cpu_timer const &timer)
+{
+    return elapsed_ns(timer) / 1e9;
+}
+
 template <class Fun>
 PoolResult run_test(size_t count, size_t length, Fun fun, Type types)
 {
-    typedef typename Allocator<Type::Monotonic, int> mono_alloc;
-    typedef typename Allocator<Type::Standard, int> std_alloc;
+    // the monotonic allocator itself rather than a type derived from it, so that the
+    // monotonic overloads of the tests are chosen
+    typedef boost::monotonic::allocator<int> mono_alloc;
+    typedef std::allocator<int> std_alloc;
 
     PoolResult result;
 
@@ -66,21 +102,21 @@ PoolResult run_test(size_t count, size_t length, Fun fun, Type types)
     if (types.Includes(Type::Tbb))
     {
         SeedRand();
-        boost::timer timer;
+        cpu_timer timer;
         for (size_t n = 0; n < count; ++n)
         {
             {
                 fun.test(tbb_alloc(), length);
             }
         }
-        result.tbb_elapsed = timer.elapsed();
+        result.tbb_elapsed = elapsed_ns(timer);
     }
 #endif
 
     if (types.Includes(Type::Monotonic))
     {
         SeedRand();
-        auto_cpu_timer timer;
+        cpu_timer timer;
         for (size_t n = 0; n < count; ++n)
         {
             {
@@ -88,7 +124,7 @@ PoolResult run_test(size_t count, size_t length, Fun fun, Type types)
             }
             boost::monotonic::reset_storage();
         }
-        result.mono_elapsed = elapsed_s(timer);
+        result.mono_elapsed = elapsed_ns(timer);
     }
 
 	// do it again for local storage if testing monotonic
@@ -96,28 +132,28 @@ PoolResult run_test(size_t count, size_t length, Fun fun, Type types)
     {
         SeedRand();
         monotonic::local<my_local> storage;
-        auto_cpu_timer timer;
+        cpu_timer timer;
         for (size_t n = 0; n < count; ++n)
         {
             {
-                fun.test(monotonic::allocator<void, my_local>(), length);
+                fun.test(storage.make_allocator<int>(), length);
             }
             storage.reset();
         }
-        result.local_mono_elapsed = elapsed_s(timer);
+        result.local_mono_elapsed = elapsed_ns(timer);
     }
 
     if (types.Includes(Type::Standard))
     {
         SeedRand();
-        auto_cpu_timer timer;
+        cpu_timer timer;
         for (size_t n = 0; n < count; ++n)
         {
             {
                 fun.test(std_alloc(), length);
             }
         }
-        result.std_elapsed = elapsed_s(timer);
+        result.std_elapsed = elapsed_ns(timer);
     }
 
     cout << "." << flush;
@@ -129,6 +165,36 @@ pair<int, int> random_pair()
     return make_pair(rand(), rand());
 }
 
+void write_result(const char *title, size_t count, size_t length, size_t run, const char *allocator, PoolResult::nanoseconds elapsed)
+{
+    ResultRecord rec;
+    rec.section = section;
+    rec.test = title;
+    rec.allocator = allocator;
+    rec.length = length;
+    rec.count = count;
+    rec.run = run;
+    rec.elapsed_ns = elapsed;
+    writer->write(rec);
+}
+
+void write_results(const char *title, size_t count, size_t length, size_t run, PoolResult const &result, Type types)
+{
+    if (writer == 0)
+        return;
+    if (types.Includes(Type::Monotonic))
+    {
+        write_result(title, count, length, run, "mono", result.mono_elapsed);
+        write_result(title, count, length, run, "local_mono", result.local_mono_elapsed);
+    }
+    if (types.Includes(Type::Standard))
+        write_result(title, count, length, run, "std", result.std_elapsed);
+#ifdef BOOST_MONOTONIC_TBB
+    if (types.Includes(Type::Tbb))
+        write_result(title, count, length, run, "tbb", result.tbb_elapsed);
+#endif
+}
+
 template <class Fun>
 PoolResults run_tests(
     size_t count, size_t max_length, size_t num_iterations, const char *title, Fun fun, 
@@ -149,7 +215,15 @@ PoolResults run_tests(
         if (random_pairs.size() < required)
             generate_n(back_inserter(random_pairs), required - random_pairs.size(), random_pair);
 
-        results[length] = run_test(count, length, fun, types);
+        // the tables show the mean of the runs; the result files have each of them
+        PoolResult total;
+        for (size_t run = 0; run < num_runs; ++run)
+        {
+            PoolResult result = run_test(count, length, fun, types);
+            write_results(title, count, length, run, result, types);
+            total += result;
+        }
+        results[length] = total*(1./num_runs);
     }
 
     cout << endl << "took " << elapsed_s(timer) << "s" << endl;
@@ -195,7 +269,7 @@ pair<typename iterator_traits<II>::value_type, typename iterator_traits<II>::val
 template <class Cont>
 pair<typename Cont::value_type, typename Cont::value_type> standard_deviation_mean(Cont const &cont)
 {
-    return standard_deviation_mean(begin(cont), end(cont));
+    return standard_deviation_mean(std::begin(cont), std::end(cont));
 }
 
 void print_cumulative(vector<PoolResult> const &results)
@@ -203,8 +277,7 @@ void print_cumulative(vector<PoolResult> const &results)
     pair<PoolResult, PoolResult> dev_mean = standard_deviation_mean(results);
     size_t w = 10;
     cout << setw(w) << "scheme" << setw(w) << "mean" << setw(w) << "std-dev" << setw(w) << "min" << setw(w) << "max" << endl;
-    cout << setw(w) << "fast" << setprecision(3) << setw(w) << dev_mean.second.fast_pool_elapsed << setw(w) << dev_mean.first.fast_pool_elapsed << setw(w) << result_min.fast_pool_elapsed << setw(w) << result_max.fast_pool_elapsed << endl;
-    cout << setw(w) << "pool" << setprecision(3) << setw(w) << dev_mean.second.pool_elapsed << setw(w) << dev_mean.first.pool_elapsed << setw(w) << result_min.pool_elapsed << setw(w) << result_max.pool_elapsed << endl;
+    cout << setw(w) << "static" << setprecision(3) << setw(w) << dev_mean.second.mono_elapsed << setw(w) << dev_mean.first.mono_elapsed << setw(w) << result_min.mono_elapsed << setw(w) << result_max.mono_elapsed << endl;
     cout << setw(w) << "std" << setprecision(3) << setw(w) << dev_mean.second.std_elapsed << setw(w) << dev_mean.first.std_elapsed << setw(w) << result_min.std_elapsed << setw(w) << result_max.std_elapsed << endl;
 #ifdef BOOST_MONOTONIC_TBB
     cout << setw(w) << "tbb" << setprecision(3) << setw(w) << dev_mean.second.tbb_elapsed << setw(w) << dev_mean.first.tbb_elapsed << setw(w) << result_min.tbb_elapsed << setw(w) << result_max.tbb_elapsed << endl;
@@ -215,7 +288,11 @@ void print_cumulative(vector<PoolResult> const &results)
 void print(PoolResults const &results)
 {
     size_t w = 10;
-    cout << setw(4) << "len" << setw(w) << "fast/m" << setw(w) << "pool/m" << setw(w) << "std/m" << setw(w) << "tbb/m" << endl;
+    cout << setw(4) << "len" << setw(w) << "static/m" << setw(w) << "std/m";
+#ifdef BOOST_MONOTONIC_TBB
+    cout << setw(w) << "tbb/m";
+#endif
+    cout << endl;
     cout << setw(0) << "--------------------------------------------" << endl;
     vector<PoolResult> results_vec;
     for (const auto& iter : results)
@@ -241,7 +318,11 @@ void print(PoolResults const &results)
             result_min.update_min(ratio);
             result_max.update_max(ratio);
         }
-        cout << ratio.fast_pool_elapsed << setw(w) << ratio.pool_elapsed << setw(w) << ratio.std_elapsed << setw(w) << ratio.tbb_elapsed << endl;
+        cout << ratio.mono_elapsed << setw(w) << ratio.std_elapsed;
+#ifdef BOOST_MONOTONIC_TBB
+        cout << setw(w) << ratio.tbb_elapsed;
+#endif
+        cout << endl;
         results_vec.push_back(ratio);
         cumulative.push_back(ratio);
     }
@@ -264,100 +345,61 @@ void heading(const char *text, char star = '-')
     cout << endl;
 }
 
-template <class Storage>
-void test_locals(Storage &storage, size_t count)
+void usage()
 {
-    if (count == 0)
-        return;
-
-    typedef typename Storage::template allocator<int>::type allocator;
-    typedef typename Storage::template allocator<char>::type char_allocator;
-    list<int, allocator > list;
-    fill_n(back_inserter(list), 100, 42);
-    typedef basic_string<char, char_traits<char>, char_allocator> String;
+    cout << "usage: compare_memory_pool [--runs N] [--csv file] [--json file] [small] [medium] [large]" << endl;
+    cout << "  --runs N     run each test N times at each length" << endl;
+    cout << "  --csv file   write the time of every run as csv" << endl;
+    cout << "  --json file  write the time of every run as json" << endl;
+    cout << "  sections to run, or all of them if none are given" << endl;
+    cout << "compare the files of two builds with compare_results" << endl;
 }
 
-struct local_1 {};
-struct local_2 {};
-
-// TODO
-//void test_locals_mono()
-//{
-//    monotonic::local<local_1> storage1;
-//    //monotonic::local<local_2> storage2;
-//    for (size_t n = 0; n < 10; ++n)
-//    {
-//        //test_locals(storage1, 4);
-//        //test_locals(storage2, 2);
-//    }
-//    //cout << "test_locals: storage1 stack,heap =" << storage1.fixed_used() << ", " << storage1.heap_used() << endl;
-//    //cout << "test_locals: storage2 stack,heap =" << storage2.fixed_used() << ", " << storage2.heap_used() << endl;
-//}
-//
-void test_locals_std_impl(size_t count)
+void open_output(ofstream &file, const char *path)
 {
-    if (count == 0)
-        return;
-
-    list<int> list;
-    fill_n(back_inserter(list), 100, 42);
-    string s = "foo";
-    for (size_t n = 0; n < 100; ++n)
-        s += "bar";
-
-    vector<int> vec;
-    vec.resize(1000);
-    test_locals_std_impl(--count);
-}
-
-void test_locals_std()
-{
-    for (size_t n = 0; n < 10; ++n)
-    {
-        test_locals_std_impl(4);
-    }
-}
-
-nanosecond_type elapsed_ns(auto_cpu_timer const& timer)
-{
-    auto const &elapsed = timer.elapsed();
-    return elapsed.system + elapsed.user;
+    file.open(path);
+    if (!file)
+        throw runtime_error(string("cannot write ") + path);
 }
 
-nanosecond_type elapsed_ms(auto_cpu_timer const& timer)
+int main(int argc, char **argv)
 {
-    return (nanosecond_type)(elapsed_ns(timer) / 1000.);
-}
-
-nanosecond_type elapsed_s(auto_cpu_timer const& timer)
-{
-    return (nanosecond_type)((elapsed_ms(timer)) / 1000.);
-}
-
-void test_locals(size_t count)
-{
-    auto_cpu_timer t0;
-    for (size_t n = 0; n < count; ++n)
+    try
     {
-        //test_locals_mono();
-    }
-    auto mono_elapsed = t0.elapsed();
+        bool run_small = 1;
+        bool run_medium = 1;
+        bool run_large = 1;
+        bool all_sections = true;
+        ofstream csv_file, json_file;
 
-    auto_cpu_timer t1;
-    for (size_t n = 0; n < count; ++n)
-    {
-        test_locals_std();
-    }
-    auto std_elapsed = t1.elapsed();
+        for (int n = 1; n < argc; ++n)
+        {
+            string arg = argv[n];
+            bool has_value = n + 1 < argc;
+            if (arg == "--runs" && has_value)
+                num_runs = (max)(1, atoi(argv[++n]));
+            else if (arg == "--csv" && has_value)
+                open_output(csv_file, argv[++n]);
+            else if (arg == "--json" && has_value)
+                open_output(json_file, argv[++n]);
+            else if (arg == "small" || arg == "medium" || arg == "large")
+            {
+                if (all_sections)
+                    run_small = run_medium = run_large = all_sections = false;
+                run_small |= arg == "small";
+                run_medium |= arg == "medium";
+                run_large |= arg == "large";
+            }
+            else
+            {
+                usage();
+                return 1;
+            }
+        }
 
-    cout << "mono: " << elapsed_ms(t0) / 1000. << "ms" << endl;
-    cout << "std: " << elapsed_ms(t1) / 1000. << "ms" << endl;
-}
+        ResultWriter result_writer(csv_file.is_open() ? &csv_file : 0, json_file.is_open() ? &json_file : 0);
+        writer = &result_writer;
 
-int main()
-{
-    try
-    {
         cout << "results of running test at:" << endl;
         cout << "https://svn.boost.org/svn/boost/sandbox/monotonic/libs/monotonic/test/Tests.h" << endl << endl;
 
@@ -365,26 +407,30 @@ int main()
         Type test_map_vector_types;
         Type test_dupe_list_types;
 
-        bool run_small = 1;
-        bool run_medium = 1;
-        bool run_large = 1;
-
         // small-size (~100 elements) containers
         if (run_small)
         {
 			first_result = true;
+            section = "SMALL";
             heading("SMALL");
             print(run_tests(1000, 100, 10, "string_cat", test_string_cat()));
             print(run_tests(5000, 100, 10, "list_string", test_list_string()));
             print(run_tests(5000, 100, 10, "list_create<int>", test_list_create<int>()));
+            print(run_tests(5000, 100, 10, "ilist_create<int>", test_ilist_create<int>()));
             print(run_tests(2000, 100, 10, "list_sort<int>", test_list_sort<int>()));
+            print(run_tests(2000, 100, 10, "unrolled_list_sort<int>", test_unrolled_list_sort<int>()));
             print(run_tests(150000, 100, 10, "vector_create<int>", test_vector_create()));
+            print(run_tests(150000, 100, 10, "vector_create_given<int>", test_vector_create_given()));
             print(run_tests(100000, 100, 10, "vector_sort<int>", test_vector_sort<int>()));
             print(run_tests(200000, 100, 10, "vector_dupe", test_vector_dupe()));
             print(run_tests(20000, 100, 10, "list_dupe", test_list_dupe()));
+            print(run_tests(20000, 100, 10, "ilist_dupe", test_ilist_dupe()));
             print(run_tests(100000, 100, 10, "vector_accumulate", test_vector_accumulate()));
             //print(run_tests(50, 100, 10, "set_vector", test_set_vector()));
             print(run_tests(500, 100, 10, "map_vector<int>", test_map_vector<int>()));
+            print(run_tests(500, 100, 10, "map_small_vector<int>", test_map_small_vector<int>()));
+            print(run_tests(2000, 100, 10, "map_lookup", test_map_lookup()));
+            print(run_tests(20000, 1000, 10, "bitset_filter", test_bitset_filter()));
 
             heading("SUMMARY", '*');
             print_cumulative(cumulative);
@@ -394,16 +440,24 @@ int main()
         if (run_medium)
         {
 			first_result = true;
+            section = "MEDIUM";
             heading("MEDIUM");
             print(run_tests(1000, 5000, 10, "list_create<int>", test_list_create<int>()));
+            print(run_tests(1000, 5000, 10, "ilist_create<int>", test_ilist_create<int>()));
             print(run_tests(1000, 5000, 10, "list_sort<int>", test_list_sort<int>()));
+            print(run_tests(1000, 5000, 10, "unrolled_list_sort<int>", test_unrolled_list_sort<int>()));
             print(run_tests(10000, 5000, 10, "vector_create<int>", test_vector_create()));
+            print(run_tests(10000, 5000, 10, "vector_create_given<int>", test_vector_create_given()));
             print(run_tests(3000, 5000, 10, "vector_sort<int>", test_vector_sort<int>()));
             print(run_tests(30000, 5000, 10, "vector_dupe", test_vector_dupe()));
             print(run_tests(500, 5000, 10, "list_dupe", test_list_dupe(), test_dupe_list_types));
+            print(run_tests(500, 5000, 10, "ilist_dupe", test_ilist_dupe(), test_dupe_list_types));
             print(run_tests(5000, 5000, 10, "vector_accumulate", test_vector_accumulate()));
             //print(run_tests(200, 200, 5, "set_vector", test_set_vector()));
             print(run_tests(50, 1000, 10, "map_vector<int>", test_map_vector<int>()));
+            print(run_tests(50, 1000, 10, "map_small_vector<int>", test_map_small_vector<int>()));
+            print(run_tests(200, 5000, 10, "map_lookup", test_map_lookup()));
+            print(run_tests(2000, 100000, 10, "bitset_filter", test_bitset_filter()));
             heading("SUMMARY", '*');
             print_cumulative(cumulative);
         }
@@ -412,16 +466,23 @@ int main()
         if (run_large)
         {
 			first_result = true;
+            section = "LARGE";
             heading("LARGE");
             print(run_tests(10, 25000, 10, "list_create<int>", test_list_create<int>()));
+            print(run_tests(10, 25000, 10, "ilist_create<int>", test_ilist_create<int>()));
             print(run_tests(10, 100000, 10, "list_sort<int>", test_list_sort<int>()));
+            print(run_tests(10, 100000, 10, "unrolled_list_sort<int>", test_unrolled_list_sort<int>()));
             print(run_tests(2000, 100000, 10, "vector_create<int>", test_vector_create()));
             print(run_tests(500, 50000, 10, "vector_sort<int>", test_vector_sort<int>()));
             print(run_tests(500, 1000000, 10, "vector_dupe", test_vector_dupe()));
             print(run_tests(50, 10000, 10, "list_dupe", test_list_dupe(), test_dupe_list_types));
+            print(run_tests(50, 10000, 10, "ilist_dupe", test_ilist_dupe(), test_dupe_list_types));
             print(run_tests(1000, 100000, 10, "vector_accumulate", test_vector_accumulate()));
             //print(run_tests(5, 500, 5, "set_vector", test_set_vector()));
             print(run_tests(20, 20000, 10, "map_vector<int>", test_map_vector<int>()));
+            print(run_tests(20, 20000, 10, "map_small_vector<int>", test_map_small_vector<int>()));
+            print(run_tests(10, 100000, 10, "map_lookup", test_map_lookup()));
+            print(run_tests(50, 1000000, 10, "bitset_filter", test_bitset_filter()));
         }
 
         heading("FINAL SUMMARY", '*');
@@ -0,0 +1,260 @@
+// Copyright (C) 2009-2020 Christian@Schladetsch.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// compares two result files written by compare_memory_pool, and reports which tests got
+// faster or slower.
+//
+// usage: compare_results [--threshold percent] [--all] baseline candidate
+//
+// each file is csv or json; csv files of several runs may be concatenated. for each test,
+// length and allocator in both files this finds the mean time of one repetition of the
+// test in each, and a 95% confidence interval for their difference from the spread of
+// the runs (welch's t-interval). a test is slower if that interval is above zero and the
+// mean is more than threshold percent (default 10) slower, and faster likewise. with only
+// one run of a test there is no interval, and the verdict, marked with '?', is made from
+// the means alone; run compare_memory_pool with --runs 5 or more for reliable verdicts.
+//
+// only tests that changed are printed, unless --all is given. returns 1 if any test
+// got slower, so that it may be used to gate a change, and 2 on errors.
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <vector>
+#include <map>
+#include <string>
+#include <cmath>
+#include <cstdlib>
+
+#include "./ResultFile.h"
+
+using namespace std;
+
+struct Samples
+{
+    ResultRecord first;
+    vector<double> times;
+};
+
+/// the samples of each test, length and allocator, in the order they were first seen
+struct SampleSet
+{
+    vector<string> order;
+    map<string, Samples> samples;
+
+    void add(ResultRecord const &rec)
+    {
+        string key = rec.key();
+        map<string, Samples>::iterator iter = samples.find(key);
+        if (iter == samples.end())
+        {
+            order.push_back(key);
+            iter = samples.insert(make_pair(key, Samples())).first;
+            iter->second.first = rec;
+        }
+        // per repetition, so that files made with different counts still compare
+        iter->second.times.push_back(rec.elapsed_ns/(rec.count ? rec.count : 1));
+    }
+};
+
+SampleSet read_samples(const char *path)
+{
+    ifstream file(path);
+    if (!file)
+        throw runtime_error(string("cannot read ") + path);
+    SampleSet set;
+    ResultRecords records = read_results(file);
+    for (ResultRecord const &rec : records)
+        set.add(rec);
+    return set;
+}
+
+double mean(vector<double> const &values)
+{
+    double total = 0;
+    for (double value : values)
+        total += value;
+    return total/values.size();
+}
+
+double variance(vector<double> const &values, double mean)
+{
+    if (values.size() < 2)
+        return 0;
+    double total = 0;
+    for (double value : values)
+        total += (value - mean)*(value - mean);
+    return total/(values.size() - 1);
+}
+
+/// the two-sided 95% quantile of student's t distribution with the given degrees of
+/// freedom, rounding the degrees down so that intervals are never too narrow
+double t_95(double df)
+{
+    static const double table[] =
+    {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+    };
+    if (df < 1)
+        return table[0];
+    if (df < 31)
+        return table[size_t(df) - 1];
+    if (df < 40)
+        return 2.042;
+    if (df < 60)
+        return 2.021;
+    if (df < 120)
+        return 2.000;
+    return 1.980;
+}
+
+struct Comparison
+{
+    double base_mean;
+    double cand_mean;
+    double change;          // relative to the base mean
+    double low, high;       // the confidence interval of change
+    bool has_interval;
+    int verdict;            // -1 faster, 0 the same, 1 slower
+};
+
+Comparison compare(vector<double> const &base, vector<double> const &cand, double threshold)
+{
+    Comparison result;
+    result.base_mean = mean(base);
+    result.cand_mean = mean(cand);
+    double diff = result.cand_mean - result.base_mean;
+    result.change = diff/result.base_mean;
+    result.has_interval = base.size() > 1 && cand.size() > 1;
+    result.low = result.high = result.change;
+    if (result.has_interval)
+    {
+        double var_base = variance(base, result.base_mean)/base.size();
+        double var_cand = variance(cand, result.cand_mean)/cand.size();
+        double se = sqrt(var_base + var_cand);
+        double df = se > 0
+            ? pow(var_base + var_cand, 2)/(var_base*var_base/(base.size() - 1) + var_cand*var_cand/(cand.size() - 1))
+            : base.size() + cand.size() - 2;
+        double margin = t_95(df)*se;
+        result.low = (diff - margin)/result.base_mean;
+        result.high = (diff + margin)/result.base_mean;
+    }
+    result.verdict = 0;
+    if (result.low > 0 && result.change > threshold)
+        result.verdict = 1;
+    else if (result.high < 0 && result.change < -threshold)
+        result.verdict = -1;
+    return result;
+}
+
+void print_heading()
+{
+    cout << left << setw(10) << "section" << setw(28) << "test" << right << setw(8) << "len" << setw(12) << "allocator"
+        << setw(12) << "base-us" << setw(12) << "cand-us" << setw(10) << "change" << setw(22) << "95% interval" << "  verdict" << endl;
+    cout << string(124, '-') << endl;
+}
+
+void print(ResultRecord const &rec, Comparison const &cmp)
+{
+    const char *verdicts[] = { "faster", "", "slower" };
+    ostringstream interval;
+    if (cmp.has_interval)
+        interval << fixed << setprecision(1) << "[" << cmp.low*100 << "%, " << cmp.high*100 << "%]";
+    cout << left << setw(10) << rec.section << setw(28) << rec.test << right << setw(8) << rec.length << setw(12) << rec.allocator
+        << fixed << setprecision(2) << setw(12) << cmp.base_mean/1000 << setw(12) << cmp.cand_mean/1000
+        << setprecision(1) << setw(9) << cmp.change*100 << "%" << setw(22) << interval.str()
+        << "  " << verdicts[cmp.verdict + 1] << (cmp.verdict != 0 && !cmp.has_interval ? "?" : "") << endl;
+    cout.unsetf(ios::fixed);
+}
+
+void usage()
+{
+    cout << "usage: compare_results [--threshold percent] [--all] baseline candidate" << endl;
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        double threshold = 0.10;
+        bool print_all = false;
+        vector<const char *> paths;
+        for (int n = 1; n < argc; ++n)
+        {
+            string arg = argv[n];
+            if (arg == "--threshold" && n + 1 < argc)
+                threshold = atof(argv[++n])/100;
+            else if (arg == "--all")
+                print_all = true;
+            else if (arg.compare(0, 2, "--") != 0)
+                paths.push_back(argv[n]);
+            else
+            {
+                usage();
+                return 2;
+            }
+        }
+        if (paths.size() != 2)
+        {
+            usage();
+            return 2;
+        }
+
+        SampleSet base = read_samples(paths[0]);
+        SampleSet cand = read_samples(paths[1]);
+
+        // the geometric mean over all tests of candidate/base, for each allocator
+        map<string, pair<double, size_t> > log_ratios;
+        size_t num_compared = 0, num_slower = 0, num_faster = 0, num_missing = 0;
+
+        print_heading();
+        for (string const &key : base.order)
+        {
+            Samples const &base_samples = base.samples[key];
+            map<string, Samples>::const_iterator found = cand.samples.find(key);
+            if (found == cand.samples.end())
+            {
+                ++num_missing;
+                continue;
+            }
+            // too fast to time
+            if (mean(base_samples.times) <= 0 || mean(found->second.times) <= 0)
+                continue;
+
+            Comparison cmp = compare(base_samples.times, found->second.times, threshold);
+            ++num_compared;
+            num_slower += cmp.verdict > 0;
+            num_faster += cmp.verdict < 0;
+            pair<double, size_t> &log_ratio = log_ratios[base_samples.first.allocator];
+            log_ratio.first += log(cmp.cand_mean/cmp.base_mean);
+            ++log_ratio.second;
+
+            if (print_all || cmp.verdict != 0)
+                print(base_samples.first, cmp);
+        }
+
+        cout << endl << "compared " << num_compared << ": " << num_slower << " slower, " << num_faster << " faster";
+        if (num_missing)
+            cout << ", " << num_missing << " not in candidate";
+        cout << endl;
+        for (auto const &ratio : log_ratios)
+        {
+            cout << setw(12) << ratio.first << ": candidate/base geometric mean " << fixed << setprecision(3)
+                << exp(ratio.second.first/ratio.second.second) << endl;
+            cout.unsetf(ios::fixed);
+        }
+
+        return num_slower > 0 ? 1 : 0;
+    }
+    catch (exception &e)
+    {
+        cout << "exception: " << e.what() << endl;
+        return 2;
+    }
+}
+
+//EOF
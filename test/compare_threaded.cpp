@@ -0,0 +1,260 @@
+// Copyright (C) 2009-2020 Christian@Schladetsch.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// runs the workloads of Tests.h on several threads at once, for each allocation scheme.
+//
+// usage: compare_threaded [max-threads]
+//
+// each workload is run by 1, 2, 4, ... max-threads threads, which default to the number
+// of hardware threads. every thread repeats the workload, timing each repetition. for
+// each run this reports the wall time, the repetitions per second over all threads, the
+// median and 99th percentile time of one repetition, and the peak resident set size.
+//
+// the std rows use the allocator of the process: run with LD_PRELOAD set to jemalloc or
+// tcmalloc to measure those. define BOOST_MONOTONIC_TBB to add tbb_allocator.
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <numeric>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <cstdlib>
+
+#include <boost/foreach.hpp>
+
+#include <monotonic/containers/string.hpp>
+#include <monotonic/containers/ilist.hpp>
+#include <monotonic/containers/unrolled_list.hpp>
+#include <monotonic/containers/btree_map.hpp>
+#include <monotonic/containers/map.hpp>
+#include <monotonic/containers/small_vector.hpp>
+#include <monotonic/containers/dynamic_bitset.hpp>
+#include <monotonic/shared_allocator.hpp>
+#include <monotonic/thread_local_storage.hpp>
+
+#include "./AllocatorTypes.h"
+#include "./Tests.h"
+#include "./MemoryUsage.h"
+
+using namespace std;
+
+vector<int> random_numbers;
+vector<pair<int, int> > random_pairs;
+
+typedef chrono::steady_clock Clock;
+
+// each scheme gives the allocator the threads use, what each thread does after each
+// repetition, and what is done after all threads have finished
+
+struct std_scheme
+{
+    typedef std::allocator<int> allocator;
+    static const char *name() { return "std"; }
+    static void after_rep() { }
+    static void after_run() { }
+};
+
+#ifdef BOOST_MONOTONIC_TBB
+struct tbb_scheme
+{
+    typedef tbb::tbb_allocator<int> allocator;
+    static const char *name() { return "tbb"; }
+    static void after_rep() { }
+    static void after_run() { }
+};
+#endif
+
+// all threads share one storage behind a mutex. as no thread can reset it while others
+// are using it, it grows for the whole run
+struct shared_scheme
+{
+    typedef boost::monotonic::shared_allocator<int> allocator;
+    typedef boost::monotonic::static_storage<boost::monotonic::default_region_tag, boost::monotonic::shared_access_tag> storage;
+    static const char *name() { return "shared"; }
+    static void after_rep() { }
+    static void after_run() { storage::release(); }
+};
+
+// each thread has its own storage, which it resets after each repetition
+struct thread_local_scheme
+{
+    typedef boost::monotonic::allocator<int, boost::monotonic::default_region_tag, boost::monotonic::thread_local_access_tag> allocator;
+    typedef boost::monotonic::static_storage<boost::monotonic::default_region_tag, boost::monotonic::thread_local_access_tag> storage;
+    static const char *name() { return "tls"; }
+    static void after_rep() { storage::reset(); }
+    static void after_run() { }
+};
+
+struct ThreadedResult
+{
+    size_t threads;
+    double wall_ms;
+    double ops_per_sec;
+    double p50_us;
+    double p99_us;
+    size_t peak_rss;
+};
+
+/// the value below which fraction of the sorted samples lie
+double percentile(vector<double> const &sorted, double fraction)
+{
+    if (sorted.empty())
+        return 0;
+    size_t index = size_t(fraction*(sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+template <class Scheme, class Fun>
+ThreadedResult run_threaded(size_t num_threads, size_t count, size_t length, Fun fun)
+{
+    vector<vector<double> > latencies(num_threads);
+    atomic<size_t> ready(0);
+    atomic<bool> go(false);
+    atomic<int> sink(0);
+
+    reset_peak_rss();
+    vector<thread> threads;
+    for (size_t n = 0; n < num_threads; ++n)
+    {
+        threads.emplace_back([&, n] {
+            vector<double> &times = latencies[n];
+            times.reserve(count);
+            typename Scheme::allocator alloc;
+            int total = 0;
+            ++ready;
+            while (!go.load(memory_order_acquire))
+                this_thread::yield();
+            for (size_t rep = 0; rep < count; ++rep)
+            {
+                Clock::time_point start = Clock::now();
+                total += fun.test(alloc, length);
+                Scheme::after_rep();
+                times.push_back(chrono::duration<double, micro>(Clock::now() - start).count());
+            }
+            sink += total;
+        });
+    }
+    while (ready.load() != num_threads)
+        this_thread::yield();
+
+    Clock::time_point start = Clock::now();
+    go.store(true, memory_order_release);
+    for (thread &t : threads)
+        t.join();
+    double wall_ms = chrono::duration<double, milli>(Clock::now() - start).count();
+
+    ThreadedResult result;
+    result.peak_rss = peak_rss();
+    Scheme::after_run();
+
+    vector<double> all;
+    all.reserve(num_threads*count);
+    for (vector<double> const &times : latencies)
+        all.insert(all.end(), times.begin(), times.end());
+    sort(all.begin(), all.end());
+
+    result.threads = num_threads;
+    result.wall_ms = wall_ms;
+    result.ops_per_sec = wall_ms > 0 ? all.size()/(wall_ms/1000.) : 0;
+    result.p50_us = percentile(all, 0.50);
+    result.p99_us = percentile(all, 0.99);
+    return result;
+}
+
+void print_heading()
+{
+    size_t w = 11;
+    cout << setw(8) << "threads" << setw(w) << "scheme" << setw(w) << "wall-ms" << setw(w + 2) << "ops/s"
+        << setw(w) << "p50-us" << setw(w) << "p99-us" << setw(w) << "peak-MB" << endl;
+    cout << "---------------------------------------------------------------------------" << endl;
+}
+
+void print(const char *scheme, ThreadedResult const &result)
+{
+    size_t w = 11;
+    cout << setw(8) << result.threads << setw(w) << scheme << fixed << setprecision(1)
+        << setw(w) << result.wall_ms << setw(w + 2) << setprecision(0) << result.ops_per_sec
+        << setprecision(2) << setw(w) << result.p50_us << setw(w) << result.p99_us
+        << setprecision(1) << setw(w) << result.peak_rss/(1024.*1024.) << endl;
+    cout.unsetf(ios::fixed);
+}
+
+template <class Scheme, class Fun>
+void run_scheme(size_t num_threads, size_t count, size_t length, Fun fun)
+{
+    print(Scheme::name(), run_threaded<Scheme>(num_threads, count, length, fun));
+}
+
+/// the thread counts to run: 1, 2, 4, ... up to and including max_threads
+vector<size_t> thread_counts(size_t max_threads)
+{
+    vector<size_t> counts;
+    for (size_t n = 1; n < max_threads; n *= 2)
+        counts.push_back(n);
+    counts.push_back(max_threads);
+    return counts;
+}
+
+template <class Fun>
+void run_tests(size_t max_threads, size_t count, size_t length, const char *title, Fun fun)
+{
+    cout << title << ": reps=" << count << " per thread, len=" << length << endl;
+    print_heading();
+    for (size_t threads : thread_counts(max_threads))
+    {
+        run_scheme<std_scheme>(threads, count, length, fun);
+#ifdef BOOST_MONOTONIC_TBB
+        run_scheme<tbb_scheme>(threads, count, length, fun);
+#endif
+        run_scheme<shared_scheme>(threads, count, length, fun);
+        run_scheme<thread_local_scheme>(threads, count, length, fun);
+    }
+    cout << endl;
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        size_t max_threads = (max)(1u, thread::hardware_concurrency());
+        if (argc > 1)
+            max_threads = (max)(1, atoi(argv[1]));
+
+        // the workloads only read these, so they are made before any threads start.
+        // workloads that call rand() are not run, as it is not thread-safe
+        srand(42);
+        generate_n(back_inserter(random_numbers), 100000, rand);
+
+        cout << "threaded allocator comparison, up to " << max_threads << " threads" << endl << endl;
+        run_tests(max_threads, 2000, 100, "string_cat", test_string_cat());
+        run_tests(max_threads, 2000, 100, "list_string", test_list_string());
+        run_tests(max_threads, 2000, 1000, "list_create<int>", test_list_create<int>());
+        run_tests(max_threads, 2000, 1000, "ilist_create<int>", test_ilist_create<int>());
+        run_tests(max_threads, 500, 1000, "list_sort<int>", test_list_sort<int>());
+        run_tests(max_threads, 500, 1000, "unrolled_list_sort<int>", test_unrolled_list_sort<int>());
+        run_tests(max_threads, 5000, 1000, "vector_sort<int>", test_vector_sort<int>());
+        run_tests(max_threads, 200, 1000, "map_vector<int>", test_map_vector<int>());
+        run_tests(max_threads, 200, 1000, "map_small_vector<int>", test_map_small_vector<int>());
+        run_tests(max_threads, 200, 1000, "map_lookup", test_map_lookup());
+        run_tests(max_threads, 2000, 10000, "bitset_filter", test_bitset_filter());
+    }
+    catch (exception &e)
+    {
+        cout << "exception: " << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+//EOF
@@ -0,0 +1,397 @@
+// Copyright (C) 2009-2020 Christian@Schladetsch.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// replays an allocation trace recorded by monotonic::recording_storage or written by
+// monotonic::tracing_storage against several kinds of storage, and reports how long each
+// took and how much memory each used.
+//
+// usage: replay_trace [--reps N] trace-file
+//
+// the events are replayed in the order they were recorded, on one thread, so that
+// storage<>, which is not thread-safe, can be compared with the others; the threads that
+// made them are only counted. every allocation is written to once per 64 bytes, as the
+// program that made it would have. storage that can free memory frees what the trace
+// deallocates, and everything still live when the trace resets or releases its storage.
+//
+// for each storage this reports the best and median time of the replays, the time per
+// event, the most memory held at once, and how much the peak resident set size grew.
+// for monotonic storage the memory held is the most that used() reached; for the others
+// it is the most bytes live at once, which is what the traced program asked for.
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <new>
+
+#include <boost/foreach.hpp>
+
+#include <monotonic/storage.hpp>
+#include <monotonic/shared_storage.hpp>
+#include <monotonic/reclaimable_storage.hpp>
+#include <monotonic/recording_storage.hpp>
+#include <monotonic/tracing_storage.hpp>
+
+#include "./MemoryUsage.h"
+
+using namespace std;
+using namespace boost;
+
+typedef chrono::steady_clock Clock;
+
+/// one step of a replay. the ids of allocations still live at each reset or release
+/// are in Plan::ended, from first to last
+struct Step
+{
+    monotonic::trace_op op;
+    size_t id;
+    size_t size;
+    size_t alignment;
+    size_t first, last;
+};
+
+struct Plan
+{
+    vector<Step> steps;
+    vector<size_t> ended;
+    vector<size_t> sizes;           // the size of each allocation
+    vector<size_t> alignments;      // and its alignment
+    size_t num_threads;
+    size_t num_allocations, num_deallocations, num_extends, num_resets;
+    size_t bytes_requested, peak_live;
+};
+
+Plan make_plan(vector<monotonic::trace_event> const &events)
+{
+    Plan plan = Plan();
+    vector<size_t> live_index;      // of each live allocation in `live`, or npos
+    vector<size_t> live;
+    const size_t npos = size_t(-1);
+    size_t live_bytes = 0;
+
+    for (monotonic::trace_event const &event : events)
+    {
+        plan.num_threads = (max)(plan.num_threads, size_t(event.thread) + 1);
+        Step step = Step();
+        step.op = event.op;
+        step.id = size_t(event.id);
+        step.size = size_t(event.size);
+        step.alignment = event.alignment;
+
+        switch (event.op)
+        {
+        case monotonic::trace_allocate:
+            if (step.id >= plan.sizes.size())
+            {
+                plan.sizes.resize(step.id + 1, 0);
+                plan.alignments.resize(step.id + 1, 1);
+                live_index.resize(step.id + 1, npos);
+            }
+            plan.sizes[step.id] = step.size;
+            plan.alignments[step.id] = step.alignment;
+            live_index[step.id] = live.size();
+            live.push_back(step.id);
+            live_bytes += step.size;
+            plan.bytes_requested += step.size;
+            ++plan.num_allocations;
+            break;
+
+        case monotonic::trace_deallocate:
+        case monotonic::trace_extend:
+        {
+            if (step.id >= live_index.size() || live_index[step.id] == npos)
+                continue;       // not allocated since the last reset
+            if (event.op == monotonic::trace_extend)
+            {
+                live_bytes += step.size - plan.sizes[step.id];
+                plan.bytes_requested += step.size - plan.sizes[step.id];
+                plan.sizes[step.id] = step.size;
+                ++plan.num_extends;
+                break;
+            }
+            // remove from live by moving the last live allocation into its place
+            size_t index = live_index[step.id];
+            live[index] = live.back();
+            live_index[live[index]] = index;
+            live.pop_back();
+            live_index[step.id] = npos;
+            live_bytes -= plan.sizes[step.id];
+            ++plan.num_deallocations;
+            break;
+        }
+
+        case monotonic::trace_reset:
+        case monotonic::trace_release:
+            step.first = plan.ended.size();
+            plan.ended.insert(plan.ended.end(), live.begin(), live.end());
+            step.last = plan.ended.size();
+            for (size_t id : live)
+                live_index[id] = npos;
+            live.clear();
+            live_bytes = 0;
+            ++plan.num_resets;
+            break;
+        }
+        plan.peak_live = (max)(plan.peak_live, live_bytes);
+        plan.steps.push_back(step);
+    }
+    return plan;
+}
+
+// each scheme allocates and frees for a replay, and says how much memory it holds.
+// deallocate() is given the alignment the memory was allocated with
+
+template <class Storage>
+struct monotonic_scheme
+{
+    Storage store;
+    size_t peak;
+
+    monotonic_scheme() : peak(0) { }
+    void *allocate(size_t size, size_t alignment)
+    {
+        return store.allocate(size, alignment);
+    }
+    void deallocate(void *ptr, size_t)
+    {
+        store.deallocate(ptr);
+    }
+    bool extend(void *ptr, size_t size, size_t new_size)
+    {
+        return store.extend(ptr, size, new_size);
+    }
+    void end(Plan const &, Step const &step, vector<void *> &)
+    {
+        peak = (max)(peak, store.used());
+        if (step.op == monotonic::trace_reset)
+            store.reset();
+        else
+            store.release();
+    }
+    size_t finish(Plan const &, vector<void *> &)
+    {
+        peak = (max)(peak, store.used());
+        store.release();
+        return peak;
+    }
+};
+
+// storage that frees memory must be given back everything still live at a reset
+template <class Derived>
+struct freeing_scheme
+{
+    bool extend(void *, size_t, size_t)
+    {
+        return false;
+    }
+    void end(Plan const &plan, Step const &step, vector<void *> &ptrs)
+    {
+        for (size_t n = step.first; n < step.last; ++n)
+        {
+            size_t id = plan.ended[n];
+            static_cast<Derived *>(this)->deallocate(ptrs[id], plan.alignments[id]);
+            ptrs[id] = 0;
+        }
+    }
+    size_t finish(Plan const &plan, vector<void *> &ptrs)
+    {
+        for (size_t id = 0; id < ptrs.size(); ++id)
+        {
+            if (ptrs[id])
+                static_cast<Derived *>(this)->deallocate(ptrs[id], plan.alignments[id]);
+        }
+        return plan.peak_live;
+    }
+};
+
+struct reclaimable_scheme : freeing_scheme<reclaimable_scheme>
+{
+    monotonic::reclaimable_storage<> store;
+
+    void *allocate(size_t size, size_t alignment)
+    {
+        return store.allocate(size, alignment);
+    }
+    void deallocate(void *ptr, size_t)
+    {
+        store.deallocate(ptr);
+    }
+};
+
+struct std_scheme : freeing_scheme<std_scheme>
+{
+    void *allocate(size_t size, size_t alignment)
+    {
+        if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            return ::operator new(size, align_val_t(alignment));
+        return ::operator new(size);
+    }
+    void deallocate(void *ptr, size_t alignment)
+    {
+        if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            ::operator delete(ptr, align_val_t(alignment));
+        else
+            ::operator delete(ptr);
+    }
+};
+
+/// write to each cache line of the allocation, as its program would
+inline void touch(void *ptr, size_t begin, size_t end)
+{
+    char *bytes = static_cast<char *>(ptr);
+    for (size_t n = begin; n < end; n += 64)
+        bytes[n] = char(n);
+}
+
+template <class Scheme>
+size_t replay(Plan const &plan, Scheme &scheme)
+{
+    vector<void *> ptrs(plan.sizes.size(), (void *)0);
+    vector<size_t> sizes(plan.sizes.size(), 0);
+    for (Step const &step : plan.steps)
+    {
+        switch (step.op)
+        {
+        case monotonic::trace_allocate:
+            ptrs[step.id] = scheme.allocate(step.size, step.alignment);
+            if (ptrs[step.id] == 0 && step.size > 0)
+                throw bad_alloc();
+            sizes[step.id] = step.size;
+            touch(ptrs[step.id], 0, step.size);
+            break;
+        case monotonic::trace_deallocate:
+            scheme.deallocate(ptrs[step.id], plan.alignments[step.id]);
+            ptrs[step.id] = 0;
+            break;
+        case monotonic::trace_extend:
+            // storage that cannot extend in place leaves the allocation as it was
+            if (scheme.extend(ptrs[step.id], sizes[step.id], step.size))
+            {
+                touch(ptrs[step.id], sizes[step.id], step.size);
+                sizes[step.id] = step.size;
+            }
+            break;
+        case monotonic::trace_reset:
+        case monotonic::trace_release:
+            scheme.end(plan, step, ptrs);
+            break;
+        }
+    }
+    return scheme.finish(plan, ptrs);
+}
+
+struct ReplayResult
+{
+    double best_ms, median_ms;
+    size_t memory;
+    size_t rss;
+};
+
+template <class Scheme>
+ReplayResult run_replay(Plan const &plan, size_t reps)
+{
+    ReplayResult result = ReplayResult();
+    vector<double> times;
+    size_t rss_before = current_rss();
+    reset_peak_rss();
+    for (size_t rep = 0; rep < reps; ++rep)
+    {
+        Scheme scheme;
+        Clock::time_point start = Clock::now();
+        result.memory = replay(plan, scheme);
+        times.push_back(chrono::duration<double, milli>(Clock::now() - start).count());
+    }
+    result.rss = peak_rss() - (min)(rss_before, peak_rss());
+    sort(times.begin(), times.end());
+    result.best_ms = times.front();
+    result.median_ms = times[times.size()/2];
+    return result;
+}
+
+void print(const char *name, Plan const &plan, ReplayResult const &result)
+{
+    size_t w = 12;
+    cout << setw(w) << name << fixed << setprecision(3) << setw(w) << result.best_ms << setw(w) << result.median_ms
+        << setprecision(1) << setw(w) << (plan.steps.empty() ? 0 : result.best_ms*1e6/plan.steps.size())
+        << setw(w + 2) << result.memory << setw(w + 2) << result.rss << endl;
+    cout.unsetf(ios::fixed);
+}
+
+void usage()
+{
+    cout << "usage: replay_trace [--reps N] trace-file" << endl;
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        size_t reps = 5;
+        const char *path = 0;
+        for (int n = 1; n < argc; ++n)
+        {
+            string arg = argv[n];
+            if (arg == "--reps" && n + 1 < argc)
+                reps = (max)(1, atoi(argv[++n]));
+            else if (arg.compare(0, 2, "--") != 0 && path == 0)
+                path = argv[n];
+            else
+            {
+                usage();
+                return 1;
+            }
+        }
+        if (path == 0)
+        {
+            usage();
+            return 1;
+        }
+
+        ifstream file(path, ios::binary);
+        if (!file)
+            throw runtime_error(string("cannot read ") + path);
+        vector<monotonic::trace_event> events;
+        char magic[sizeof(monotonic::detail::tracing_magic)] = { 0 };
+        file.read(magic, sizeof(magic));
+        file.clear();
+        file.seekg(0);
+        if (equal(magic, magic + sizeof(magic), monotonic::detail::tracing_magic))
+        {
+            vector<monotonic::trace_record> records;
+            monotonic::read_trace_records(file, records);
+            monotonic::to_trace_events(records, events);
+        }
+        else
+            monotonic::read_trace(file, events);
+        Plan plan = make_plan(events);
+
+        cout << path << ": " << plan.steps.size() << " events from " << plan.num_threads << " threads: "
+            << plan.num_allocations << " allocations, " << plan.num_deallocations << " deallocations, "
+            << plan.num_extends << " extends, " << plan.num_resets << " resets" << endl;
+        cout << plan.bytes_requested << " bytes requested, at most " << plan.peak_live << " live" << endl << endl;
+
+        size_t w = 12;
+        cout << setw(w) << "storage" << setw(w) << "best-ms" << setw(w) << "median-ms" << setw(w) << "ns/event"
+            << setw(w + 2) << "memory" << setw(w + 2) << "rss" << endl;
+        cout << string(6*w + 4, '-') << endl;
+        print("storage", plan, run_replay<monotonic_scheme<monotonic::storage<> > >(plan, reps));
+        print("shared", plan, run_replay<monotonic_scheme<monotonic::shared_storage<monotonic::storage<> > > >(plan, reps));
+        print("reclaimable", plan, run_replay<reclaimable_scheme>(plan, reps));
+        print("std", plan, run_replay<std_scheme>(plan, reps));
+    }
+    catch (exception &e)
+    {
+        cout << "exception: " << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+//EOF
@@ -0,0 +1,45 @@
+// Copyright (C) 2009-2020 Christian@Schladetsch.com
+//
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// tests of storage<>::get_statistics(). these are a program of their own, because
+// BOOST_MONOTONIC_STATISTICS changes storage<>, which every other test uses without it
+
+#define CATCH_CONFIG_MAIN
+#include <monotonic/catch.hpp>
+
+#define BOOST_MONOTONIC_STATISTICS
+
+#include <monotonic/storage.hpp>
+
+using namespace boost;
+
+TEST_CASE("test_storage_statistics", "[storage]")
+{
+    monotonic::storage<64, 1024> storage;
+    storage.allocate(3, 1);             // from a pool of 16-byte chunks, made in a new link
+    storage.allocate(200, 1);           // too large for the inline buffer, so after the pool
+    char *ptr = storage.allocate_bytes(100, 64);
+    CHECK(storage.extend(ptr, 100, 150));
+
+    monotonic::storage_statistics stats = storage.get_statistics();
+    CHECK(stats.allocations == 3);
+    CHECK(stats.requested == 3 + 200 + 150);
+    CHECK(stats.padding < 64 + 3*monotonic::detail::red_zone);
+    CHECK(stats.pool_rounding == 16 - 3);
+    CHECK(stats.pool_unused == 8*16 - 16);
+    CHECK(stats.links == 1);
+    CHECK(stats.heap_reserved == 1024);
+    CHECK(stats.link_unused == 1024 - storage.heap_used());
+    // everything used is accounted for
+    CHECK(storage.used() == stats.requested + stats.padding + stats.pool_rounding + stats.pool_unused);
+
+    storage.reset_statistics();
+    stats = storage.get_statistics();
+    CHECK(stats.allocations == 0);
+    CHECK(stats.requested == 0);
+    CHECK(stats.links == 0);
+}
+
+//EOF
@@ -10,6 +10,12 @@
 #include <string>
 #include <iostream>
 #include <chrono>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <bitset>
+#include <sstream>
 
 #include <monotonic/forward_declarations.hpp>
 #include "monotonic/storage_base.hpp"
@@ -24,8 +30,13 @@
 #include <monotonic/shared_allocator.hpp>
 #include <monotonic/local.hpp>
 #include <monotonic/allocator.hpp>
+#include <monotonic/arena_allocator.hpp>
 #include <monotonic/containers/list.hpp>
 #include <monotonic/reclaimable_storage.hpp>
+#include <monotonic/recording_storage.hpp>
+#include <monotonic/tracing_storage.hpp>
+#include <monotonic/sizing_advisor.hpp>
+#include <monotonic/numa_storage.hpp>
 #include <monotonic/stack.hpp>
 #include <monotonic/containers/string.hpp>
 
@@ -33,7 +44,17 @@
 #include <monotonic/containers/map.hpp>
 #include <monotonic/containers/list.hpp>
 #include <monotonic/containers/vector.hpp>
+#include <monotonic/containers/small_vector.hpp>
+#include <monotonic/containers/dynamic_bitset.hpp>
 #include <monotonic/containers/deque.hpp>
+#include <monotonic/containers/slist.hpp>
+#include <monotonic/containers/ilist.hpp>
+#include <monotonic/containers/unrolled_list.hpp>
+#include <monotonic/containers/btree_map.hpp>
+#include <monotonic/containers/btree_set.hpp>
+#include <monotonic/heterogenous/segregated_vector.hpp>
+#include <monotonic/heterogenous/vector.hpp>
+#include <monotonic/heterogenous/map.hpp>
 
 
 //void main() {}
@@ -130,37 +151,34 @@ int Tracked::count = 0;
 //    }
 //}
 
-//BOOST_AUTO_TEST_CASE(test_fixed_stack)
-//{
-//    monotonic::fixed_stack<> stack;
-//    {
-//        size_t top = stack.top();
-//        int &n2 = stack.push<int>();
-//        float &f0 = stack.push<float>();
-//        char &n3 = stack.push<char>();
-//        Tracked &tracked = stack.push<Tracked>();
-//        //boost::array<int, 42> &a = stack.push_array<int, 42>();
-//
-//        CHECK(stack.size() == 5);
-//
-//        size_t peak = stack.top();
-//        cout << "STACK:" << endl;
-//        // CJS 2013
-//        //BOOST_FOREACH(typename monotonic::fixed_stack<>::value_type const &elem, stack)
-//        //{
-//        //    cout << elem.get_type().name() << endl;
-//        //}
-//        stack.pop();
-//        stack.pop();
-//        stack.pop();
-//        stack.pop();
-//        stack.pop();
-//        size_t top2 = stack.top();
-//        CHECK(top2 == top);
-//        CHECK(Tracked::count == 0);
-//    }
-//}
-//
+TEST_CASE("test_fixed_stack", "[containers]")
+{
+    monotonic::fixed_stack<> stack;
+    {
+        size_t top = stack.top();
+        stack.push<int>(42);
+        stack.push<float>();
+        stack.push<char>();
+        stack.push<Tracked>();
+        std::array<int, 42> &array = stack.push_array<int, 42>();
+        CHECK(array.size() == 42);
+        CHECK(stack.size() == 5);
+        CHECK(Tracked::count == 1);
+        CHECK(stack.begin()->is_type<std::array<int, 42> >());
+        CHECK_THROWS_AS(stack.begin()->get<int>(), std::bad_cast);
+
+        stack.pop();
+        stack.pop();
+        stack.pop();
+        stack.pop();
+        CHECK(stack.begin()->get<int>() == 42);
+        stack.pop();
+        size_t top2 = stack.top();
+        CHECK(top2 == top);
+        CHECK(Tracked::count == 0);
+    }
+}
+
 template <class Number>
 Number work(size_t iterations, std::vector<Number> const &data)
 {
@@ -389,6 +407,609 @@ TEST_CASE("test_deque", "[containers]")
     monotonic::static_storage<region1>::reset();
 }
 
+TEST_CASE("test_deque_segments", "[containers]")
+{
+    monotonic::storage<> storage;
+    {
+        // enough elements to need several segments of the map at each end
+        const int num = 20000;
+        monotonic::deque<int> deq(storage);
+        for (int n = 0; n < num; ++n)
+        {
+            deq.push_back(n);
+            deq.push_front(-n - 1);
+        }
+        REQUIRE(deq.size() == 2*num);
+        CHECK(deq.front() == -num);
+        CHECK(deq.back() == num - 1);
+        CHECK(deq.end() - deq.begin() == 2*num);
+        CHECK(std::is_sorted(deq.begin(), deq.end()));
+        CHECK(deq[0] == -num);
+        CHECK(deq[num] == 0);
+        CHECK(deq.at(2*num - 1) == num - 1);
+        CHECK_THROWS_AS(deq.at(2*num), std::out_of_range);
+        CHECK(*(deq.end() - num - 1) == -1);
+        CHECK(std::accumulate(deq.begin(), deq.end(), 0ll) == -num);
+
+        // jumps across many segments, in both directions. they walk the segments, so the
+        // iterators do not claim random access
+        CHECK((std::is_same<std::iterator_traits<monotonic::deque<int>::iterator>::iterator_category, std::bidirectional_iterator_tag>::value));
+        monotonic::deque<int>::iterator iter = deq.begin();
+        for (int n = 0; n < 2*num; n += 4099)
+            CHECK(iter[n] == n - num);
+        iter += 2*num - 1;
+        CHECK(*iter == num - 1);
+        iter -= 2*num - 1;
+        CHECK(iter == deq.begin());
+
+        // iterators convert to const_iterators, but not back, and both can be assigned
+        typedef monotonic::deque<int>::iterator iterator;
+        typedef monotonic::deque<int>::const_iterator const_iterator;
+        CHECK(std::is_convertible<iterator, const_iterator>::value);
+        CHECK(!std::is_convertible<const_iterator, iterator>::value);
+        const_iterator citer = deq.begin();
+        citer = deq.end() - 1;
+        CHECK(*citer == num - 1);
+        iter = deq.end() - 1;
+        CHECK(iter == citer);
+
+        for (int n = 0; n < num/2; ++n)
+        {
+            deq.pop_back();
+            deq.pop_front();
+        }
+        REQUIRE(deq.size() == num);
+        CHECK(deq.front() == -num/2);
+        CHECK(deq.back() == num/2 - 1);
+
+        // used as a queue, emptied blocks and segments are reused, so no more storage is taken
+        size_t used = storage.used();
+        for (int n = 0; n < 10*num; ++n)
+        {
+            deq.push_back(n);
+            deq.pop_front();
+        }
+        CHECK(storage.used() == used);
+        CHECK(deq.size() == num);
+        CHECK(deq.back() == 10*num - 1);
+        CHECK(deq[num/2] == 9*num + num/2);
+
+        deq.clear();
+        CHECK(deq.empty());
+        CHECK(deq.begin() == deq.end());
+        deq.push_front(1);
+        deq.push_back(2);
+        CHECK(deq.size() == 2);
+        CHECK(storage.used() == used);
+    }
+    {
+        monotonic::deque<std::string> strings(storage);
+        for (int n = 0; n < 1000; ++n)
+            strings.emplace_back(100, char('a' + n % 26));
+        monotonic::deque<std::string> copy(strings, strings.get_allocator());
+        CHECK(copy == strings);
+        monotonic::deque<std::string> moved(std::move(copy));
+        CHECK(copy.empty());
+        CHECK(moved == strings);
+        moved.resize(10);
+        CHECK(moved.size() == 10);
+        CHECK(moved.back() == strings[9]);
+    }
+    {
+        // elements that are monotonic containers use the storage of the deque
+        monotonic::deque<monotonic::vector<int> > vectors(storage);
+        vectors.push_back(monotonic::vector<int>());
+        vectors.push_front(monotonic::vector<int>());
+        CHECK(&vectors.front().get_storage() == &storage);
+        CHECK(&vectors.back().get_storage() == &storage);
+    }
+}
+
+TEST_CASE("test_slist", "[containers]")
+{
+    monotonic::storage<> storage;
+    {
+        monotonic::slist<int> list(storage);
+        list.push_back(2);
+        list.push_front(1);
+        int values[] = { 3, 4, 5 };
+        list.append(values, values + 3);
+        REQUIRE(list.size() == 5);
+        CHECK(list.front() == 1);
+        CHECK(list.back() == 5);
+        CHECK(std::equal(list.begin(), list.end(), std::begin({ 1, 2, 3, 4, 5 })));
+
+        // a forward range is appended as one block
+        CHECK(&*std::next(list.begin(), 3) == &*std::next(list.begin(), 2) + 4);
+
+        monotonic::slist<int> other(storage);
+        other.append(2, 6);
+        list.splice(other);
+        CHECK(other.empty());
+        CHECK(list.size() == 7);
+        CHECK(list.back() == 6);
+
+        monotonic::slist<int> dupe = list;
+        CHECK(dupe == list);
+
+        // iterators convert to const_iterators, but not back
+        typedef monotonic::slist<int>::iterator iterator;
+        typedef monotonic::slist<int>::const_iterator const_iterator;
+        CHECK((std::is_convertible<iterator, const_iterator>::value && !std::is_convertible<const_iterator, iterator>::value));
+        iterator iter = list.begin();
+        iter = dupe.begin();
+        const_iterator citer = iter;
+        CHECK(*citer == 1);
+
+        size_t used = storage.used();
+        list.clear();
+        CHECK(list.empty());
+        CHECK(storage.used() == used);
+    }
+}
+
+TEST_CASE("test_ilist", "[containers]")
+{
+    monotonic::storage<> storage;
+    {
+        typedef monotonic::ilist<std::string> List;
+        List list(storage);
+        list.push_back("b");
+        list.push_front("a");
+        list.emplace_back(2, 'd');
+        list.insert(std::prev(list.end()), "c");
+        REQUIRE(list.size() == 4);
+        CHECK(list.back() == "dd");
+        CHECK(*std::prev(list.end(), 2) == "c");
+
+        list.erase(std::next(list.begin()));
+        CHECK(list.size() == 3);
+        CHECK(*std::next(list.begin()) == "c");
+
+        List other(storage);
+        other.push_back("x");
+        other.push_back("y");
+        list.splice(std::next(list.begin()), other);
+        CHECK(other.empty());
+        std::string expected[] = { "a", "x", "y", "c", "dd" };
+        CHECK(std::equal(list.begin(), list.end(), expected));
+
+        CHECK((std::is_convertible<List::iterator, List::const_iterator>::value && !std::is_convertible<List::const_iterator, List::iterator>::value));
+        List::iterator iter = list.begin();
+        iter = std::next(iter);
+        List::const_iterator citer = iter;
+        CHECK(*citer == "x");
+
+        List moved(std::move(list));
+        CHECK(list.empty());
+        CHECK(moved.size() == 5);
+        moved.pop_back();
+        moved.pop_front();
+        CHECK(moved.front() == "x");
+        CHECK(moved.back() == "c");
+
+        monotonic::storage<> other_storage;
+        List elsewhere(other_storage);
+        CHECK_THROWS_AS(moved.splice(moved.end(), elsewhere), std::invalid_argument);
+    }
+}
+
+TEST_CASE("test_unrolled_list", "[containers]")
+{
+    monotonic::storage<> storage;
+    {
+        typedef monotonic::unrolled_list<int, 4> List;
+        List list(storage);
+        for (int n = 0; n < 10; ++n)
+            list.push_back(n*2);
+        REQUIRE(list.size() == 10);
+
+        // insert into full nodes, splitting them
+        List::iterator iter = list.begin();
+        for (int n = 0; n < 10; ++n, ++iter)
+            iter = list.insert(std::next(iter), n*2 + 1);
+        REQUIRE(list.size() == 20);
+        int expected = 0;
+        for (List::const_iterator I = list.begin(); I != list.end(); ++I)
+            CHECK(*I == expected++);
+
+        // erase every other element, compacting the nodes
+        for (List::iterator I = list.begin(); I != list.end(); )
+        {
+            I = list.erase(I);
+            if (I != list.end())
+                ++I;
+        }
+        REQUIRE(list.size() == 10);
+        CHECK(list.front() == 1);
+        CHECK(list.back() == 19);
+
+        list.push_front(100);
+        list.sort();
+        CHECK(std::is_sorted(list.begin(), list.end()));
+        CHECK(list.back() == 100);
+
+        List dupe = list;
+        CHECK(dupe == list);
+        list.pop_back();
+        list.pop_front();
+        CHECK(list.size() == 9);
+
+        // emptied nodes are re-used rather than taken from the storage
+        list.clear();
+        size_t used = storage.used();
+        for (int n = 0; n < 10; ++n)
+            list.push_back(n);
+        CHECK(storage.used() == used);
+        CHECK(std::accumulate(list.begin(), list.end(), 0) == 45);
+    }
+    {
+        monotonic::unrolled_list<std::string> strings(storage);
+        for (int n = 0; n < 100; ++n)
+            strings.push_front(std::to_string(n));
+        CHECK(strings.front() == "99");
+        CHECK(strings.back() == "0");
+        strings.erase(std::next(strings.begin(), 50));
+        CHECK(strings.size() == 99);
+        strings.sort();
+        CHECK(std::is_sorted(strings.begin(), strings.end()));
+        CHECK(strings.front() == "0");
+
+        // sorting again re-uses the nodes released by the last sort
+        size_t used = storage.used();
+        std::reverse(strings.begin(), strings.end());
+        for (int n = 0; n < 10; ++n)
+            strings.sort([n](std::string const &A, std::string const &B) { return n % 2 ? A < B : B < A; });
+        CHECK(storage.used() == used);
+        CHECK(std::is_sorted(strings.begin(), strings.end()));
+        CHECK(strings.size() == 99);
+    }
+}
+
+// btree_map iterators dereference to pairs of references, so compare entries member-wise
+template <class Map, class Expected>
+bool same_entries(Map const &map, Expected const &expected)
+{
+    return map.size() == expected.size() && std::equal(map.begin(), map.end(), std::begin(expected),
+        [](auto const &A, auto const &B) { return A.first == B.first && A.second == B.second; });
+}
+
+TEST_CASE("test_btree_map", "[containers]")
+{
+    monotonic::storage<> storage;
+    {
+        // enough keys for several levels of inner nodes
+        std::vector<int> keys(50000);
+        std::iota(keys.begin(), keys.end(), 0);
+        std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+        std::map<int, int> expected;
+        monotonic::btree_map<int, int> map(storage);
+        size_t inserted = 0;
+        for (int key : keys)
+        {
+            inserted += map.insert(std::make_pair(2*key, key)).second;
+            expected[2*key] = key;
+        }
+        CHECK(inserted == keys.size());
+        CHECK(!map.insert(std::make_pair(0, 1)).second);
+        REQUIRE(map.size() == expected.size());
+        CHECK(same_entries(map, expected));
+        CHECK(map.find(1234)->second == 617);
+        CHECK(map.find(1235) == map.end());
+        CHECK((*map.lower_bound(1235)).first == 1236);
+        CHECK((*map.upper_bound(1236)).first == 1238);
+        CHECK(map.lower_bound(100000) == map.end());
+        CHECK(map.at(2) == 1);
+        CHECK_THROWS_AS(map.at(3), std::out_of_range);
+        map[3] = 42;
+        CHECK(map.count(3) == 1);
+        CHECK(std::prev(map.end())->first == 99998);
+
+        // erase every other key; emptied leaves are skipped
+        size_t erased = 0;
+        for (int key = 0; key < 100000; key += 4)
+        {
+            erased += map.erase(key);
+            expected.erase(key);
+        }
+        CHECK(erased == 25000);
+        for (int key = 80000; key < 100000; key += 2)
+        {
+            map.erase(key);
+            expected.erase(key);
+        }
+        expected[3] = 42;
+        REQUIRE(map.size() == expected.size());
+        CHECK(same_entries(map, expected));
+        CHECK(std::prev(map.end())->first == 79998);
+        CHECK(map.lower_bound(79999) == map.end());
+
+        // after clear, the nodes are reused
+        size_t used = storage.used();
+        map.clear();
+        CHECK(map.empty());
+        CHECK(map.begin() == map.end());
+        for (int key = 0; key < 1000; ++key)
+            map[key] = key;
+        CHECK(map.size() == 1000);
+        CHECK(storage.used() == used);
+    }
+    {
+        // a map made from a sorted range is built bottom-up
+        std::vector<std::pair<int, std::string> > sorted;
+        for (int n = 0; n < 10000; ++n)
+            sorted.push_back(std::make_pair(3*n, std::to_string(n)));
+        monotonic::btree_map<int, std::string> map(monotonic::ordered_unique_range, sorted.begin(), sorted.end(), std::less<int>(), storage);
+        REQUIRE(map.size() == sorted.size());
+        CHECK(same_entries(map, sorted));
+        size_t found = 0;
+        for (auto const &entry : sorted)
+            found += map.find(entry.first) != map.end() && map.find(entry.first + 1) == map.end();
+        CHECK(found == sorted.size());
+        CHECK(map.at(2997) == "999");
+
+        // iterators convert to const_iterators, but not back, and both can be assigned
+        typedef monotonic::btree_map<int, std::string>::iterator iterator;
+        typedef monotonic::btree_map<int, std::string>::const_iterator const_iterator;
+        CHECK((std::is_convertible<iterator, const_iterator>::value && !std::is_convertible<const_iterator, iterator>::value));
+        iterator iter = map.begin();
+        const_iterator citer = iter;
+        iter = map.find(2997);
+        citer = iter;
+        CHECK(citer->second == "999");
+        CHECK(map.find(2998) == map.end());
+        map.emplace(2998, "new");
+        CHECK(map.at(2998) == "new");
+        CHECK(std::next(map.find(2997))->second == "new");
+
+        monotonic::btree_map<int, std::string> copy(map);
+        CHECK(copy == map);
+        monotonic::btree_map<int, std::string> moved(std::move(copy));
+        CHECK(copy.empty());
+        CHECK(moved == map);
+    }
+    {
+        // keys that are not arithmetic, or not ordered by std::less, use a binary search
+        monotonic::btree_map<std::string, int, monotonic::default_region_tag, std::greater<std::string> > map(storage);
+        for (int n = 0; n < 1000; ++n)
+            map[std::to_string(n)] = n;
+        CHECK(map.size() == 1000);
+        CHECK(map.begin()->first == "999");
+        CHECK(map.at("500") == 500);
+    }
+}
+
+TEST_CASE("test_btree_set", "[containers]")
+{
+    monotonic::storage<> storage;
+    {
+        monotonic::btree_set<double> set(storage);
+        for (int n = 0; n < 10000; ++n)
+            set.insert(n*0.5);
+        CHECK(set.size() == 10000);
+        CHECK(*set.lower_bound(100.25) == 100.5);
+        CHECK(*set.upper_bound(100.5) == 101.0);
+        CHECK(set.count(4999.5) == 1);
+        CHECK(set.count(4999.75) == 0);
+        CHECK(std::is_sorted(set.begin(), set.end()));
+    }
+    {
+        // ascending inserts fill every node, so use no more storage than a bulk load
+        std::vector<int> values(10000);
+        std::iota(values.begin(), values.end(), 0);
+        size_t before = storage.used();
+        monotonic::btree_set<int> loaded(monotonic::ordered_unique_range, values.begin(), values.end(), std::less<int>(), storage);
+        size_t bulk = storage.used() - before;
+        before = storage.used();
+        monotonic::btree_set<int> ascending(values.begin(), values.end(), std::less<int>(), storage);
+#ifndef BOOST_MONOTONIC_POISON
+        // red zones are not in proportion to the nodes made
+        CHECK(storage.used() - before <= bulk + bulk/10);
+#endif
+        CHECK(loaded == ascending);
+        CHECK(loaded.erase(5000) == 1);
+        CHECK(loaded.find(5000) == loaded.end());
+        CHECK(loaded != ascending);
+    }
+}
+
+TEST_CASE("test_small_vector", "[containers]")
+{
+    monotonic::storage<> storage;
+    {
+        // the most recent allocation can grow in place, but no other
+        void *ptr = storage.allocate(200, 8);
+        CHECK(storage.extend(ptr, 200, 400));
+        storage.allocate(200, 8);
+        CHECK(!storage.extend(ptr, 400, 600));
+        storage.reset();
+    }
+    {
+        // no storage is used until the inline capacity is exceeded
+        monotonic::small_vector<int, 8> vec(storage);
+        for (int n = 0; n < 8; ++n)
+            vec.push_back(n);
+        CHECK(vec.is_inline());
+        CHECK(storage.used() == 0);
+        vec.push_back(8);
+        CHECK(!vec.is_inline());
+        CHECK(storage.used() > 0);
+
+        // with nothing allocated after it, the buffer grows at the end of the storage
+        vec.reserve(64);
+        int *data = vec.data();
+        for (int n = 9; n < 1000; ++n)
+            vec.push_back(n);
+        CHECK(vec.data() == data);
+        CHECK(vec.capacity() >= 1000);
+
+        // otherwise it is moved
+        storage.allocate(16, 16);
+        vec.reserve(vec.capacity() + 1);
+        CHECK(vec.data() != data);
+        bool ordered = true;
+        for (int n = 0; n < 1000; ++n)
+            ordered = ordered && vec[n] == n;
+        CHECK(ordered);
+
+        vec.erase(vec.begin() + 10, vec.end());
+        vec.insert(vec.begin(), -1);
+        vec.erase(vec.begin() + 1);
+        CHECK(vec.size() == 10);
+        CHECK(vec.front() == -1);
+        CHECK(vec.back() == 9);
+        CHECK_THROWS_AS(vec.at(10), std::out_of_range);
+    }
+    storage.reset();
+    {
+        // pushing an element of a full vector copies it before the buffer moves
+        typedef monotonic::small_vector<std::string, 2> Strings;
+        Strings strings(storage);
+        strings.push_back("spam");
+        strings.push_back("eggs");
+        strings.push_back(strings[0]);
+        strings.emplace(strings.begin() + 1, "ham");
+        CHECK(strings.size() == 4);
+        CHECK(strings[0] == "spam");
+        CHECK(strings[1] == "ham");
+        CHECK(strings[3] == "spam");
+
+        // moving a spilled vector takes its buffer, moving an inline one moves its elements
+        size_t used = storage.used();
+        Strings moved(std::move(strings));
+        CHECK(storage.used() == used);
+        CHECK(strings.empty());
+        CHECK(strings.is_inline());
+        CHECK(moved.size() == 4);
+        Strings small(2, "bacon", storage);
+        Strings other(std::move(small));
+        CHECK(other.is_inline());
+        CHECK(other[1] == "bacon");
+        CHECK(storage.used() == used);
+
+        Strings copy(moved);
+        CHECK(copy == moved);
+        copy.swap(other);
+        CHECK(other == moved);
+        CHECK(copy.size() == 2);
+        CHECK(copy < moved);
+    }
+    storage.reset();
+    {
+        // nested in a map, short vectors use no storage of their own
+        typedef monotonic::small_vector<int, 4> Inner;
+        monotonic::map<int, Inner> map(storage);
+        for (int n = 0; n < 30; ++n)
+            map[n % 10].push_back(n);
+        size_t used = storage.used();
+        for (int n = 0; n < 10; ++n)
+            map[n].push_back(n);
+        CHECK(storage.used() == used);
+        CHECK(map[3].size() == 4);
+        CHECK(map[3].is_inline());
+        CHECK(map[3].get_allocator().get_storage() == &storage);
+        map[3].push_back(42);
+        CHECK(storage.used() > used);
+    }
+}
+
+TEST_CASE("test_dynamic_bitset", "[containers]")
+{
+    typedef monotonic::dynamic_bitset<> Bitset;
+    monotonic::storage<> storage;
+    {
+        Bitset bits(1000, storage);
+        CHECK(bits.size() == 1000);
+        CHECK(bits.num_blocks() == 16);
+        CHECK(bits.none());
+        CHECK(bits.find_first() == Bitset::npos);
+        std::vector<size_t> expected;
+        for (size_t n = 3; n < 1000; n += 97)
+        {
+            bits.set(n);
+            expected.push_back(n);
+        }
+        CHECK(bits.count() == expected.size());
+        std::vector<size_t> found;
+        for (size_t n = bits.find_first(); n != Bitset::npos; n = bits.find_next(n))
+            found.push_back(n);
+        CHECK(found == expected);
+        CHECK(bits.test(100));
+        CHECK(!bits.test(101));
+        CHECK_THROWS_AS(bits.test(1000), std::out_of_range);
+
+        // bits past the end stay clear, so counts and comparisons only see size() bits
+        bits.set();
+        CHECK(bits.count() == 1000);
+        CHECK(bits.all());
+        bits.resize(999);
+        CHECK(bits.count() == 999);
+        bits.resize(1100, false);
+        CHECK(bits.count() == 999);
+        bits.resize(1200, true);
+        CHECK(bits.count() == 1099);
+        bits.flip();
+        CHECK(bits.count() == 101);
+        CHECK(bits.find_first() == 999);
+        CHECK(bits.find_next(999) == 1000);
+        CHECK(bits.find_next(1099) == Bitset::npos);
+        bits[1099].flip();
+        CHECK(!bits[1099]);
+        CHECK(bits.count() == 100);
+    }
+    {
+        // the bulk operations agree with std::bitset
+        std::mt19937 random(42);
+        std::bitset<777> a, b;
+        Bitset x(777, storage), y(777, storage);
+        for (size_t n = 0; n < 777; ++n)
+        {
+            bool p = random() & 1, q = random() % 3 == 0;
+            a[n] = p;
+            x[n] = p;
+            b[n] = q;
+            y[n] = q;
+        }
+        CHECK(x.count() == a.count());
+        Bitset z = x;
+        z &= y;
+        CHECK(z.count() == (a & b).count());
+        CHECK(z.is_subset_of(x));
+        CHECK(z.intersects(y) == (a & b).any());
+        z = x;
+        z |= y;
+        CHECK(z.count() == (a | b).count());
+        z = x;
+        z ^= y;
+        CHECK(z.count() == (a ^ b).count());
+        z = x;
+        z -= y;
+        CHECK(z.count() == (a & ~b).count());
+        CHECK(!z.intersects(y));
+        CHECK((~x).count() == 777 - a.count());
+        CHECK(z != x);
+        Bitset other(776, storage);
+        CHECK_THROWS_AS(z &= other, std::invalid_argument);
+    }
+    storage.reset();
+    {
+        // a bitset that is built bit by bit grows in place
+        Bitset bits(storage);
+        for (size_t n = 0; n < 10000; ++n)
+            bits.push_back(n % 3 == 0);
+        CHECK(bits.count() == 3334);
+        Bitset::block_type const *data = bits.data();
+        for (size_t n = 0; n < 10000; ++n)
+            bits.push_back(true);
+        CHECK(bits.data() == data);
+        CHECK(bits.count() == 13334);
+        Bitset moved(std::move(bits));
+        CHECK(bits.empty());
+        CHECK(moved.count() == 13334);
+        CHECK(moved.get_allocator().get_storage() == &storage);
+    }
+}
+
 
 /* fatal error in "test_chain": R6010
 BOOST_AUTO_TEST_CASE(test_chain)
@@ -431,6 +1052,50 @@ TEST_CASE("test_local", "[storage]")
     }
 }
 
+TEST_CASE("test_local_allocator", "[storage]")
+{
+    monotonic::local<region0> storage0;
+    monotonic::allocator<int, region0> alloc = storage0.make_allocator<int>();
+    CHECK(alloc.get_storage() == &monotonic::static_storage<region0>::get_storage());
+    CHECK(alloc == monotonic::allocator<int, region0>());
+    CHECK(monotonic::local<region0>::make_allocator<int>() == alloc);
+}
+
+TEST_CASE("test_arena_allocator", "[allocation]")
+{
+    typedef monotonic::arena_allocator<int> Alloc;
+    typedef std::vector<int, Alloc> Vector;
+    monotonic::storage<> arena0, arena1;
+    Alloc alloc0(arena0), alloc1(arena1);
+    {
+        Vector v0(alloc0), v1(alloc1);
+        for (int n = 0; n < 10; ++n)
+            v0.push_back(n);
+        CHECK(arena0.used() > 0);
+        CHECK(arena1.used() == 0);
+
+        // copies share the arena of the original
+        Vector copy(v0);
+        CHECK(copy.get_allocator() == v0.get_allocator());
+
+        // assignment and swap carry the arena with the elements
+        v1 = v0;
+        CHECK(v1.get_allocator() == v0.get_allocator());
+        CHECK(arena1.used() == 0);
+
+        Vector v2(alloc1);
+        v2.swap(v0);
+        CHECK(&v2.get_allocator().get_storage() == &arena0);
+        CHECK(&v0.get_allocator().get_storage() == &arena1);
+        CHECK(v2.size() == 10);
+
+        // rebinding keeps the arena
+        std::list<int, Alloc> list(alloc1);
+        list.push_back(42);
+        CHECK(list.get_allocator() == v0.get_allocator());
+    }
+}
+
 //struct region0 {};
 //struct region1 {};
 
@@ -450,6 +1115,58 @@ TEST_CASE("test_shared_allocation", "[allocation]")
 
     //// use different regions
     //monotonic::map<int, monotonic::list<monotonic::string, region1>, region0> map;
+
+    struct shared_region { };
+    typedef monotonic::static_storage<shared_region, monotonic::shared_access_tag> Shared;
+    typedef monotonic::static_storage<shared_region, monotonic::thread_local_access_tag> ThreadLocal;
+    {
+        // threads allocating from shared storage see one storage
+        std::vector<std::thread> threads;
+        for (int n = 0; n < 4; ++n)
+        {
+            threads.emplace_back([] {
+                std::list<int, monotonic::shared_allocator<int, shared_region> > list;
+                for (int k = 0; k < 1000; ++k)
+                    list.push_back(k);
+            });
+        }
+        for (std::thread &thread : threads)
+            thread.join();
+        CHECK(Shared::used() >= 4*1000*sizeof(int));
+        Shared::release();
+        CHECK(Shared::used() == 0);
+    }
+    {
+        // each thread has its own thread-local storage
+        size_t used[2] = { 0, 0 };
+        auto work = [](size_t count, size_t &result) {
+            std::vector<int, monotonic::allocator<int, shared_region, monotonic::thread_local_access_tag> > vec;
+            vec.reserve(count);
+            result = ThreadLocal::used();
+        };
+        std::thread first(work, 100, std::ref(used[0]));
+        std::thread second(work, 1000, std::ref(used[1]));
+        first.join();
+        second.join();
+        CHECK(used[0] >= 100*sizeof(int));
+        CHECK(used[0] < 1000*sizeof(int));
+        CHECK(used[1] >= 1000*sizeof(int));
+        CHECK(ThreadLocal::used() == 0);
+    }
+    {
+        // each region has its own thread-local storage, so resetting one leaves the other
+        struct other_region { };
+        typedef monotonic::static_storage<other_region, monotonic::thread_local_access_tag> OtherThreadLocal;
+        std::vector<int, monotonic::allocator<int, shared_region, monotonic::thread_local_access_tag> > vec;
+        vec.reserve(100);
+        size_t used = ThreadLocal::used();
+        CHECK(used >= 100*sizeof(int));
+        OtherThreadLocal::allocate(64, 8);
+        OtherThreadLocal::reset();
+        CHECK(OtherThreadLocal::used() == 0);
+        CHECK(ThreadLocal::used() == used);
+        ThreadLocal::reset();
+    }
 }
 
 TEST_CASE("test_regional_allocation", "[allocation]")
@@ -473,9 +1190,9 @@ TEST_CASE("test_local_storage", "[allocation]")
     monotonic::storage<10*1024> storage;
     {
         storage.allocate_bytes(123);
-        CHECK(storage.fixed_used() == 123);
+        CHECK(storage.fixed_used() == 123 + monotonic::detail::red_zone);
         CHECK(storage.heap_used() == 0);
-        CHECK(storage.used() == 123);
+        CHECK(storage.used() == 123 + monotonic::detail::red_zone);
 
         storage.reset();
         CHECK(storage.fixed_used() == 0);
@@ -493,25 +1210,414 @@ TEST_CASE("test_local_storage", "[allocation]")
 
 TEST_CASE("test_local_storage_to_heap", "[storage]")
 {
-    monotonic::storage<16> storage;
+    // requests larger than the largest pool chunk go straight to the inline
+    // buffer or the heap, so each uses exactly the bytes it asks for and a red zone
+    monotonic::storage<256> storage;
     {
-        storage.allocate_bytes(16);
+        storage.allocate_bytes(200);
+        CHECK(storage.fixed_used() == 200 + monotonic::detail::red_zone);
         CHECK(storage.heap_used() == 0);
 
         storage.allocate_bytes(200);
-        CHECK(storage.heap_used() == 200);
+        CHECK(storage.fixed_used() == 200 + monotonic::detail::red_zone);
+        CHECK(storage.heap_used() == 200 + monotonic::detail::red_zone);
 
         storage.release();
 
         CHECK(storage.used() == 0);
         storage.allocate_bytes<2000>();
         CHECK(storage.fixed_used() == 0);
-        CHECK(storage.heap_used() == 2000);
+        CHECK(storage.heap_used() == 2000 + monotonic::detail::red_zone);
+
+        storage.allocate_bytes(120);
+        CHECK(storage.fixed_used() == 120 + monotonic::detail::red_zone);
+        CHECK(storage.heap_used() == 2000 + monotonic::detail::red_zone);
+    }
+}
+
+TEST_CASE("test_compact_on_reset", "[storage]")
+{
+    monotonic::storage<16, 1024> storage;
+    storage.set_compact_on_reset(true);
+    for (size_t n = 0; n < 3; ++n)
+        storage.allocate_bytes(700);
+    CHECK(storage.num_links() == 2);
+
+    size_t used = storage.heap_used();
+    storage.reset();
+    CHECK(storage.num_links() == 1);
+    CHECK(storage.heap_used() == 0);
+    CHECK(storage.get_heap_peak() == used);
+
+    // the same cycle now fits in the single coalesced link
+    for (size_t n = 0; n < 3; ++n)
+        storage.allocate_bytes(700);
+    CHECK(storage.num_links() == 1);
+    CHECK(storage.heap_used() == used);
+
+    // allocations aligned beyond a cache-line also fit once coalesced
+    monotonic::storage<16, 1024> aligned;
+    aligned.set_compact_on_reset(true);
+    for (size_t n = 0; n < 5; ++n)
+        aligned.allocate(700, 512);
+    CHECK(aligned.num_links() > 1);
+    CHECK(aligned.get_heap_peak() == aligned.heap_used());
+    aligned.reset();
+    CHECK(aligned.num_links() == 1);
+    for (size_t n = 0; n < 5; ++n)
+        aligned.allocate(700, 512);
+    CHECK(aligned.num_links() == 1);
+}
+
+#ifdef BOOST_MONOTONIC_POISON
+TEST_CASE("test_poison", "[storage]")
+{
+    monotonic::storage<1024, 4096> storage;
+    char *fixed = storage.allocate_bytes(100, 8);
+    char *pooled = storage.allocate_bytes(20, 8);
+    char *heap = storage.allocate_bytes(2000, 8);
+    char *ptrs[] = { fixed, pooled, heap };
+    size_t sizes[] = { 100, 20, 2000 };
+    for (size_t n = 0; n < 3; ++n)
+    {
+        CHECK(__asan_region_is_poisoned(ptrs[n], sizes[n]) == 0);
+        // the red zone after it
+        CHECK(__asan_address_is_poisoned(ptrs[n] + sizes[n]));
+    }
+    CHECK(storage.extend(heap, 2000, 2010));
+    CHECK(__asan_region_is_poisoned(heap, 2010) == 0);
+    CHECK(__asan_address_is_poisoned(heap + 2010));
+
+    storage.reset();
+    for (size_t n = 0; n < 3; ++n)
+        CHECK(__asan_address_is_poisoned(ptrs[n]));
+    char *again = storage.allocate_bytes(100, 8);
+    CHECK(again == fixed);
+    CHECK(__asan_region_is_poisoned(again, 100) == 0);
+}
+#endif
+
+TEST_CASE("test_sizing_advisor", "[storage]")
+{
+    monotonic::sizing_advisor advisor;
+    size_t alarms = 0;
+    advisor.set_alarm([&alarms](monotonic::sizing_advisor::site const &site, size_t num_bytes, size_t)
+    {
+        CHECK(site.name == "test");
+        CHECK(num_bytes == 800);
+        ++alarms;
+    });
+    {
+        monotonic::storage<1024, 4096> storage;
+        storage.set_observer(&advisor.get_site("test"));
+        storage.allocate(600, 1);
+        storage.reset();
+        CHECK(storage.num_spills() == 0);
+        CHECK(alarms == 0);
+
+        // the second allocation does not fit in the inline buffer
+        storage.allocate(600, 1);
+        storage.allocate(800, 1);
+        storage.allocate(800, 1);
+        CHECK(storage.num_spills() == 1);
+        CHECK(alarms == 1);
+        storage.reset();
+        CHECK(storage.get_fixed_peak() >= 600);
+        CHECK(storage.get_heap_peak() >= 1600);
+
+        // an empty cycle is not counted
+        storage.reset();
+    }
+
+    std::vector<monotonic::sizing_advisor::site> sites = advisor.get_sites();
+    REQUIRE(sites.size() == 1);
+    monotonic::sizing_advisor::site const &site = sites[0];
+    CHECK(site.cycles == 2);
+    CHECK(site.spills == 1);
+    CHECK(site.inline_size == 1024);
+    CHECK(site.min_heap_increment == 4096);
+    CHECK(site.peak >= 2200);
+    CHECK(site.peak == site.fixed_peak + site.heap_peak);
+    CHECK(site.recommended_inline_size() == 4096);
+    CHECK(site.recommended_min_heap_increment() == 4096);
+
+    std::ostringstream dump;
+    advisor.dump(dump);
+    CHECK(dump.str().find("test") != std::string::npos);
+}
+
+/// two allocations either side of an exclusive one, which must have its own lines
+template <class Storage>
+void check_exclusive_line(Storage &storage)
+{
+    size_t line = monotonic::hint::line_size;
+    char *before = (char *)storage.allocate(8, 1);
+    char *exclusive = (char *)storage.allocate(24, 8, monotonic::hint::exclusive_line);
+    char *after = (char *)storage.allocate(8, 1);
+    REQUIRE(exclusive != 0);
+    CHECK(reinterpret_cast<size_t>(exclusive) % line == 0);
+    CHECK(reinterpret_cast<size_t>(before)/line != reinterpret_cast<size_t>(exclusive)/line);
+    CHECK(reinterpret_cast<size_t>(after)/line != reinterpret_cast<size_t>(exclusive)/line);
+}
+
+struct Counter : monotonic::contended
+{
+    std::atomic<size_t> count;
+};
+
+TEST_CASE("test_exclusive_line", "[storage]")
+{
+    CHECK(monotonic::hint::line_size >= 32);
+    CHECK((monotonic::hint::line_size & (monotonic::hint::line_size - 1)) == 0);
+
+    monotonic::storage<> storage;
+    check_exclusive_line(storage);
+    monotonic::shared_storage<monotonic::storage<> > shared;
+    check_exclusive_line(shared);
+    std::unique_ptr<monotonic::fixed_storage<4096> > fixed(new monotonic::fixed_storage<4096>());
+    check_exclusive_line(*fixed);
+    monotonic::reclaimable_storage<> reclaimable;
+    void *aligned = reclaimable.allocate(100, 256);
+    CHECK(reinterpret_cast<size_t>(aligned) % 256 == 0);
+    reclaimable.deallocate(aligned);
+    void *exclusive = reclaimable.allocate(8, 1, monotonic::hint::exclusive_line);
+    CHECK(reinterpret_cast<size_t>(exclusive) % monotonic::hint::line_size == 0);
+    reclaimable.deallocate(exclusive);
+    // each block records what was allocated for it, so blocks of any alignment can be
+    // given back in any order, from any thread
+    std::vector<char *> blocks;
+    for (size_t n = 0; n < 64; ++n)
+    {
+        size_t alignment = size_t(1) << (n % 10);
+        char *block = reclaimable.allocate_bytes(n + 1, alignment);
+        CHECK(reinterpret_cast<size_t>(block) % alignment == 0);
+        std::fill_n(block, n + 1, char(n));
+        blocks.push_back(block);
+    }
+    std::thread([&] {
+        for (size_t n = 0; n < blocks.size(); n += 2)
+            reclaimable.deallocate(blocks[n]);
+    }).join();
+    for (size_t n = 1; n < blocks.size(); n += 2)
+    {
+        CHECK(std::count(blocks[n], blocks[n] + n + 1, char(n)) == std::ptrdiff_t(n + 1));
+        reclaimable.deallocate(blocks[n]);
+    }
+
+    // the padding means a second exclusive allocation starts on a later line
+    monotonic::storage_base &base = storage;
+    char *first = (char *)base.allocate(1, 1, monotonic::hint::exclusive_line);
+    char *second = (char *)base.allocate(1, 1, monotonic::hint::exclusive_line);
+    CHECK(reinterpret_cast<size_t>(first)/monotonic::hint::line_size != reinterpret_cast<size_t>(second)/monotonic::hint::line_size);
+
+    // contended types are given lines of their own by allocators
+    CHECK(monotonic::is_contended<Counter>::value);
+    CHECK(!monotonic::is_contended<int>::value);
+    monotonic::allocator<Counter> alloc(storage);
+    monotonic::allocator<int> ints(storage);
+    Counter *counter = alloc.allocate(1);
+    int *neighbour = ints.allocate(1);
+    CHECK(reinterpret_cast<size_t>(counter) % monotonic::hint::line_size == 0);
+    CHECK(reinterpret_cast<size_t>(neighbour)/monotonic::hint::line_size != reinterpret_cast<size_t>(counter)/monotonic::hint::line_size);
+}
+
+TEST_CASE("test_numa_storage", "[storage]")
+{
+    typedef monotonic::numa_storage<64*1024> Numa;
+    REQUIRE(Numa::num_nodes() >= 1);
+    CHECK(Numa::current_node() >= 0);
+    CHECK(Numa::current_node() < Numa::num_nodes());
+
+    Numa storage;
+    CHECK(storage.get_pinned() == -1);
+    int home = storage.home_node();
+    CHECK(home >= 0);
+    CHECK(home < Numa::num_nodes());
+
+    // the memory is on the node of the thread that asked for it
+    char *ptr = (char *)storage.allocate(100, 16);
+    REQUIRE(ptr != 0);
+    CHECK(reinterpret_cast<size_t>(ptr) % 16 == 0);
+    ptr[0] = 42;
+    int node = Numa::node_of(ptr);
+    CHECK((node == -1 || node == home || Numa::num_nodes() > 1));
+    CHECK(storage.used(home) >= 100);
+    CHECK(storage.reserved(home) >= 64*1024);
+    CHECK(storage.extend(ptr, 100, 200));
+
+    // allocations larger than a link get a link of their own
+    char *large = (char *)storage.allocate(100*1024, 8);
+    REQUIRE(large != 0);
+    large[100*1024 - 1] = 1;
+    CHECK(storage.reserved(home) >= 64*1024 + 200*1024);
+
+    // the room left in the first link is used once the large one is full
+    storage.pin(home);
+    size_t reserved = storage.reserved(home);
+    size_t room = reserved - storage.used(home);
+    for (size_t n = 0; n + 2 < room/(1024 + monotonic::detail::red_zone); ++n)
+        storage.allocate(1024, 8);
+    CHECK(storage.reserved(home) == reserved);
+    storage.unpin();
+
+    // pinned, every thread allocates from the same node
+    storage.pin(Numa::num_nodes() - 1);
+    CHECK(storage.home_node() == Numa::num_nodes() - 1);
+    CHECK_THROWS_AS(storage.pin(Numa::num_nodes()), std::out_of_range);
+    storage.unpin();
+    CHECK(storage.get_pinned() == -1);
+
+    // threads allocate at the same time without overlapping
+    std::vector<std::thread> threads;
+    std::vector<std::vector<char *> > made(4);
+    for (size_t n = 0; n < made.size(); ++n)
+    {
+        threads.push_back(std::thread([&storage, &made, n]()
+        {
+            for (int k = 0; k < 1000; ++k)
+            {
+                char *block = (char *)storage.allocate(32, 8);
+                std::fill(block, block + 32, char(n));
+                made[n].push_back(block);
+            }
+        }));
+    }
+    for (std::thread &thread : threads)
+        thread.join();
+    bool intact = true;
+    for (size_t n = 0; n < made.size(); ++n)
+    {
+        for (char *block : made[n])
+            intact = intact && std::count(block, block + 32, char(n)) == 32;
+    }
+    CHECK(intact);
+
+    size_t used = storage.used();
+    CHECK(used >= 4*1000*32);
+    storage.reset();
+    CHECK(storage.used() == 0);
+    CHECK(storage.reserved(home) >= 64*1024);
+    storage.release();
+    CHECK(storage.reserved(home) == 0);
+}
+
+TEST_CASE("test_recording_storage", "[storage]")
+{
+    monotonic::storage<> inner;
+    std::stringstream trace;
+    {
+        monotonic::recording_storage recorder(inner, trace);
+        {
+            std::vector<int, monotonic::allocator<int> > vec(recorder);
+            for (int n = 0; n < 3; ++n)
+                vec.push_back(n);
+        }
+        void *ptr = recorder.allocate(200, 16);
+        CHECK(recorder.extend(ptr, 200, 250));
+        recorder.reset();
+        CHECK(recorder.num_allocations() == 4);
+    }
+
+    std::vector<monotonic::trace_event> events;
+    monotonic::read_trace(trace, events);
+    // the vector grows from one to two to four ints, freeing each old buffer
+    monotonic::trace_op ops[] =
+    {
+        monotonic::trace_allocate, monotonic::trace_allocate, monotonic::trace_deallocate,
+        monotonic::trace_allocate, monotonic::trace_deallocate, monotonic::trace_deallocate,
+        monotonic::trace_allocate, monotonic::trace_extend, monotonic::trace_reset,
+    };
+    REQUIRE(events.size() == sizeof(ops)/sizeof(ops[0]));
+    for (size_t n = 0; n < events.size(); ++n)
+    {
+        CHECK(events[n].op == ops[n]);
+        CHECK(events[n].thread == 0);
+    }
+    CHECK(events[0].size == sizeof(int));
+    CHECK(events[0].alignment == alignof(int));
+    CHECK(events[2].id == 0);
+    CHECK(events[3].size == 4*sizeof(int));
+    CHECK(events[6].id == 3);
+    CHECK(events[6].size == 200);
+    CHECK(events[6].alignment == 16);
+    CHECK(events[7].size == 250);
+
+    std::stringstream bad("not a trace");
+    CHECK_THROWS_AS(monotonic::read_trace(bad, events), std::runtime_error);
+}
+
+TEST_CASE("test_tracing_storage", "[storage]")
+{
+    std::stringstream trace;
+    {
+        monotonic::tracing_storage<monotonic::shared_storage<monotonic::storage<> > > tracer(trace, true);
+        void *ptr = tracer.allocate(200, 16);
+        CHECK(tracer.extend(ptr, 200, 250));
+        std::thread other([&tracer]()
+        {
+            tracer.deallocate(tracer.allocate(8, 8));
+        });
+        other.join();
+        tracer.flush();
+        tracer.reset();
+        CHECK(tracer.dropped() == 0);
+    }
+
+    std::vector<monotonic::trace_record> records;
+    monotonic::read_trace_records(trace, records);
+    REQUIRE(records.size() == 5);
+    for (size_t n = 1; n < records.size(); ++n)
+        CHECK(records[n - 1].time <= records[n].time);
+    CHECK(records[0].op == monotonic::trace_allocate);
+    CHECK(records[0].size == 200);
+    CHECK(records[0].alignment == 4);
+    CHECK(records[0].thread == 0);
+    CHECK(records[0].caller != 0);
+    CHECK(records[1].op == monotonic::trace_extend);
+    CHECK(records[1].address == records[0].address);
+    CHECK(records[2].thread == 1);
+    CHECK(records[3].op == monotonic::trace_deallocate);
+    CHECK(records[3].address == records[2].address);
+    CHECK(records[4].op == monotonic::trace_reset);
+
+    std::vector<monotonic::trace_event> events;
+    monotonic::to_trace_events(records, events);
+    REQUIRE(events.size() == 5);
+    CHECK(events[1].id == 0);
+    CHECK(events[1].size == 250);
+    CHECK(events[3].id == 1);
+    CHECK(events[0].alignment == 16);
+
+    // events that do not fit in a ring are dropped until the flusher empties it
+    std::stringstream small;
+    {
+        monotonic::tracing_storage<monotonic::storage<>, 4> tracer(small, false, std::chrono::milliseconds(10000));
+        for (int n = 0; n < 6; ++n)
+            tracer.allocate(4, 4);
+        CHECK(tracer.dropped() == 2);
+        tracer.flush();
+        tracer.allocate(4, 4);
+    }
+    records.clear();
+    monotonic::read_trace_records(small, records);
+    CHECK(records.size() == 5);
+    CHECK(records[0].caller == 0);
+
+    std::stringstream bad("not a trace");
+    CHECK_THROWS_AS(monotonic::read_trace_records(bad, records), std::runtime_error);
+}
 
-        storage.allocate_bytes<10>();
-        CHECK(storage.fixed_used() == 10);
-        CHECK(storage.heap_used() == 2000);
+TEST_CASE("test_static_fixed_storage", "[storage]")
+{
+    typedef monotonic::static_fixed_storage<region0, 1024> Static;
+    {
+        std::vector<int, monotonic::allocator<int, region0> > vec(Static::get_storage());
+        vec.reserve(10);
+        CHECK(Static::used() >= 10*sizeof(int));
+        CHECK(Static::allocate(2048, 1) == 0);
     }
+    Static::reset();
+    CHECK(Static::used() == 0);
 }
 
 TEST_CASE("test_local_storage_iter", "[storage]")
@@ -581,6 +1687,265 @@ TEST_CASE("test_local_storage_iter", "[storage]")
 //    monotonic::reset_storage();
 //}
 
+TEST_CASE("test_nested_move", "[containers]")
+{
+    typedef monotonic::vector<int> Inner;
+    monotonic::storage<> storage;
+    {
+        monotonic::vector<Inner> outer(storage);
+        outer.reserve(4);
+
+        Inner inner(storage);
+        for (int n = 0; n < 100; ++n)
+            inner.push_back(n);
+
+        // moving a nested container into the same storage relocates it
+        size_t used = storage.used();
+        outer.push_back(std::move(inner));
+        CHECK(storage.used() == used);
+        CHECK(outer[0].size() == 100);
+        CHECK(outer[0].get_allocator().get_storage() == &storage);
+
+        // copying one uses the allocator of the outer container
+        outer.push_back(outer[0]);
+        CHECK(storage.used() > used);
+        CHECK(outer[1] == outer[0]);
+        CHECK(outer[1].get_allocator().get_storage() == &storage);
+
+        monotonic::map<int, Inner> map(storage);
+        map[1].push_back(42);
+        used = storage.used();
+        monotonic::map<int, Inner> moved(std::move(map));
+        CHECK(storage.used() == used);
+        CHECK(moved[1].size() == 1);
+
+        // moving into a different storage copies the elements there
+        monotonic::storage<> other;
+        Inner elsewhere(std::move(outer[1]), Inner::Allocator(other));
+        CHECK(elsewhere.size() == 100);
+        CHECK(other.used() > 0);
+    }
+}
+
+struct entity
+{
+    virtual ~entity() { }
+    virtual int value() const = 0;
+};
+
+struct particle : entity
+{
+    int n;
+    particle(int N) : n(N) { }
+    int value() const { return n; }
+};
+
+struct emitter : entity
+{
+    int n;
+    double rate;
+    emitter(int N, double R) : n(N), rate(R) { }
+    int value() const { return 100*n; }
+};
+
+TEST_CASE("test_segregated_vector", "[heterogenous]")
+{
+    monotonic::storage<> storage;
+    {
+        typedef heterogenous::segregated_vector<entity, monotonic::allocator<int> > Entities;
+        monotonic::allocator<int> alloc(storage);
+        Entities entities(alloc);
+        entities.reserve<particle>(4);
+        entities.emplace_back<particle>(1);
+        entities.emplace_back<emitter>(2, 0.5);
+        entities.emplace_back<particle>(3);
+        entities.emplace_back<particle>(4);
+        REQUIRE(entities.size() == 4);
+        REQUIRE(entities.count<particle>() == 3);
+        REQUIRE(entities.count<emitter>() == 1);
+
+        // each type is visited contiguously
+        int sum = 0;
+        particle const *prev = 0;
+        entities.for_each<particle>([&](particle &p)
+        {
+            if (prev)
+                CHECK(&p == prev + 1);
+            prev = &p;
+            sum += p.n;
+        });
+        CHECK(sum == 8);
+
+        // all objects are visited in order of insertion
+        int expected[] = { 1, 200, 3, 4 };
+        int *value = expected;
+        for (Entities::iterator E = entities.begin(); E != entities.end(); ++E)
+            CHECK(E->value() == *value++);
+
+        CHECK(entities.is_type_at<emitter>(1));
+        CHECK(!entities.is_type_at<particle>(1));
+        CHECK(entities.ref_at<emitter>(1).rate == 0.5);
+        CHECK_THROWS_AS(entities.ref_at<particle>(1), std::bad_cast);
+    }
+    CHECK(storage.used() > 0);
+}
+
+struct node0 : heterogenous::cloneable<node0>
+{
+    int n;
+    node0(int N = 0) : n(N) { }
+};
+
+struct node1 : heterogenous::cloneable<node1>
+{
+    std::string name;
+    node1(std::string const &S = "") : name(S) { }
+};
+
+TEST_CASE("test_heterogenous_clone_into", "[heterogenous]")
+{
+    {
+        heterogenous::vector<> scene;
+        scene.emplace_back<node0>(42);
+        scene.emplace_back<node1>("foo");
+        scene.emplace_back<node0>(7);
+
+        monotonic::storage<> snapshot_storage;
+        heterogenous::vector<> snapshot;
+        scene.clone_into(snapshot, snapshot_storage);
+
+        REQUIRE(snapshot.size() == 3);
+        CHECK(snapshot.ref_at<node0>(0).n == 42);
+        CHECK(snapshot.ref_at<node1>(1).name == "foo");
+        CHECK(snapshot.ref_at<node0>(2).n == 7);
+        CHECK(&snapshot.ref_at<node0>(0) != &scene.ref_at<node0>(0));
+        CHECK(snapshot_storage.used() >= 2*sizeof(node0) + sizeof(node1));
+
+        // all copies are in one block
+        char *first = reinterpret_cast<char *>(&snapshot.ref_at<node0>(0));
+        char *last = reinterpret_cast<char *>(&snapshot.ref_at<node0>(2));
+        CHECK(last - first < ptrdiff_t(2*sizeof(node0) + sizeof(node1) + 2*alignof(node1)));
+    }
+    monotonic::reset_storage();
+}
+
+struct alignas(32) aligned_node : heterogenous::cloneable<aligned_node>
+{
+    float v[8];
+};
+
+TEST_CASE("test_clone_allocator_alignment", "[heterogenous]")
+{
+    CHECK(aligned_node::alignment == 32);
+
+    aligned_node node;
+    node.v[3] = 42;
+
+    // a general allocator: uses a header to find the original allocation
+    typedef heterogenous::make_clone_allocator<std::allocator<char> >::type HeapCloneAlloc;
+    HeapCloneAlloc heap_alloc;
+    heterogenous::abstract_cloneable<heterogenous::default_base_type> *copy = node.clone(heap_alloc);
+    aligned_node *heap_copy = dynamic_cast<aligned_node *>(copy);
+    REQUIRE(heap_copy != 0);
+    CHECK(reinterpret_cast<size_t>(heap_copy) % 32 == 0);
+    CHECK(heap_copy->v[3] == 42);
+    copy->deallocate(heap_alloc);
+
+    // a monotonic allocator: no header, aligned by the storage
+    monotonic::storage<> storage;
+    monotonic::allocator<char> alloc(storage);
+    typedef heterogenous::make_clone_allocator<monotonic::allocator<char> >::type CloneAlloc;
+    CloneAlloc mono_alloc(alloc);
+    aligned_node *first = dynamic_cast<aligned_node *>(node.clone(mono_alloc));
+    aligned_node *second = dynamic_cast<aligned_node *>(node.clone(mono_alloc));
+    REQUIRE(first != 0);
+    REQUIRE(second != 0);
+    CHECK(reinterpret_cast<size_t>(first) % 32 == 0);
+    CHECK(reinterpret_cast<size_t>(second) % 32 == 0);
+    CHECK(size_t(reinterpret_cast<char *>(second) - reinterpret_cast<char *>(first)) == (sizeof(aligned_node) + monotonic::detail::red_zone + 31)/32*32);
+}
+
+struct map_base
+{
+    virtual ~map_base() { }
+    virtual int id() const = 0;
+    friend bool operator<(map_base const &A, map_base const &B)
+    {
+        return A.id() < B.id();
+    }
+};
+
+struct map_key : heterogenous::cloneable<map_key, map_base>
+{
+    int n;
+    map_key(int N = 0) : n(N) { }
+    int id() const { return n; }
+    size_t hash_value() const { return n + 1; }
+};
+
+struct map_value : heterogenous::cloneable<map_value, map_base>
+{
+    std::string name;
+    map_value(std::string const &S = "") : name(S) { }
+    int id() const { return -1; }
+};
+
+TEST_CASE("test_heterogenous_map", "[heterogenous]")
+{
+    monotonic::storage<> storage;
+    {
+        typedef heterogenous::map<map_base, std::less<map_base>, monotonic::allocator<int> > Map;
+        monotonic::allocator<int> alloc(storage);
+        Map map(alloc);
+        map.reserve(4);
+        for (int n = 0; n < 100; ++n)
+            map.key<map_key>(n).value<map_value>(std::to_string(n));
+        REQUIRE(map.size() == 100);
+
+        for (int n = 0; n < 100; ++n)
+        {
+            Map::iterator found = map.find(map_key(n));
+            REQUIRE(found != map.end());
+            CHECK(dynamic_cast<map_value &>(*found->second).name == std::to_string(n));
+        }
+        CHECK(map.find(map_key(100)) == map.end());
+
+        // an equal key does not replace the existing entry
+        map_key *key = heterogenous::detail::construct<map_key, map_base>(map.get_allocator(), 7).to_derived();
+        map_value *value = heterogenous::detail::construct<map_value, map_base>(map.get_allocator(), "dupe").to_derived();
+        CHECK(!map.insert(std::make_pair(key, value)).second);
+        CHECK(map.size() == 100);
+        heterogenous::allocator::deallocate_clone(key);
+        heterogenous::allocator::deallocate_clone(value);
+
+        size_t count = 0;
+        map.for_each([&](Map::value_type &) { ++count; });
+        CHECK(count == 100);
+    }
+    {
+        // an equal key at the load threshold does not grow the table
+        typedef heterogenous::map<map_base, std::less<map_base>, monotonic::allocator<int> > Map;
+        monotonic::allocator<int> alloc(storage);
+        Map map(alloc);
+        map.reserve(4);
+        for (int n = 0; n < 4; ++n)
+            map.key<map_key>(n).value<map_value>(std::to_string(n));
+        map_key *key = heterogenous::detail::construct<map_key, map_base>(map.get_allocator(), 3).to_derived();
+        map_value *value = heterogenous::detail::construct<map_value, map_base>(map.get_allocator(), "dupe").to_derived();
+        size_t used = storage.used();
+        CHECK(!map.insert(std::make_pair(key, value)).second);
+        CHECK(storage.used() == used);
+        heterogenous::allocator::deallocate_clone(key);
+        heterogenous::allocator::deallocate_clone(value);
+
+        map.key<map_key>(4).value<map_value>("4");
+        CHECK(map.size() == 5);
+        CHECK(storage.used() > used);
+        for (int n = 0; n < 5; ++n)
+            CHECK(map.find(map_key(n)) != map.end());
+    }
+}
+
 TEST_CASE("test_copy", "[algorithm]")
 {
     monotonic::storage<> storage;
@@ -594,7 +1959,7 @@ TEST_CASE("test_copy", "[algorithm]")
     size_t rem2 = storage.fixed_remaining();
 
     CHECK(v2 == v1);
-    CHECK(rem1 - rem2 == 12 + 100*sizeof(int));
+    CHECK(rem1 - rem2 == 100*sizeof(int) + monotonic::detail::red_zone);
 }
 
 //BOOST_AUTO_TEST_CASE(test_shared_allocators)